@@ -14,6 +14,9 @@
                 "src/node/utils/wrap.cpp",
                 "src/node/utils/wjwt.cpp",
                 "src/node/utils/wcsp.cpp",
+                "src/node/utils/wpool.cpp",
+                "src/node/utils/worker.cpp",
+                "src/node/utils/wthread_pool.cpp",
                 "src/node/pki/wcrl.cpp",
                 "src/node/pki/wcrls.cpp",
                 "src/node/pki/wrevoked.cpp",
@@ -25,11 +28,15 @@
                 "src/node/pki/wext.cpp",
                 "src/node/pki/wexts.cpp",
                 "src/node/pki/wkey.cpp",
+                "src/node/pki/wkey_pool.cpp",
+                "src/node/pki/wkey_cache.cpp",
                 "src/node/pki/woid.cpp",
                 "src/node/pki/walg.cpp",
                 "src/node/pki/wcert_request_info.cpp",
                 "src/node/pki/wcert_request.cpp",
                 "src/node/pki/wcipher.cpp",
+                "src/node/pki/wcipher_stream.cpp",
+                "src/node/pki/wcipher_session.cpp",
                 "src/node/pki/wchain.cpp",
                 "src/node/pki/wrevocation.cpp",
                 "src/node/pki/wpkcs12.cpp",
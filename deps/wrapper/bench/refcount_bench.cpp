@@ -0,0 +1,126 @@
+/*
+* Standalone microbenchmark of copy vs move for Handle<T> and RCPtr<T>.
+* It is not a part of the library or of the test suite. Build and run
+* from deps/wrapper:
+*
+*   g++ -O2 -std=c++11 -Iinclude bench/refcount_bench.cpp src/common/pool.cpp -lcrypto -lpthread -o refcount_bench
+*   ./refcount_bench
+*
+* Add -DWRAPPER_ATOMIC_REFCOUNT to measure the atomic reference counter.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "wrapper/common/common.h"
+
+#define BENCH_ITERATIONS 20000000
+#define BENCH_ROTATE_SIZE 1024
+#define BENCH_ROTATE_ITERATIONS 20000
+
+class Value {
+public:
+	explicit Value(int v) : value(v) {}
+	int value;
+};
+
+class RCValue : public DefaultRCObject {
+public:
+	explicit RCValue(int v) : value(v) {}
+	bool isShareable() const { return true; }
+	int value;
+};
+
+/*Keeps the optimizer from removing the loop body*/
+static volatile int sink;
+
+template<class H>
+static H passCopy(const H &h){
+	H res = h;
+	return res;
+}
+
+template<class H>
+static H passMove(H &h){
+	H res = std::move(h);
+	return res;
+}
+
+template<class F>
+static void run(const char *name, F f){
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	f();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("%-32s %10.1f ms\n", name, ms);
+}
+
+/*Hand a handle through a function and back, as the wrappers pass objects*/
+template<class H>
+static void benchPass(const char *copyName, const char *moveName, H h){
+	run(copyName, [&h](){
+		for (int i = 0; i < BENCH_ITERATIONS; i++){
+			H tmp = passCopy(h);
+			h = tmp;
+			sink = (*h).value;
+		}
+	});
+
+	run(moveName, [&h](){
+		for (int i = 0; i < BENCH_ITERATIONS; i++){
+			H tmp = passMove(h);
+			h = std::move(tmp);
+			sink = (*h).value;
+		}
+	});
+}
+
+/*Rotate a vector of handles, every element is reassigned*/
+template<class H, class M>
+static void benchRotate(const char *copyName, const char *moveName, M make){
+	std::vector<H> items;
+	for (int i = 0; i < BENCH_ROTATE_SIZE; i++){
+		items.push_back(make(i));
+	}
+
+	run(copyName, [&items](){
+		for (int n = 0; n < BENCH_ROTATE_ITERATIONS; n++){
+			H first = items[0];
+			for (size_t i = 1; i < items.size(); i++){
+				items[i - 1] = items[i];
+			}
+			items.back() = first;
+		}
+		sink = (*items[0]).value;
+	});
+
+	run(moveName, [&items](){
+		for (int n = 0; n < BENCH_ROTATE_ITERATIONS; n++){
+			H first = std::move(items[0]);
+			for (size_t i = 1; i < items.size(); i++){
+				items[i - 1] = std::move(items[i]);
+			}
+			items.back() = std::move(first);
+		}
+		sink = (*items[0]).value;
+	});
+}
+
+int main(){
+#ifdef WRAPPER_ATOMIC_REFCOUNT
+	printf("Counter: AtomicRCObject\n");
+#else
+	printf("Counter: RCObject\n");
+#endif
+
+	benchPass("Handle pass copy", "Handle pass move", Handle<Value>(new Value(1)));
+	benchPass("RCPtr pass copy", "RCPtr pass move", RCPtr<RCValue>(new RCValue(1)));
+
+	benchRotate<Handle<Value> >("Handle rotate copy", "Handle rotate move",
+		[](int i){ return Handle<Value>(new Value(i)); });
+	benchRotate<RCPtr<RCValue> >("RCPtr rotate copy", "RCPtr rotate move",
+		[](int i){ return RCPtr<RCValue>(new RCValue(i)); });
+
+	return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef CMS_ENVELOPED_READER_H_INCLUDED
+#define  CMS_ENVELOPED_READER_H_INCLUDED
+
+#include <vector>
+
+#include <openssl/cms.h>
+
+#include "../common/common.h"
+#include "../pki/pki.h"
+
+/* RecipientInfos and algorithms read before the content */
+#define ENVELOPED_MAX_HEADER_LEN	(16 * 1024 * 1024)
+/* Nesting of constructed OCTET STRING */
+#define ENVELOPED_MAX_DEPTH		16
+
+/*
+* Streaming reader of CMS EnvelopedData (DER/BER or PEM).
+*
+* Elements before the encryptedContent (RecipientInfos, content encryption
+* algorithm) are read to memory and decoded as ContentInfo with detached
+* content, so the content-encryption key is unwrapped by OpenSSL as usual.
+* Then the encryptedContent octets (primitive, or constructed of definite
+* or indefinite length) are passed by chunks through the cipher BIO of
+* CMS_dataInit to the output. Memory doesn't depend on the size of data.
+*
+* Elements after the encryptedContent (unprotectedAttrs) are not read.
+*/
+class CTWRAPPER_API EnvelopedDataReader{
+public:
+	EnvelopedDataReader(BIO *in, DataFormat::DATA_FORMAT format);
+	~EnvelopedDataReader();
+
+	/* ContentInfo without encryptedContent. It is freed by the caller */
+	CMS_ContentInfo *readHeader();
+
+	/* Content of readHeader() is decrypted by the key of recipient to out */
+	void decrypt(CMS_ContentInfo *cms, EVP_PKEY *pkey, X509 *cert, BIO *out, int bsize);
+
+protected:
+	struct Frame{
+		bool indefinite;
+		/* offset of the end for definite length */
+		unsigned long long end;
+	};
+
+	void readExact(unsigned char *out, size_t len);
+	/* Returns false on end-of-contents */
+	bool readTag(unsigned char &tag, bool &indefinite, unsigned long long &length, std::string *raw);
+	/* Whole element to raw, indefinite length included. false on end-of-contents */
+	bool readElement(std::string &raw, unsigned char expected, int depth);
+	/* Header of constructed element, its content is read by the caller */
+	void expectTag(unsigned char expected);
+	void readPemHeader();
+	/* Next octets of encryptedContent. 0 is the end */
+	size_t readContent(unsigned char *out, size_t len);
+
+protected:
+	BIO *in;
+	BIO *b64;
+	unsigned long long offset;
+	bool header;
+
+	std::vector<Frame> frames;
+	unsigned long long chunk;
+};
+
+#endif //!CMS_ENVELOPED_READER_H_INCLUDED
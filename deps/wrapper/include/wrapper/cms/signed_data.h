@@ -41,15 +41,15 @@ public:
 	bool isDetached();
 	void read(Handle<Bio> in, DataFormat::DATA_FORMAT format);
 	void write(Handle<Bio> out, DataFormat::DATA_FORMAT format);
-	void addCertificate(Handle<Certificate> cert);
-	bool verify(Handle<CertificateCollection> certs);
+	void addCertificate(const Handle<Certificate> &cert);
+	bool verify(const Handle<CertificateCollection> &certs);
 
 	int cms_copy_content(BIO *out, BIO *in, unsigned int flags);
 
 	static Handle<SignedData> sign(Handle<Certificate> cert, Handle<Key> pkey, Handle<CertificateCollection> certs, Handle<Bio> content, unsigned int flags); //      CMS 
 	void sign();
 
-	Handle<Signer> createSigner(Handle<Certificate> cert, Handle<Key> pkey);
+	Handle<Signer> createSigner(const Handle<Certificate> &cert, const Handle<Key> &pkey);
 
 protected:
 	Handle<Bio> content = NULL;
@@ -4,13 +4,15 @@
 #include "common.h"
 #include "./signer_id.h"
 
-static void CMS_SignerInfo_free_ex(void *si){};
+/*SignerInfo is owned by CMS_ContentInfo*/
+static void CMS_SignerInfo_free_ex(CMS_SignerInfo *si){};
+SSLOBJECT_free(CMS_SignerInfo, CMS_SignerInfo_free_ex)
 
 class Signer : public SSLObject < CMS_SignerInfo > {
 public:
 	//Constructor
 	Signer(CMS_SignerInfo *data, Handle<SObject> parent)
-		: SSLObject<CMS_SignerInfo>(data, &CMS_SignerInfo_free_ex, parent){}
+		: SSLObject<CMS_SignerInfo>(data, parent){}
 
 	//Properties
 	void setCertificate(Handle<Certificate> cert);
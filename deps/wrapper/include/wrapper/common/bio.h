@@ -7,12 +7,32 @@
 
 #define BIO_BUFFER_SIZE 1024 * 64
 
+/*
+* Read-only BIO over a memory mapped file. The file must not be truncated
+* while the BIO exists: access to the pages behind the new end raises
+* SIGBUS (EXCEPTION_IN_PAGE_ERROR on Windows), it is not reported as
+* a read error.
+*/
+#define BIO_TYPE_MMAP (120|BIO_TYPE_SOURCE_SINK)
+
+BIO_METHOD *BIO_s_mmap();
+BIO *BIO_new_mmap(const char *filename);
+/* Not yet read bytes of the mapping. Returns 0 if the BIO is not BIO_TYPE_MMAP */
+int BIO_mmap_get_data(BIO *b, const unsigned char **data, size_t *length);
+/*
+* Move the position by length bytes, offsets are not limited by long.
+* Returns 0 if the BIO is not BIO_TYPE_MMAP or it has less data
+*/
+int BIO_mmap_skip(BIO *b, size_t length);
+
 class CTWRAPPER_API Bio
 {
 public:
 	Bio(BIO* data, bool del = true);
 	Bio(int type, const std::string &data, const std::string &param = "rb");
-	~Bio();
+	/* Read-only memory BIO over caller's data without copy. Data must outlive the Bio */
+	Bio(const char *data, size_t length);
+	virtual ~Bio();
 
 	void seek(int index);
 	void reset();
@@ -21,6 +41,11 @@ public:
 	void write(Handle<std::string> buf);
 	void flush();
 	Handle<std::string> read(int size = -1);
+	/*
+	* Take written data of BIO_TYPE_MEM without copy. The result must be
+	* released by OPENSSL_free. The Bio is empty after the call.
+	*/
+	char *detachBuffer(size_t &length);
 
 	int type();
 
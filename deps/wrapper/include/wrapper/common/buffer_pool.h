@@ -0,0 +1,61 @@
+#ifndef COMMON_BUFFER_POOL_H_INCLUDED
+#define  COMMON_BUFFER_POOL_H_INCLUDED
+
+#include <stddef.h>
+
+#include "common.h"
+
+/* Buffers are served in power of two sizes from BUFFER_POOL_MIN_SIZE */
+#define BUFFER_POOL_MIN_SIZE (4 * 1024)
+/* Bigger buffers are allocated by new[] and freed on return */
+#define BUFFER_POOL_MAX_SIZE (64 * 1024 * 1024)
+/* Free buffers kept per size */
+#define BUFFER_POOL_KEEP 8
+
+/*
+* Scratch buffers of cipher operations (read blocks, cipher output,
+* segment batches). Returned buffers are cleansed and kept for the next
+* operation, so repeated calls don't allocate.
+*
+* Build with WRAPPER_NO_POOL to allocate every buffer (e.g. for ASAN).
+*/
+class CTWRAPPER_API BufferPool{
+public:
+	struct Stats{
+		unsigned long long hits;		/* buffers taken from the pool */
+		unsigned long long misses;		/* buffers allocated */
+		unsigned long long kept;		/* free buffers in the pool now */
+		unsigned long long keptBytes;
+	};
+
+	/* capacity receives real size of the buffer */
+	static unsigned char *take(size_t size, size_t &capacity);
+	/* used bytes are cleansed */
+	static void give(unsigned char *buff, size_t capacity, size_t used);
+	static Stats stats();
+};
+
+/* Buffer of BufferPool returned on destruction */
+class CTWRAPPER_API PooledBuffer{
+public:
+	explicit PooledBuffer(size_t size);
+	~PooledBuffer();
+
+	unsigned char *data(){
+		return data_;
+	}
+
+	size_t size(){
+		return size_;
+	}
+
+private:
+	PooledBuffer(const PooledBuffer &);
+	PooledBuffer &operator=(const PooledBuffer &);
+
+	unsigned char *data_;
+	size_t size_;
+	size_t capacity_;
+};
+
+#endif //!COMMON_BUFFER_POOL_H_INCLUDED
@@ -13,6 +13,7 @@
 #define CTWRAPPER_API __declspec(dllimport)
 #endif // !CTWRAPPER_EXPORTS
 
+#include "pool.h"
 #include "refcount.h"
 #include "excep.h"
 #include "log.h"
@@ -4,8 +4,15 @@
 #define COMMON_LOG_H_INCLUDE
 
 #include <fstream>
+#include <atomic>
+
+/* Maximum length of one formatted record */
+#define LOGGER_RECORD_SIZE 1024
+/* Number of records in the asynchronous queue (power of 2) */
+#define LOGGER_QUEUE_SIZE 1024
 
 class CTWRAPPER_API Logger;
+class LoggerQueue;
 
 class LoggerLevel
 {
@@ -31,47 +38,97 @@ public:
 	//Handle<std::string> filename(const char*path);
 	void write(LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *msg, ...);
 	void write(LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *msg, va_list);
-	void start(const char *filename, int levels);
+	/*
+	* The started logger is used by the calling thread. It also becomes
+	* the global one if no other is started, so threads without own
+	* logger (e.g. pool threads) write to it. If async is true records are
+	* put to the lock-free queue and written by the background thread.
+	* When the queue is full new records are dropped.
+	*/
+	void start(const char *filename, int levels, bool async = false);
+	/* Waits for the threads which are writing records now */
 	void stop();
 	void clear();
 
+	bool isAsync() const {
+		return this->_queue.load(std::memory_order_acquire) != NULL;
+	}
+
+	/*Count of records dropped because the queue was full*/
+	unsigned long long dropped() const;
+
 	void debug(const char* fn, const char *msg, ...);
 	void error(const char* fn, const char *msg, ...);
 	void warn(const char* fn, const char *msg, ...);
 	void info(const char* fn, const char *msg, ...);
 
+	bool isEnabled(LoggerLevel::LOGGER_LEVEL level) const {
+		return (this->levels.load(std::memory_order_relaxed) & level) != 0;
+	}
+
+	/* Logger of the calling thread or the global one */
+	static Logger *current();
+
 protected:
 	void init();
+	/* Detaches the file, then closes it when no thread is writing to it */
+	FILE *detach();
+	void waitWriters() const;
 
 //properties
 public:
-	int levels;
+	std::atomic<int> levels;
 protected: 
 	Handle<std::string> _filename;
 	//Handle<std::ofstream> _file;
-	FILE* _file;
+	std::atomic<FILE *> _file;
+	std::atomic<LoggerQueue *> _queue;
+	unsigned long long _dropped;
+	/* Threads inside write() or dropped() */
+	mutable std::atomic<int> _writers;
 };
 
 //GLOBAL LOG
-extern Logger *logger;
+extern std::atomic<Logger *> logger;
+
+/*
+* WRAPPER_NO_LOGGER removes all tracing calls at compile time.
+* Otherwise a disabled level costs one check of Logger::levels,
+* arguments are neither evaluated nor formatted.
+*/
+#ifdef WRAPPER_NO_LOGGER
+
+#define LOGGER_WRITE(level, msg, ...) ;
+
+#define LOGGER_FN() ;
+
+#else
+
+#define LOGGER_WRITE(level, msg, ...) \
+	do { Logger *__logger = Logger::current(); if (__logger->isEnabled(level)) __logger->write(level, __FUNCTION__, msg, ## __VA_ARGS__); } while (0);
+
+#define LOGGER_FN() \
+	LoggerFunction __logger_fn(Logger::current(), __FUNCTION__);
+
+#endif //!WRAPPER_NO_LOGGER
 
 #define LOGGER_DEBUG(msg, ...) \
-	logger->debug(__FUNCTION__, msg, ## __VA_ARGS__);
+	LOGGER_WRITE(LoggerLevel::Debug, msg, ## __VA_ARGS__)
 
 #define LOGGER_ERROR(msg, ...) \
-	logger->error(__FUNCTION__, msg, ## __VA_ARGS__);
+	LOGGER_WRITE(LoggerLevel::Error, msg, ## __VA_ARGS__)
 
 #define LOGGER_INFO(msg, ...) \
-	logger->info(__FUNCTION__, msg, ## __VA_ARGS__);
+	LOGGER_WRITE(LoggerLevel::Info, msg, ## __VA_ARGS__)
 
 #define LOGGER_WARN(msg, ...) \
-	logger->warn(__FUNCTION__, msg, ## __VA_ARGS__);
+	LOGGER_WRITE(LoggerLevel::Warning, msg, ## __VA_ARGS__)
 
 #define LOGGER_OPENSSL(msg, ...) \
-	logger->write(LoggerLevel::OpenSSL, __FUNCTION__, #msg, ## __VA_ARGS__);
+	LOGGER_WRITE(LoggerLevel::OpenSSL, #msg, ## __VA_ARGS__)
 
 #define LOGGER_TRACE(msg, ...) \
-	logger->write(LoggerLevel::Trace, __FUNCTION__, msg, ## __VA_ARGS__);
+	LOGGER_WRITE(LoggerLevel::Trace, msg, ## __VA_ARGS__)
 
 #define LOGGER_FN_BEGIN() \
 	LOGGER_TRACE("Begin")
@@ -79,15 +136,22 @@ extern Logger *logger;
 #define LOGGER_FN_END() \
 	LOGGER_TRACE("End")
 
-#define LOGGER_FN() \
-	LoggerFunction __logger_fn(logger, __FUNCTION__);
-
 class CTWRAPPER_API LoggerFunction{
 public:
-	LoggerFunction(Logger *logger, const char *fn);
-	~LoggerFunction();
+	LoggerFunction(Logger *logger, const char *fn)
+		: _fn(fn), _logger(logger->isEnabled(LoggerLevel::Trace) ? logger : NULL)
+	{
+		if (this->_logger)
+			this->_logger->write(LoggerLevel::Trace, this->_fn, "Begin");
+	}
+
+	~LoggerFunction(){
+		if (this->_logger)
+			this->_logger->write(LoggerLevel::Trace, this->_fn, "End");
+	}
+
 protected:
-	Handle<std::string> _fn = NULL;
-	Logger *_logger = NULL;
+	const char *_fn;
+	Logger *_logger;
 };
 #endif //!COMMON_LOG_H_INCLUDE
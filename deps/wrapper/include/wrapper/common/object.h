@@ -2,7 +2,6 @@
 #define  CMS_COMMON_OBJECT_H_INCLUDED
 
 #include <typeinfo>
-#include <set>
 #include "common.h"
 
 class Object{
@@ -21,17 +20,17 @@ typedef SObject * SObjectPtr;
 
 class SObject{
 public:
+	POOL_ALLOCATED()
+
 	SObject(void *obj, Handle<SObject>parent, const char* tname)
-		: free_(NULL), obj_(obj), type_name_(tname)
+		: free_(NULL), obj_(obj), type_name_(tname),
+		owner_(NULL), firstChild_(NULL), prevSibling_(NULL), nextSibling_(NULL)
 	{
 		LOGGER_FN();
 
 		this->parent = parent;
 		if (!this->parent.isEmpty()){
-			/*std::set < int > it;
-			it.insert("");*/
-
-			this->parent->children.insert(this);
+			this->link(&*this->parent);
 		}
 	}
 
@@ -42,48 +41,47 @@ public:
 			LOGGER_TRACE("OpenSSL free");
 			this->free();
 		}
-		else
-		{
-			LOGGER_TRACE("Remove item from parent's children");
-			this->parent->children.erase(this);
-			LOGGER_TRACE("Remove children: SUCCESS");
-		}
+
+		LOGGER_TRACE("Remove item from parent's children");
+		this->unlink();
 	}
 
+	/*
+	* Release OpenSSL data of the object and all its children.
+	* Children are visited in post-order without recursion,
+	* so deep ownership graphs can not overflow the stack.
+	*/
 	void destroy(void){
 		LOGGER_FN();
 
-		std::set<SObject*> *children = &(this->children);
-		int children_size = this->children.size();
-		if (children_size > 0){
-			for (std::set<SObject*>::iterator i = children->begin(); i != children->end(); ++i) {
-				SObject *child = *i;
-				child->destroy();
+		SObject *node = this->firstLeaf();
+		for (;;){
+			SObject *next = NULL;
+			if (node != this){
+				next = node->nextSibling_ ? node->nextSibling_->firstLeaf() : node->owner_;
 			}
+
+			if (node->isRemovable()){
+				node->free();
+			}
+			node->obj_ = NULL;
+
+			if (!next){
+				break;
+			}
+			node = next;
 		}
-		if (this->isRemovable()){
-			this->free();
-		}
-		this->obj_ = NULL;
-		//this->parent = NULL;
 	}
 
 	template <typename N>
 	N* internal(){
-		LOGGER_FN();
-		if (this->isEmpty())
-			THROW_EXCEPTION(2, SObject, NULL, "Internal object was deleted");
-		N* res = (N*)(this->obj_);
-		/*
-		if (!res)
-			THROW_EXCEPTION(0, SObject, NULL, "Can not cast internal data");
-		*/
-		return res;
+		if (!this->obj_){
+			this->throwDeleted();
+		}
+		return static_cast<N*>(this->obj_);
 	}
 
-	bool isEmpty(){
-		LOGGER_FN();
-
+	bool isEmpty() const {
 		return this->obj_ == NULL;
 	}
 
@@ -105,14 +103,57 @@ protected:
 		this->obj_ = NULL;
 	}
 
+	void throwDeleted(){
+		THROW_EXCEPTION(2, SObject, NULL, "Internal object was deleted");
+	}
+
+	/*Intrusive list of children: O(1) insert and remove without allocation*/
+	void link(SObject *owner){
+		this->owner_ = owner;
+		this->prevSibling_ = NULL;
+		this->nextSibling_ = owner->firstChild_;
+		if (owner->firstChild_){
+			owner->firstChild_->prevSibling_ = this;
+		}
+		owner->firstChild_ = this;
+	}
+
+	void unlink(){
+		if (!this->owner_){
+			return;
+		}
+		if (this->prevSibling_){
+			this->prevSibling_->nextSibling_ = this->nextSibling_;
+		}
+		else{
+			this->owner_->firstChild_ = this->nextSibling_;
+		}
+		if (this->nextSibling_){
+			this->nextSibling_->prevSibling_ = this->prevSibling_;
+		}
+		this->owner_ = this->prevSibling_ = this->nextSibling_ = NULL;
+	}
+
+	SObject *firstLeaf(){
+		SObject *node = this;
+		while (node->firstChild_){
+			node = node->firstChild_;
+		}
+		return node;
+	}
+
 public:
 	Handle<SObject> parent;
 	void(*free_)(void *);
-	std::set<SObjectPtr> children;
 protected:
 	void *obj_;
 	const char *type_name_;
 
+	SObject *owner_;
+	SObject *firstChild_;
+	SObject *prevSibling_;
+	SObject *nextSibling_;
+
 #ifdef WRAPPER_DEBUG_LOG
 	std::string sslName_;
 	std::string file_;
@@ -120,14 +161,24 @@ protected:
 #endif
 };
 
+/*
+* Free function of the OpenSSL type, resolved at compile time.
+* SSLOBJECT_free specializes it for every wrapped type, so SSLObject<T>
+* without SSLOBJECT_free(T, ...) does not compile.
+*/
+template<typename T>
+struct SSLObjectFree;
+
 template<typename T>
 class SSLObject{
 public:
-	SSLObject(T* data, void(*fn)(void *), Handle<SObject> parent = NULL) :fnFree_(fn){
+	POOL_ALLOCATED()
+
+	SSLObject(T* data, Handle<SObject> parent = NULL){
 		LOGGER_TRACE("Create OpenSSL object");
-		logger->write(LoggerLevel::OpenSSL, __FUNCTION__, typeid(data).name());
+		LOGGER_WRITE(LoggerLevel::OpenSSL, "%s", typeid(data).name());
 		this->data_ = new SObject((void *)data, parent, typeid(this).name());
-		this->data_->free_ = fn;
+		this->data_->free_ = &SSLObject<T>::freeData;
 	}
 
 	~SSLObject(){
@@ -141,20 +192,16 @@ public:
 	}
 
 	bool isEmpty(){
-		LOGGER_FN();
-
 		bool res = this->data_.isEmpty();
 		if (!res)
 			res = this->data_->isEmpty();
 		return res;
 	}
 
+	/*Called by every crypto operation, so it does not log or copy the handle*/
 	T *internal()
 	{
-		LOGGER_FN();
-
-		Handle<SObject> tmp = this->data_;
-		return tmp->internal<T>();
+		return this->data_->template internal<T>();
 	}
 
 	Handle<SObject> handle(){
@@ -183,25 +230,32 @@ protected:
 
 		//this->destroy();
 		this->data_ = new SObject((void*)v, this->data_->parent, typeid(this).name());
-		this->data_->free_ = fnFree_;
+		this->data_->free_ = &SSLObject<T>::freeData;
+	}
+
+	/*Only the ownership graph keeps data untyped, typed free is instantiated here*/
+	static void freeData(void *d){
+		if (d != NULL){
+			SSLObjectFree<T>::free(static_cast<T*>(d));
+		}
 	}
 
 protected:
-	void(*fnFree_)(void*);
 	Handle<SObject> data_;
 };
 
 #define SSLOBJECT_free(type, free_fn) \
-	static void so_##type##_free(void *d){ \
-	if (d != NULL) {LOGGER_TRACE("Free OpenSSL object");LOGGER_OPENSSL(#free_fn);free_fn((type*)d);}}
+	template<> struct SSLObjectFree<type>{ \
+		static void free(type *d){ \
+			LOGGER_TRACE("Free OpenSSL object");LOGGER_OPENSSL(#free_fn);free_fn(d);}};
 
 #define SSLOBJECT_new(class_name, type) \
 	class_name(type *data, Handle<SObject> parent = NULL) \
-	:SSLObject<type>(data, &so_##type##_free, parent)
+	:SSLObject<type>(data, parent)
 
 #define SSLOBJECT_new_null(class_name, type, new_fn) \
 	class_name() \
-	:SSLObject<type>(new_fn(), &so_##type##_free)\
+	:SSLObject<type>(new_fn())\
 
 
 
@@ -5,11 +5,39 @@
 
 #include "bio.h"
 
+class OpenSSLProfile
+{
+public:
+	enum OPENSSL_PROFILE
+	{
+		/* OpenSSL allocations go through ObjectPool and are counted */
+		Production = 0,
+		/* System allocator with OpenSSL memory leak tracking */
+		Debug = 1
+	};
+};
+
 class CTWRAPPER_API OpenSSL{
 	public:
-		static void run();
+		struct MemoryStats{
+			bool installed;					/* allocator is used by OpenSSL */
+			unsigned long long allocations;
+			unsigned long long releases;
+			unsigned long long liveBytes;
+			unsigned long long allocatedBytes;	/* total, for allocation rate */
+		};
+
+		/*
+		* Calls are counted: only the first run() initializes OpenSSL and
+		* only the matching last stop() cleans it up. So every module
+		* instance (e.g. one per worker thread) may call run() safely.
+		*/
+		static void run(OpenSSLProfile::OPENSSL_PROFILE profile = OpenSSLProfile::Production);
 		static void stop();
+		/* Free error queue of the calling thread. Call it before a worker thread exits */
+		static void threadCleanup();
 		static Handle<std::string> printErrors();
+		static MemoryStats memoryStats();
 };
 
 #endif //!COMMON_OPENSSL_T_H_INCLUDED
@@ -0,0 +1,50 @@
+#ifndef COMMON_POOL_H_INCLUDED
+#define  COMMON_POOL_H_INCLUDED
+
+#include <stddef.h>
+
+/* Blocks are served in size classes of POOL_GRANULARITY bytes */
+#define POOL_GRANULARITY 16
+/* Objects bigger than POOL_MAX_SIZE are allocated by global operator new */
+#define POOL_MAX_SIZE 256
+/* Size of the slab carved into blocks of one size class */
+#define POOL_SLAB_SIZE (64 * 1024)
+
+/*
+* Size-class allocator for small wrapper objects (SObject, SSLObject
+* descendants and Handle counters). Every thread keeps its own cache of
+* free blocks and exchanges them by batches with the shared lists, so
+* objects may be released by another thread. Slabs are never returned
+* to the system.
+*
+* Build with WRAPPER_NO_POOL to use global operator new (e.g. for ASAN).
+*/
+class CTWRAPPER_API ObjectPool{
+public:
+	struct Stats{
+		unsigned long long allocations;	/* blocks given out */
+		unsigned long long releases;	/* blocks returned */
+		unsigned long long live;		/* allocations - releases */
+		unsigned long long slabs;		/* slabs taken from the system */
+		unsigned long long slabBytes;
+		unsigned long long large;		/* requests bigger than POOL_MAX_SIZE */
+	};
+
+	static void *allocate(size_t size);
+	static void release(void *ptr, size_t size);
+	static Stats stats();
+};
+
+/*
+* Declare class-specific operator new/delete which use ObjectPool.
+* The class must be deleted through its own type or a virtual destructor.
+*/
+#define POOL_ALLOCATED() \
+	static void *operator new(size_t size){ \
+		return ObjectPool::allocate(size); \
+	} \
+	static void operator delete(void *ptr, size_t size){ \
+		ObjectPool::release(ptr, size); \
+	}
+
+#endif //!COMMON_POOL_H_INCLUDED
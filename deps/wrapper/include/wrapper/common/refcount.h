@@ -36,6 +36,7 @@
 
 
 #include <stdexcept>
+#include <atomic>
 //#include <iostream>      // The iostream facilities are not used in the classes
 // in this file, but they are used in the code that
 // tests the classes.
@@ -110,6 +111,80 @@ inline bool RCObject::isShared() const {
 	return refCount > 1;
 }
 
+/******************************************************************************
+ *                          Class AtomicRCObject                               *
+ *                                                                             *
+ * The same interface as RCObject, but the counter may be changed from         *
+ * several threads. Increment is relaxed (a new reference is always made from  *
+ * an existing one), decrement is acq_rel so the thread which deletes the      *
+ * object sees all writes made through the other references.                  *
+ ******************************************************************************/
+class AtomicRCObject {
+public:
+	void addReference();
+	void removeReference();
+	bool isShared() const;
+
+protected:
+	AtomicRCObject();
+	AtomicRCObject(const AtomicRCObject& rhs);
+	AtomicRCObject& operator=(const AtomicRCObject& rhs);
+	virtual ~AtomicRCObject() = 0;
+
+private:
+	std::atomic<int> refCount;
+};
+
+inline AtomicRCObject::AtomicRCObject()
+: refCount(0) {
+}
+
+inline AtomicRCObject::AtomicRCObject(const AtomicRCObject&)
+: refCount(0) {
+}
+
+inline AtomicRCObject& AtomicRCObject::operator=(const AtomicRCObject&) {
+	return *this;
+}
+
+inline AtomicRCObject::~AtomicRCObject() {
+}
+
+inline void AtomicRCObject::addReference() {
+	refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void AtomicRCObject::removeReference() {
+	if (refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+inline bool AtomicRCObject::isShared() const {
+	return refCount.load(std::memory_order_relaxed) > 1;
+}
+
+/******************************************************************************
+ *                       Template Struct RefCountTraits                        *
+ *                                                                             *
+ * Selects the counter used by Handle<T>. Build with WRAPPER_ATOMIC_REFCOUNT   *
+ * to make all handles thread-safe, or use HANDLE_REFCOUNT(type, counter)      *
+ * before the first use of Handle<type> to select the counter for one type.    *
+ * Objects shared between threads must also use atomic Handle<SObject>, as     *
+ * every SSLObject keeps its OpenSSL data in it.                               *
+ ******************************************************************************/
+#ifdef WRAPPER_ATOMIC_REFCOUNT
+typedef AtomicRCObject DefaultRCObject;
+#else
+typedef RCObject DefaultRCObject;
+#endif
+
+template<class T>
+struct RefCountTraits {
+	typedef DefaultRCObject Counter;
+};
+
+#define HANDLE_REFCOUNT(type, counter) \
+	template<> struct RefCountTraits<type> { typedef counter Counter; };
+
 /******************************************************************************
  *                 Template Class RCPtr (from pp. 203, 206)                    *
  ******************************************************************************/
@@ -118,8 +193,10 @@ class RCPtr { // pointers-to-T objects; T
 public: // must support the RCObject interface
 	RCPtr(T* realPtr = 0);
 	RCPtr(const RCPtr& rhs);
+	RCPtr(RCPtr&& rhs);
 	~RCPtr();
 	RCPtr& operator=(const RCPtr& rhs);
+	RCPtr& operator=(RCPtr&& rhs);
 	T* operator->() const;
 	T& operator*() const;
 
@@ -151,6 +228,12 @@ RCPtr<T>::RCPtr(const RCPtr& rhs)
 	init();
 }
 
+template<class T>
+RCPtr<T>::RCPtr(RCPtr&& rhs)
+: pointee(rhs.pointee) {
+	rhs.pointee = 0;
+}
+
 template<class T>
 RCPtr<T>::~RCPtr() {
 	if (pointee) pointee->removeReference();
@@ -170,6 +253,15 @@ RCPtr<T>& RCPtr<T>::operator=(const RCPtr& rhs) {
 	return *this;
 }
 
+template<class T>
+RCPtr<T>& RCPtr<T>::operator=(RCPtr&& rhs) {
+	T *tmp = pointee;
+	pointee = rhs.pointee;
+	rhs.pointee = tmp;
+
+	return *this;
+}
+
 template<class T>
 T* RCPtr<T>::operator->() const {
 	return pointee;
@@ -187,20 +279,28 @@ T& RCPtr<T>::operator*() const {
  * both in the original source code as well as in the subsequent fixes.  You   *
  * can find a complete list of changes at the More Effective C++ errata page.  *
  * The code here is accurate as of the 13th printing of the book.              *
+ *                                                                             *
+ * An empty Handle has no CountHolder (counter is NULL), so Handle(NULL) and   *
+ * moving a Handle do not allocate or touch the reference counter.             *
  ******************************************************************************/
 template<class T>
 class Handle {
 public:
 	Handle(T* realPtr = 0);
 	Handle(const Handle& rhs);
+	Handle(Handle&& rhs);
 	~Handle();
 	Handle& operator=(const Handle& rhs);
+	Handle& operator=(Handle&& rhs);
 
 	T* operator->() const;
 	T& operator*() const;
 
-	RCObject& getRCObject() // give clients access to
+	typename RefCountTraits<T>::Counter& getRCObject() // give clients access to
 	{
+		if (!counter)
+			throw std::logic_error("Pointer is NULL");
+
 		return *counter;
 	} // isShared, etc.
 
@@ -208,7 +308,7 @@ public:
 	T* detach();
 
 	bool isEmpty() const {
-		return !counter->pointee;
+		return !counter || !counter->pointee;
 	}
 
 	Handle& empty() // release()
@@ -219,7 +319,8 @@ public:
 
 private:
 
-	struct CountHolder : public RCObject {
+	struct CountHolder : public RefCountTraits<T>::Counter {
+		POOL_ALLOCATED()
 
 		~CountHolder() {
 			delete pointee;
@@ -240,14 +341,17 @@ void Handle<T>::init() {
 	//    counter->pointee = oldValue ? oldValue->clone() : 0;
 	//  }
 
-	counter->addReference();
+	if (counter) counter->addReference();
 }
 
 template<class T>
 Handle<T>::Handle(T* realPtr)
-: counter(new CountHolder) {
-	counter->pointee = realPtr;
-	init();
+: counter(0) {
+	if (realPtr) {
+		counter = new CountHolder;
+		counter->pointee = realPtr;
+		init();
+	}
 }
 
 template<class T>
@@ -256,24 +360,38 @@ Handle<T>::Handle(const Handle& rhs)
 	init();
 }
 
+template<class T>
+Handle<T>::Handle(Handle&& rhs)
+: counter(rhs.counter) {
+	rhs.counter = 0;
+}
+
 template<class T>
 Handle<T>::~Handle() {
-	counter->removeReference();
+	if (counter) counter->removeReference();
 }
 
 template<class T>
 Handle<T>& Handle<T>::operator=(const Handle& rhs) {
 	if (counter != rhs.counter) {
-		counter->removeReference();
+		if (counter) counter->removeReference();
 		counter = rhs.counter;
 		init();
 	}
 	return *this;
 }
 
+template<class T>
+Handle<T>& Handle<T>::operator=(Handle&& rhs) {
+	CountHolder *tmp = counter;
+	counter = rhs.counter;
+	rhs.counter = tmp;
+	return *this;
+}
+
 template<class T>
 T* Handle<T>::operator->() const {
-	if (!counter->pointee)
+	if (isEmpty())
 		throw std::logic_error("Pointer is NULL");
 
 	return counter->pointee;
@@ -281,7 +399,7 @@ T* Handle<T>::operator->() const {
 
 template<class T>
 T& Handle<T>::operator*() const {
-	if (!counter->pointee)
+	if (isEmpty())
 		throw std::logic_error("Pointer is NULL");
 
 	return *(counter->pointee);
@@ -289,13 +407,13 @@ T& Handle<T>::operator*() const {
 
 template<class T>
 T* Handle<T>::attach(T* realPtr) {
-	T* oldValue = counter->pointee;
+	T* oldValue = counter ? counter->pointee : 0;
 
-	if (counter->pointee != realPtr) {
-		if (!counter->isShared()) {
+	if (oldValue != realPtr) {
+		if (counter && !counter->isShared()) {
 			counter->pointee = NULL; // it prevents releasing
 		}
-		*this = *new Handle(realPtr);
+		*this = Handle(realPtr);
 	}
 
 	return oldValue;
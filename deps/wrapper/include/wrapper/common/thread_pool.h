@@ -0,0 +1,112 @@
+#ifndef COMMON_THREAD_POOL_H_INCLUDED
+#define  COMMON_THREAD_POOL_H_INCLUDED
+
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define THREAD_POOL_PRIORITIES 3
+
+/*
+* Pool of native threads for long crypto operations.
+* Tasks are queued by priority: a task of lower priority starts only when
+* queues of higher priorities are empty, tasks of one priority run in FIFO
+* order. Queues may be limited, push() to the full queue throws, so callers
+* get backpressure instead of unbounded latency.
+*
+* A task may be given a cancel flag. Not started task is skipped by
+* remove(), running task checks the flag itself by checkCancelled()
+* (e.g. between chunks of its Bio loop).
+*
+* Every worker frees its OpenSSL error queue before exit.
+*/
+class CTWRAPPER_API ThreadPool{
+public:
+	typedef std::function<void()> Task;
+	typedef std::shared_ptr<std::atomic<bool> > CancelFlag;
+
+	enum Priority{
+		High = 0,	/* interactive operations */
+		Normal = 1,
+		Low = 2		/* bulk and background jobs */
+	};
+
+	struct Stats{
+		size_t size;
+		size_t running;
+		size_t pending[THREAD_POOL_PRIORITIES];
+		size_t limits[THREAD_POOL_PRIORITIES];	/* 0 - unlimited */
+		unsigned long long completed;
+		unsigned long long rejected;	/* pushed to the full queue */
+		unsigned long long removed;		/* cancelled before start */
+	};
+
+	ThreadPool(size_t size = 0);
+	~ThreadPool();
+
+	/* Return id of the task for remove() */
+	unsigned long long push(const Task &task, Priority priority = Normal, const CancelFlag &cancel = CancelFlag());
+	/* Remove not started task. Return false if it is running or done */
+	bool remove(unsigned long long id);
+
+	/* Running tasks are not interrupted by shrinking, their threads exit after */
+	void resize(size_t size);
+	void setLimit(Priority priority, size_t limit);
+
+	size_t size();
+	size_t pending();
+	Stats stats();
+	/* Threads which are not busy by running or pending tasks */
+	size_t idle();
+
+	/* Count of hardware threads, at least 2 */
+	static size_t defaultSize();
+
+	/*
+	* Pool for helper tasks of the library (segments of AEAD data), so they
+	* share its size and queues. NULL (default) - helpers are not started
+	*/
+	static void setShared(ThreadPool *pool);
+	static ThreadPool *shared();
+
+	static CancelFlag newCancelFlag();
+	/* Check cancel flag of the task running on the current thread */
+	static bool cancelled();
+	static void checkCancelled();
+
+protected:
+	struct Item{
+		unsigned long long id;
+		Task task;
+		CancelFlag cancel;
+	};
+
+	void run();
+	void start(size_t count);
+	std::vector<std::thread> takeRetired();
+
+protected:
+	std::vector<std::thread> threads_;
+	std::deque<Item> tasks_[THREAD_POOL_PRIORITIES];
+	size_t limits_[THREAD_POOL_PRIORITIES];
+	std::mutex lock_;
+	std::condition_variable wait_;
+	bool stopping_;
+
+	size_t size_;
+	size_t retiring_;
+	std::vector<std::thread::id> retired_;
+
+	size_t running_;
+	unsigned long long nextId_;
+	unsigned long long completed_;
+	unsigned long long rejected_;
+	unsigned long long removed_;
+};
+
+#endif //!COMMON_THREAD_POOL_H_INCLUDED
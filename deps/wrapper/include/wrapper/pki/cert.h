@@ -50,23 +50,23 @@ public:
 	bool isSelfSigned();
 	bool isCA();
 
-	void setSubject(Handle<std::string> x509Name);
-	void setIssuer(Handle<std::string> x509Name);
+	void setSubject(const Handle<std::string> &x509Name);
+	void setIssuer(const Handle<std::string> &x509Name);
 	void setVersion(long version);
-	void setExtensions(Handle<ExtensionCollection> exts);
+	void setExtensions(const Handle<ExtensionCollection> &exts);
 	void setNotBefore(long offset_sec = 0);
 	void setNotAfter(long offset_sec);
-	void setSerialNumber(Handle<std::string> serial);
+	void setSerialNumber(const Handle<std::string> &serial);
 
 	//Methods
 	void read(Handle<Bio> in, DataFormat::DATA_FORMAT format);
 	void write(Handle<Bio> out, DataFormat::DATA_FORMAT format);
 	Handle<Certificate> duplicate();
-	int compare(Handle<Certificate> cert);
-	bool equals(Handle<Certificate> cert);
-	Handle<std::string> hash(Handle<std::string> algorithm);
+	int compare(const Handle<Certificate> &cert);
+	bool equals(const Handle<Certificate> &cert);
+	Handle<std::string> hash(const Handle<std::string> &algorithm);
 	Handle<std::string> hash(const EVP_MD *md);
-	void sign(Handle<Key> key, const char* digest);
+	void sign(const Handle<Key> &key, const char* digest);
 
 protected:
 	static Handle<std::string> GetCommonName(X509_NAME *a);
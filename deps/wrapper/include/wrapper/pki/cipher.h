@@ -10,17 +10,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 #include "certs.h"
 #include "cert.h"
 #include "key.h"
+#include "cipher_aead.h"
+#include "cipher_segments.h"
+#include "cipher_session.h"
+#include "../common/buffer_pool.h"
 #include "../cms/cmsRecipientInfos.h"
 
 #undef SIZE
 #undef BSIZE
 
 #define SIZE	(512)
+/*Default size of I/O buffers, see Cipher::setBufferSize*/
 #define BSIZE	(8*1024)
+/*Memory mapped input is passed to the cipher BIO by chunks of this size*/
+#define CIPHER_MMAP_CHUNK	(1024*1024)
 
 class CryptoMethod
 {
@@ -43,20 +51,33 @@ public:
 };
 
 class CTWRAPPER_API Cipher;
+class CTWRAPPER_API CipherStream;
 
 static const char magic[] = "Salted__";
 
 class Cipher{
+	friend class CipherStream;
 
 public:
 	Cipher();
+	~Cipher();
 
 	/*Symetric or assymetric(default)*/
 	void setCryptoMethod(CryptoMethod::Crypto_Method method);
 
 	void encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_FORMAT format);
+	/*Output is not authenticated until decrypt returns, it must be dropped on error*/
 	void decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FORMAT format);
 
+	/*Decrypt plaintext range of segmented AEAD data (see AeadSegments)*/
+	void decryptRange(Handle<Bio> inEnc, Handle<Bio> outDec, unsigned long long offset, unsigned long long length);
+
+	/*Incremental symmetric encryption (decryption) with the current parameters*/
+	Handle<CipherStream> createStream(bool encrypt);
+
+	/*Encryption of many messages with the current key (see CipherSession)*/
+	Handle<CipherSession> createSession();
+
 public:
 	Handle<std::string> getAlgorithm();
 	Handle<std::string> getMode();
@@ -86,10 +107,30 @@ public:
 	void setPass(Handle<std::string> password);
 	void setIV(Handle<std::string> iv);
 	void setKey(Handle<std::string> key);
+	/*
+	* AEAD algorithm (see Aead): "auto", "aes-256-gcm", "chacha20-poly1305".
+	* Empty name returns to the legacy format. Set it before the key
+	*/
+	void setAead(Handle<std::string> name);
+	/*Segment size of AEAD data, 0 - one segment (version 1 format)*/
+	void setSegmentSize(unsigned int size);
+	/*Threads of segmented encryption (decryption), 0 - count of hardware threads. Limited by idle threads of ThreadPool::shared()*/
+	void setThreads(size_t threads);
+	/*
+	* Password KDF of AEAD format: "pbkdf2", "scrypt". cost 0 is default, else
+	* iterations of PBKDF2 or log2(N) of scrypt. New salt is generated, it is
+	* shared by data encrypted after
+	*/
+	void setKdf(Handle<std::string> name, unsigned int cost);
+	/*Size of I/O buffers of encryption (decryption) and streams*/
+	void setBufferSize(int size);
 
 	Handle<std::string> getSalt();
 	Handle<std::string> getIV();
 	Handle<std::string> getKey();
+	Handle<std::string> getAead();
+	Handle<std::string> getKdf();
+	int getBufferSize();
 
 	Handle<std::string> getDigestAlgorithm();
 
@@ -101,14 +142,22 @@ protected:
 	char *hkey = NULL, *hiv = NULL, *hsalt = NULL, *hmd = NULL;
 	const EVP_MD *dgst = NULL;
 	const EVP_CIPHER *cipher = NULL;
+	Aead::Algorithm aead = Aead::NONE;
+	unsigned int segmentSize = 0;
+	Aead::KdfParams kdf;
+	bool hkdf = false;
+	size_t threads = 0;
 	char *hpass = NULL;
-	unsigned char *buff = NULL, *bufsize = NULL;
 	int bsize = BSIZE;
 	int inl;
 	char mbuf[sizeof magic - 1];
 
+	/*Cipher BIO is kept between calls, its context keeps the key schedule*/
 	BIO *benc = NULL, *rbio = NULL, *wbio = NULL;
 	EVP_CIPHER_CTX *ctx = NULL;
+	const EVP_CIPHER *bencCipher = NULL;
+	int bencEnc = 0;
+	unsigned char bencKey[EVP_MAX_KEY_LENGTH];
 
 	STACK_OF(X509) *encerts = NULL;
 	X509 *rcert = NULL;
@@ -116,8 +165,55 @@ protected:
 	int flags = CMS_STREAM;
 	EVP_PKEY *rkey = NULL;
 
+	/*Owners of encerts, rcert and rkey. They are alive while Cipher is, also on pool threads*/
+	std::vector<Handle<Certificate> > hencerts;
+	Handle<Certificate> hrcert;
+	Handle<Key> hrkey;
+
 private:
+	void transfer(BIO *in, BIO *out, unsigned char *buff);
+	void initCipherBio(int enc);
+	void releaseCipherBio(bool error);
+	static void replace(char *&field, const char *value);
 	int setHex(char *in, unsigned char *out, int size);
 };
 
+/*
+* Symmetric cipher context fed by chunks. Output is the same as of
+* Cipher::encrypt: with password the data is preceded by "Salted__" and salt,
+* decryption reads them from the first chunks and derives key and iv.
+* Parameters are copied from Cipher, so it may be changed after.
+*/
+class CipherStream{
+public:
+	CipherStream(const Cipher &params, bool encrypt);
+	~CipherStream();
+
+	void update(const unsigned char *in, size_t inl, Handle<Bio> out);
+	void final(Handle<Bio> out);
+
+	bool isFinished();
+
+protected:
+	void init();
+	void write(Handle<Bio> out, const unsigned char *data, int len);
+
+protected:
+	EVP_CIPHER_CTX *ctx = NULL;
+	const EVP_CIPHER *cipher = NULL;
+	const EVP_MD *dgst = NULL;
+	std::string pass;
+	bool encrypt;
+	bool started = false;
+	bool finished = false;
+
+	unsigned char key[EVP_MAX_KEY_LENGTH], iv[EVP_MAX_IV_LENGTH];
+	/*"Salted__" and salt*/
+	unsigned char header[sizeof magic - 1 + PKCS5_SALT_LEN];
+	size_t headerLen = 0;
+
+	int bsize;
+	PooledBuffer buff;
+};
+
 #endif
\ No newline at end of file
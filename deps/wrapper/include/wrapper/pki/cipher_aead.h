@@ -0,0 +1,140 @@
+#ifndef CMS_PKI_CIPHER_AEAD_H_INCLUDED
+#define  CMS_PKI_CIPHER_AEAD_H_INCLUDED
+
+#include <openssl/evp.h>
+
+#include "../common/common.h"
+
+#define AEAD_MAGIC			"TCAE"
+#define AEAD_MAGIC_LEN		4
+#define AEAD_VERSION		1
+/* Segmented format, see AeadSegments */
+#define AEAD_VERSION_SEGMENTS	2
+#define AEAD_NONCE_LEN		12
+#define AEAD_TAG_LEN		16
+#define AEAD_KEY_LEN		32
+#define AEAD_SALT_LEN		16
+#define AEAD_PBKDF2_ITER	100000
+#define AEAD_MIN_PBKDF2_ITER	1000
+/* Limits of parameters read from the header */
+#define AEAD_MAX_PBKDF2_ITER	10000000
+/* scrypt N = 2^15, r = 8, p = 1: 32 MB */
+#define AEAD_SCRYPT_LOGN	15
+#define AEAD_SCRYPT_R		8
+#define AEAD_SCRYPT_P		1
+#define AEAD_MIN_SCRYPT_LOGN	10
+#define AEAD_MAX_SCRYPT_LOGN	24
+#define AEAD_MAX_SCRYPT_P	16
+/* Memory of scrypt (128 * r * N bytes) */
+#define AEAD_MAX_SCRYPT_MEM	(1024ULL * 1024 * 1024)
+#define AEAD_MAX_SEGMENT_SIZE	(16 * 1024 * 1024)
+/* magic, version, algorithm, kdf, nonce length, salt length, salt, cost, nonce, segment size */
+#define AEAD_MAX_HEADER_LEN	(AEAD_MAGIC_LEN + 5 + AEAD_SALT_LEN + 4 + AEAD_NONCE_LEN + 4)
+
+/*
+* Authenticated encryption of symmetric Cipher.
+*
+* Format of version 1 (numbers are big-endian):
+*   "TCAE" | version | algorithm | kdf | nonce length
+*   [kdf != KDF_NONE: salt length | salt | cost(4)]
+*   nonce | ciphertext | tag(16)
+*
+* Version 2 (AEAD_VERSION_SEGMENTS) adds segment size(4) after the nonce,
+* the data follows in the format of AeadSegments.
+*
+* Cost of PBKDF2 is iterations, of scrypt it is log2(N) | r | p | 0.
+*
+* The whole header is authenticated as additional data. The tag is
+* written after the ciphertext, so encryption is one pass over the input
+* and decryption keeps the last 16 bytes back until the end of input.
+*/
+class CTWRAPPER_API Aead{
+public:
+	enum Algorithm{
+		NONE = 0,
+		AES_256_GCM = 1,
+		CHACHA20_POLY1305 = 2
+	};
+
+	enum Kdf{
+		KDF_NONE = 0,
+		KDF_PBKDF2_SHA256 = 1,
+		KDF_SCRYPT = 2
+	};
+
+	/* Password derivation. Keys of the same parameters are cached (see KeyCache) */
+	struct KdfParams{
+		Kdf id;
+		unsigned char salt[AEAD_SALT_LEN];
+		/* PBKDF2 */
+		unsigned int iterations;
+		/* scrypt, N = 2^logN */
+		unsigned char logN;
+		unsigned char r;
+		unsigned char p;
+	};
+
+	struct Header{
+		unsigned char version;
+		Algorithm algorithm;
+		KdfParams kdf;
+		unsigned char nonce[AEAD_NONCE_LEN];
+		/* 0 for version 1 */
+		unsigned int segmentSize;
+	};
+
+	/* "auto", "aes-256-gcm", "chacha20-poly1305". Empty name is NONE */
+	static Algorithm getAlgorithm(const std::string &name);
+	static const char *getName(Algorithm algorithm);
+	static const EVP_CIPHER *getCipher(Algorithm algorithm);
+
+	/* AES-GCM if the CPU has AES instructions, else ChaCha20-Poly1305 if OpenSSL has it */
+	static Algorithm preferred();
+	static bool hasAesHardware();
+
+	/* "pbkdf2", "scrypt" */
+	static Kdf getKdf(const std::string &name);
+	static const char *getKdfName(Kdf kdf);
+	/*
+	* Parameters with random salt. cost 0 is default, else iterations of
+	* PBKDF2 or log2(N) of scrypt
+	*/
+	static void initKdf(KdfParams &params, Kdf kdf, unsigned int cost);
+	/* Throws if the parameters are out of limits */
+	static void checkKdf(const KdfParams &params);
+
+	/*
+	* pass is used if not NULL, else key of AEAD_KEY_LEN bytes. kdf NULL is
+	* PBKDF2 of default cost with random salt.
+	* Memory mapped input is encrypted straight from the mapping.
+	*/
+	static void encrypt(Algorithm algorithm, const char *pass, const KdfParams *kdf, const unsigned char *key,
+		BIO *in, BIO *out, int bsize);
+	/* Both versions are decrypted. threads is used for segmented data */
+	static void decrypt(const char *pass, const unsigned char *key, BIO *in, BIO *out, int bsize, size_t threads);
+
+	/*
+	* New header with random nonce. kdf is copied for password, NULL is default
+	* PBKDF2. segmentSize 0 is version 1
+	*/
+	static void initHeader(Header &header, Algorithm algorithm, bool password, const KdfParams *kdf,
+		unsigned int segmentSize);
+
+	/* Returns length of the serialized header */
+	static size_t writeHeader(const Header &header, unsigned char *out);
+	/* Reads and checks the header. raw receives its bytes for authentication */
+	static size_t readHeader(BIO *in, Header &header, unsigned char *raw);
+
+	/* Key of AEAD_KEY_LEN bytes, taken from KeyCache if it was derived before */
+	static void deriveKey(const char *pass, const KdfParams &params, unsigned char *key);
+
+protected:
+	/* salt length | salt | cost(4) */
+	static size_t writeKdf(const KdfParams &params, unsigned char *out);
+
+	static EVP_CIPHER_CTX *init(const Header &header, const unsigned char *key,
+		const unsigned char *aad, size_t aadLen, bool encrypt);
+	static void update(EVP_CIPHER_CTX *ctx, const unsigned char *in, int inl, unsigned char *buff, BIO *out);
+};
+
+#endif //!CMS_PKI_CIPHER_AEAD_H_INCLUDED
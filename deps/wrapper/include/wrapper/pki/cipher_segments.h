@@ -0,0 +1,45 @@
+#ifndef CMS_PKI_CIPHER_SEGMENTS_H_INCLUDED
+#define  CMS_PKI_CIPHER_SEGMENTS_H_INCLUDED
+
+#include "cipher_aead.h"
+
+#define AEAD_SEGMENT_SIZE	(1024 * 1024)
+#define AEAD_TRAILER_MAGIC	"TCAF"
+/* magic, plaintext length(8) */
+#define AEAD_TRAILER_LEN	(AEAD_MAGIC_LEN + 8)
+
+/*
+* Segmented AEAD format (header version AEAD_VERSION_SEGMENTS):
+*   header | segment 0 | ... | segment N-1 | "TCAF" | plaintext length(8)
+*
+* Every segment is ciphertext of segment size bytes and its own tag. The
+* last segment is always shorter than segment size (it may be empty), so
+* it is found without the trailer. Nonce of segment i is the header nonce
+* with i xored into its last 8 bytes and 0x80 into the first byte for the
+* last segment. Additional data of every segment is the header, the last
+* one also authenticates the trailer. So segments can't be reordered,
+* dropped, truncated or moved to another file.
+*
+* Segments are encrypted (decrypted) by the calling thread and idle threads
+* of ThreadPool::shared(), they are written in order.
+* Any plaintext range is decrypted from its segments only.
+*/
+class CTWRAPPER_API AeadSegments{
+public:
+	/* threads 0 - count of hardware threads, no more than idle threads of the shared pool + 1 */
+	static void encrypt(Aead::Algorithm algorithm, const char *pass, const Aead::KdfParams *kdf,
+		const unsigned char *key, BIO *in, BIO *out, unsigned int segmentSize, size_t threads);
+
+	/* Data after the header which is already read to raw */
+	static void decrypt(const Aead::Header &header, const unsigned char *raw, size_t rawLen,
+		const unsigned char *key, BIO *in, BIO *out, size_t threads);
+
+	/*
+	* Decrypt plaintext bytes [offset, offset + length). Input must be
+	* memory mapped file or memory BIO. Range is cut by the plaintext length
+	*/
+	static void decryptRange(const char *pass, const unsigned char *key, BIO *in, BIO *out,
+		unsigned long long offset, unsigned long long length, size_t threads);
+};
+
+#endif //!CMS_PKI_CIPHER_SEGMENTS_H_INCLUDED
@@ -0,0 +1,51 @@
+#ifndef CMS_PKI_CIPHER_SESSION_H_INCLUDED
+#define  CMS_PKI_CIPHER_SESSION_H_INCLUDED
+
+#include <openssl/evp.h>
+
+#include "../common/common.h"
+#include "cipher_aead.h"
+
+/*
+* Symmetric encryption of many small messages with one key. Contexts are
+* keyed once (the key schedule is expanded once), every message only sets
+* its IV.
+*
+* Message of AEAD algorithm: nonce(12) | ciphertext | tag(16). Nonce is
+* the random nonce of the session with the message counter xored in, so
+* it is unique for 2^64 messages of the session.
+* Message of other ciphers: random iv | ciphertext.
+*
+* Session is not thread-safe.
+*/
+class CTWRAPPER_API CipherSession{
+public:
+	/* aead is NONE for a legacy cipher. key is of EVP_CIPHER_key_length(cipher) bytes */
+	CipherSession(const EVP_CIPHER *cipher, Aead::Algorithm aead, const unsigned char *key);
+	~CipherSession();
+
+	/* Maximal length of encrypted message */
+	size_t encryptedLength(size_t inl);
+	/* Returns length of out */
+	size_t encrypt(const unsigned char *in, size_t inl, unsigned char *out);
+	/* out must hold inl bytes. Returns length of out */
+	size_t decrypt(const unsigned char *in, size_t inl, unsigned char *out);
+
+	unsigned long long getMessages();
+
+protected:
+	EVP_CIPHER_CTX *context(bool encrypt);
+
+protected:
+	const EVP_CIPHER *cipher;
+	Aead::Algorithm aead;
+	int ivLen;
+	unsigned char key[EVP_MAX_KEY_LENGTH];
+	unsigned char nonce[AEAD_NONCE_LEN];
+	unsigned long long messages;
+
+	EVP_CIPHER_CTX *encCtx;
+	EVP_CIPHER_CTX *decCtx;
+};
+
+#endif //!CMS_PKI_CIPHER_SESSION_H_INCLUDED
@@ -0,0 +1,39 @@
+#ifndef CMS_PKI_KEY_CACHE_H_INCLUDED
+#define  CMS_PKI_KEY_CACHE_H_INCLUDED
+
+#include <stddef.h>
+
+#include "../common/common.h"
+
+#define KEY_CACHE_ID_LEN		32
+#define KEY_CACHE_MAX_KEY_LEN	64
+/* Default count of cached keys */
+#define KEY_CACHE_CAPACITY		32
+
+/*
+* LRU of keys derived from passwords. Entries are found by makeId():
+* HMAC-SHA256 of the password and KDF parameters under a random key of
+* the process, so neither password nor its plain hash is kept.
+* Keys are cleansed when they are evicted or the cache is cleared.
+*/
+class CTWRAPPER_API KeyCache{
+public:
+	struct Stats{
+		unsigned long long hits;		/* keys found */
+		unsigned long long misses;		/* keys derived */
+		unsigned long long size;		/* keys in the cache now */
+		unsigned long long capacity;
+	};
+
+	static void makeId(const char *pass, const unsigned char *params, size_t paramsLen, unsigned char *id);
+	/* Returns false if the key is not cached */
+	static bool get(const unsigned char *id, unsigned char *key, size_t keyLen);
+	static void put(const unsigned char *id, const unsigned char *key, size_t keyLen);
+
+	/* 0 disables the cache. Extra keys are evicted */
+	static void setCapacity(size_t capacity);
+	static void clear();
+	static Stats stats();
+};
+
+#endif //!CMS_PKI_KEY_CACHE_H_INCLUDED
@@ -0,0 +1,63 @@
+#ifndef CMS_PKI_KEY_POOL_H_INCLUDED
+#define  CMS_PKI_KEY_POOL_H_INCLUDED
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#include "../common/common.h"
+#include "../common/thread_pool.h"
+
+#include "key.h"
+
+/*
+* Keeps pre-generated keys for (algorithm, pkeyopt) profiles.
+* Keys are generated by Low priority tasks of ThreadPool and taken without wait.
+* If a profile is empty the key is generated by the caller (miss).
+*/
+class CTWRAPPER_API KeyPool{
+public:
+	struct Stats{
+		unsigned long long hits;		/* keys taken from the pool */
+		unsigned long long misses;		/* keys generated by take() */
+		unsigned long long generated;	/* keys generated in background */
+		unsigned long long failures;	/* background generation errors */
+		unsigned long long ready;		/* keys in the pool now */
+	};
+
+	KeyPool(ThreadPool *threads);
+	~KeyPool();
+
+	/* Keep count keys of the profile. 0 removes the profile */
+	void reserve(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt, size_t count);
+	Handle<Key> take(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt);
+	Stats stats();
+
+protected:
+	struct Profile{
+		Handle<std::string> algorithm;
+		std::vector<std::string> pkeyopt;
+		std::deque<Handle<Key> > keys;
+		size_t size;
+		size_t scheduled;
+	};
+
+	static std::string profileName(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt);
+	static Handle<Key> generate(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt);
+
+	/* Must be called under lock_ */
+	void refill(const std::string &name, Profile &profile);
+	void fill(const std::string &name);
+
+protected:
+	ThreadPool *threads_;
+	std::mutex lock_;
+	std::map<std::string, Profile> profiles_;
+	Stats stats_;
+	bool stopping_;
+	size_t running_;
+	std::condition_variable idle_;
+};
+
+#endif //!CMS_PKI_KEY_POOL_H_INCLUDED
@@ -28,8 +28,8 @@ public:
 	void addProvider(Handle<Provider> provider);
 	void deleteProvider(Handle<std::string> typeProvider);
 	
-	Handle<PkiItemCollection> find(Handle<Filter> filter);
-	Handle<PkiItem> findKey(Handle<Filter> filter);
+	Handle<PkiItemCollection> find(const Handle<Filter> &filter);
+	Handle<PkiItem> findKey(const Handle<Filter> &filter);
 
 	Handle<Certificate> getItemCert(Handle<PkiItem> item);
 	Handle<CRL> getItemCrl(Handle<PkiItem> item);
@@ -148,9 +148,9 @@ public:
 
 	Handle<PkiItem> items(int index);
 	int length();
-	void push(Handle<PkiItem> v);
-	void push(PkiItem &v);
-	Handle<PkiItemCollection> find(Handle<Filter> filter);
+	void push(const Handle<PkiItem> &v);
+	void push(const PkiItem &v);
+	Handle<PkiItemCollection> find(const Handle<Filter> &filter);
 protected:
 	std::vector<PkiItem> _items;
 };
@@ -0,0 +1,421 @@
+#include "../stdafx.h"
+
+#include "wrapper/cms/enveloped_reader.h"
+#include "wrapper/common/buffer_pool.h"
+#include "wrapper/common/thread_pool.h"
+
+/* BER tags */
+#define TAG_INTEGER			0x02
+#define TAG_OCTET_STRING	0x04
+#define TAG_OID				0x06
+#define TAG_SEQUENCE		0x30
+#define TAG_SET				0x31
+#define TAG_CONSTRUCTED		0x20
+#define TAG_CONTEXT_0		0x80
+
+/* 1.2.840.113549.1.7.3 */
+static const unsigned char envelopedDataOid[] = {
+	TAG_OID, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x03
+};
+
+EnvelopedDataReader::EnvelopedDataReader(BIO *in, DataFormat::DATA_FORMAT format)
+	: in(in), b64(NULL), offset(0), header(false), chunk(0)
+{
+	LOGGER_FN();
+
+	switch (format){
+	case DataFormat::DER:
+		break;
+	case DataFormat::BASE64:
+		this->readPemHeader();
+
+		LOGGER_OPENSSL(BIO_new);
+		if ((this->b64 = BIO_new(BIO_f_base64())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "BIO_new(BIO_f_base64())");
+		}
+		this->in = BIO_push(this->b64, in);
+		break;
+	default:
+		THROW_EXCEPTION(0, EnvelopedDataReader, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+	}
+}
+
+EnvelopedDataReader::~EnvelopedDataReader(){
+	LOGGER_FN();
+
+	if (this->b64){
+		LOGGER_OPENSSL(BIO_pop);
+		BIO_pop(this->b64);
+		BIO_free(this->b64);
+	}
+}
+
+void EnvelopedDataReader::readExact(unsigned char *out, size_t len){
+	while (len){
+		int part = len < INT_MAX ? (int)len : INT_MAX;
+
+		LOGGER_OPENSSL(BIO_read);
+		int res = BIO_read(this->in, (char *)out, part);
+		if (res <= 0){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "error reading input file");
+		}
+
+		out += res;
+		len -= res;
+		this->offset += res;
+	}
+}
+
+/*
+* "-----BEGIN CMS-----" (or PKCS7) line, the base64 BIO stops at "-----END"
+*/
+void EnvelopedDataReader::readPemHeader(){
+	LOGGER_FN();
+
+	std::string line;
+	for (;;){
+		char c;
+		LOGGER_OPENSSL(BIO_read);
+		if (BIO_read(this->in, &c, 1) != 1){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "error reading input file");
+		}
+
+		if (c == '\n'){
+			if (!line.empty() && line[line.length() - 1] == '\r'){
+				line.erase(line.length() - 1);
+			}
+			if (!line.empty()){
+				break;
+			}
+			continue;
+		}
+
+		line += c;
+		if (line.length() > 64){
+			break;
+		}
+	}
+
+	if (line != "-----BEGIN CMS-----" && line != "-----BEGIN PKCS7-----"){
+		THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "PEM header of CMS is not found");
+	}
+}
+
+bool EnvelopedDataReader::readTag(unsigned char &tag, bool &indefinite, unsigned long long &length, std::string *raw){
+	unsigned char buf[9];
+
+	this->readExact(buf, 2);
+	if (raw){
+		raw->append((const char *)buf, 2);
+	}
+
+	tag = buf[0];
+	if ((tag & 0x1F) == 0x1F){
+		THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Unsupported ASN.1 tag 0x%02X", (int)tag);
+	}
+
+	indefinite = false;
+	length = 0;
+
+	if (!tag){
+		if (buf[1]){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Invalid end-of-contents");
+		}
+		return false;
+	}
+
+	if (buf[1] == 0x80){
+		if (!(tag & TAG_CONSTRUCTED)){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Indefinite length of primitive element");
+		}
+		indefinite = true;
+	}
+	else if (buf[1] & 0x80){
+		size_t n = buf[1] & 0x7F;
+		if (n > 8){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "ASN.1 length is too long");
+		}
+
+		this->readExact(buf + 1, n);
+		if (raw){
+			raw->append((const char *)buf + 1, n);
+		}
+		for (size_t i = 1; i <= n; i++){
+			length = (length << 8) | buf[i];
+		}
+	}
+	else{
+		length = buf[1];
+	}
+
+	return true;
+}
+
+bool EnvelopedDataReader::readElement(std::string &raw, unsigned char expected, int depth){
+	if (depth > ENVELOPED_MAX_DEPTH){
+		THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "ASN.1 nesting is too deep");
+	}
+
+	size_t start = raw.length();
+	unsigned char tag;
+	bool indefinite;
+	unsigned long long length;
+
+	if (!this->readTag(tag, indefinite, length, &raw)){
+		if (expected){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Unexpected end-of-contents");
+		}
+		return false;
+	}
+	if (expected && tag != expected){
+		THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Unexpected ASN.1 tag 0x%02X", (int)tag);
+	}
+
+	if (indefinite){
+		while (this->readElement(raw, 0, depth + 1)){
+			if (raw.length() > ENVELOPED_MAX_HEADER_LEN){
+				THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "CMS header is too big");
+			}
+		}
+	}
+	else{
+		if (start > ENVELOPED_MAX_HEADER_LEN || length > ENVELOPED_MAX_HEADER_LEN - start){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "CMS header is too big");
+		}
+
+		size_t pos = raw.length();
+		raw.resize(pos + (size_t)length);
+		if (length){
+			this->readExact((unsigned char *)&raw[pos], (size_t)length);
+		}
+	}
+
+	return true;
+}
+
+void EnvelopedDataReader::expectTag(unsigned char expected){
+	unsigned char tag;
+	bool indefinite;
+	unsigned long long length;
+
+	if (!this->readTag(tag, indefinite, length, NULL) || tag != expected){
+		THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Input is not CMS EnvelopedData");
+	}
+}
+
+CMS_ContentInfo *EnvelopedDataReader::readHeader(){
+	LOGGER_FN();
+
+	try{
+		if (this->header){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Header is already read");
+		}
+
+		std::string oid, version, originator, recipients, contentType, algorithm;
+
+		/* ContentInfo */
+		this->expectTag(TAG_SEQUENCE);
+		this->readElement(oid, TAG_OID, 0);
+		if (oid.length() != sizeof(envelopedDataOid) || memcmp(oid.data(), envelopedDataOid, oid.length())){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Input is not CMS EnvelopedData");
+		}
+		this->expectTag(TAG_CONTEXT_0 | TAG_CONSTRUCTED);
+
+		/* EnvelopedData */
+		this->expectTag(TAG_SEQUENCE);
+		this->readElement(version, TAG_INTEGER, 0);
+		this->readElement(recipients, 0, 0);
+		if ((unsigned char)recipients[0] == (TAG_CONTEXT_0 | TAG_CONSTRUCTED)){
+			originator.swap(recipients);
+			this->readElement(recipients, TAG_SET, 0);
+		}
+		else if ((unsigned char)recipients[0] != TAG_SET){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "RecipientInfos are not found");
+		}
+
+		/* EncryptedContentInfo */
+		this->expectTag(TAG_SEQUENCE);
+		this->readElement(contentType, TAG_OID, 0);
+		this->readElement(algorithm, TAG_SEQUENCE, 0);
+
+		unsigned char tag;
+		bool indefinite;
+		unsigned long long length;
+		if (!this->readTag(tag, indefinite, length, NULL)){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "EnvelopedData has no encrypted content");
+		}
+		if (tag == TAG_CONTEXT_0){
+			this->chunk = length;
+		}
+		else if (tag == (TAG_CONTEXT_0 | TAG_CONSTRUCTED)){
+			Frame frame = { indefinite, this->offset + length };
+			this->frames.push_back(frame);
+		}
+		else{
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "EnvelopedData has no encrypted content");
+		}
+		this->header = true;
+
+		/* The same structure with detached content */
+		static const char indef[] = { TAG_SEQUENCE, (char)0x80 };
+		static const char indefContext[] = { (char)(TAG_CONTEXT_0 | TAG_CONSTRUCTED), (char)0x80 };
+
+		std::string der;
+		der.append(indef, 2).append(oid);
+		der.append(indefContext, 2);
+		der.append(indef, 2).append(version).append(originator).append(recipients);
+		der.append(indef, 2).append(contentType).append(algorithm);
+		der.append(8, '\0');
+
+		const unsigned char *p = (const unsigned char *)der.data();
+		CMS_ContentInfo *cms;
+
+		LOGGER_OPENSSL(d2i_CMS_ContentInfo);
+		if ((cms = d2i_CMS_ContentInfo(NULL, &p, der.length())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "d2i_CMS_ContentInfo");
+		}
+
+		return cms;
+	}
+	catch (Handle<Exception> &e){
+		THROW_EXCEPTION(0, EnvelopedDataReader, e, "Error read CMS EnvelopedData");
+	}
+}
+
+size_t EnvelopedDataReader::readContent(unsigned char *out, size_t len){
+	for (;;){
+		if (this->chunk){
+			size_t n = this->chunk < len ? (size_t)this->chunk : len;
+			this->readExact(out, n);
+			this->chunk -= n;
+			return n;
+		}
+
+		if (this->frames.empty()){
+			return 0;
+		}
+
+		Frame top = this->frames.back();
+		if (!top.indefinite && this->offset >= top.end){
+			if (this->offset > top.end){
+				THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Invalid length of encrypted content");
+			}
+			this->frames.pop_back();
+			continue;
+		}
+
+		unsigned char tag;
+		bool indefinite;
+		unsigned long long length;
+		if (!this->readTag(tag, indefinite, length, NULL)){
+			if (!top.indefinite){
+				THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Invalid end-of-contents");
+			}
+			this->frames.pop_back();
+			continue;
+		}
+
+		if (tag == TAG_OCTET_STRING){
+			this->chunk = length;
+		}
+		else if (tag == (TAG_OCTET_STRING | TAG_CONSTRUCTED)){
+			if (this->frames.size() >= ENVELOPED_MAX_DEPTH){
+				THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "ASN.1 nesting is too deep");
+			}
+			Frame frame = { indefinite, this->offset + length };
+			this->frames.push_back(frame);
+		}
+		else{
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Unexpected ASN.1 tag 0x%02X", (int)tag);
+		}
+
+		if (!top.indefinite && this->offset + (indefinite ? 0 : length) > top.end){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Invalid length of encrypted content");
+		}
+	}
+}
+
+void EnvelopedDataReader::decrypt(CMS_ContentInfo *cms, EVP_PKEY *pkey, X509 *cert, BIO *out, int bsize){
+	LOGGER_FN();
+
+	BIO *src = NULL;
+	BIO *cont = NULL;
+
+	try{
+		if (!this->header){
+			THROW_EXCEPTION(0, EnvelopedDataReader, NULL, "Header is not read");
+		}
+
+		LOGGER_OPENSSL(CMS_decrypt_set1_pkey);
+		if (CMS_decrypt_set1_pkey(cms, pkey, cert) < 1){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "CMS_decrypt_set1_pkey");
+		}
+
+		/* Encrypted chunks are fed to the cipher BIO of CMS_dataInit by the memory BIO */
+		LOGGER_OPENSSL(BIO_new);
+		if ((src = BIO_new(BIO_s_mem())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "BIO_new(BIO_s_mem())");
+		}
+		BIO_set_mem_eof_return(src, -1);
+
+		LOGGER_OPENSSL(CMS_dataInit);
+		if ((cont = CMS_dataInit(cms, src)) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "CMS_dataInit");
+		}
+
+		PooledBuffer enc(bsize);
+		PooledBuffer dec(bsize);
+
+		for (;;){
+			ThreadPool::checkCancelled();
+
+			size_t n = this->readContent(enc.data(), enc.size());
+			if (n){
+				LOGGER_OPENSSL(BIO_write);
+				if (BIO_write(src, enc.data(), (int)n) != (int)n){
+					THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "BIO_write");
+				}
+			}
+			else{
+				BIO_set_mem_eof_return(src, 0);
+			}
+
+			int res;
+			while ((res = BIO_read(cont, dec.data(), (int)dec.size())) > 0){
+				LOGGER_OPENSSL(BIO_write);
+				if (BIO_write(out, dec.data(), res) != res){
+					THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "BIO_write");
+				}
+			}
+
+			if (!n){
+				break;
+			}
+		}
+
+		LOGGER_OPENSSL(BIO_get_cipher_status);
+		if (BIO_get_cipher_status(cont) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "bad decrypt");
+		}
+
+		LOGGER_OPENSSL(BIO_flush);
+		if (BIO_flush(out) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, EnvelopedDataReader, NULL, "BIO_flush");
+		}
+
+		BIO_pop(cont);
+		BIO_free(cont);
+		BIO_free(src);
+	}
+	catch (Handle<Exception> &e){
+		if (cont){
+			BIO_pop(cont);
+			BIO_free(cont);
+		}
+		if (src){
+			BIO_free(src);
+		}
+
+		THROW_EXCEPTION(0, EnvelopedDataReader, e, "Error decrypt CMS EnvelopedData");
+	}
+}
@@ -60,10 +60,32 @@ void SignedData::read(Handle<Bio> in, DataFormat::DATA_FORMAT format){
 
 		switch (format){
 		case DataFormat::DER:
-			LOGGER_OPENSSL(d2i_CMS_bio);
-			ci = d2i_CMS_bio(in->internal(), NULL);
-			if (ci == NULL){
-				THROW_OPENSSL_EXCEPTION(0, SignedData, NULL, "d2i_CMS_bio");
+		{
+			const unsigned char *data = NULL;
+			size_t length = 0;
+
+			/* Mapped file is decoded in place, d2i_CMS_bio would copy it to the heap first */
+			if (BIO_mmap_get_data(in->internal(), &data, &length)){
+				if (length > LONG_MAX){
+					THROW_EXCEPTION(0, SignedData, NULL, "File is too big");
+				}
+
+				const unsigned char *p = data;
+				LOGGER_OPENSSL(d2i_CMS_ContentInfo);
+				if ((ci = d2i_CMS_ContentInfo(NULL, &p, (long)length)) == NULL){
+					THROW_OPENSSL_EXCEPTION(0, SignedData, NULL, "d2i_CMS_ContentInfo");
+				}
+				if (!BIO_mmap_skip(in->internal(), p - data)){
+					CMS_ContentInfo_free(ci);
+					THROW_EXCEPTION(0, SignedData, NULL, "Error skipping input bio");
+				}
+			}
+			else{
+				LOGGER_OPENSSL(d2i_CMS_bio);
+				ci = d2i_CMS_bio(in->internal(), NULL);
+				if (ci == NULL){
+					THROW_OPENSSL_EXCEPTION(0, SignedData, NULL, "d2i_CMS_bio");
+				}
 			}
 
 			LOGGER_OPENSSL(CMS_is_detached);
@@ -86,6 +108,7 @@ void SignedData::read(Handle<Bio> in, DataFormat::DATA_FORMAT format){
 			}
 
 			break;
+		}
 		case DataFormat::BASE64:
 		{
 			LOGGER_OPENSSL("PEM_read_bio_CMS");
@@ -157,7 +180,7 @@ void SignedData::write(Handle<Bio> out, DataFormat::DATA_FORMAT format){
 	}
 }
 
-Handle<Signer> SignedData::createSigner(Handle<Certificate> cert, Handle<Key> pkey){
+Handle<Signer> SignedData::createSigner(const Handle<Certificate> &cert, const Handle<Key> &pkey){
 	LOGGER_FN();
 
 	int def_nid;
@@ -181,7 +204,7 @@ Handle<Signer> SignedData::createSigner(Handle<Certificate> cert, Handle<Key> pk
 	return new Signer(signer, this->handle());
 }
 
-void SignedData::addCertificate(Handle<Certificate> cert){
+void SignedData::addCertificate(const Handle<Certificate> &cert){
 	LOGGER_FN();
 
 	Handle<Certificate> cert_copy = cert->duplicate();
@@ -214,7 +237,7 @@ void SignedData::freeContent(){
 	this->content = NULL;
 }
 
-bool SignedData::verify(Handle<CertificateCollection> certs){
+bool SignedData::verify(const Handle<CertificateCollection> &certs){
 	LOGGER_FN();
 	int res;
 
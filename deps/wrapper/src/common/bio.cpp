@@ -37,11 +37,34 @@ Bio::Bio(int type, const std::string &data, const std::string &param)
 			THROW_EXCEPTION(0, Bio, NULL, "BIO_new_file", BIO_CLOSE);
 		}
 		break;
+	case BIO_TYPE_MMAP:
+		LOGGER_OPENSSL(BIO_new_mmap);
+		this->data_ = BIO_new_mmap(data.c_str());
+		if (!this->data_){
+			THROW_EXCEPTION(0, Bio, NULL, "BIO_new_mmap");
+		}
+		break;
 	default:
 		THROW_EXCEPTION(0, Bio, NULL, "Unknown type of BIO");
 	}
 }
 
+Bio::Bio(const char *data, size_t length)
+{
+	LOGGER_FN();
+
+	init();
+
+	if (length > INT_MAX){
+		THROW_EXCEPTION(0, Bio, NULL, "Buffer is too big");
+	}
+
+	LOGGER_OPENSSL(BIO_new_mem_buf);
+	this->data_ = BIO_new_mem_buf((void *)data, (int)length);
+	if (!this->data_)
+		THROW_EXCEPTION(0, Bio, NULL, "BIO_new_mem_buf");
+}
+
 Bio::~Bio()
 {
 	LOGGER_FN();
@@ -118,6 +141,41 @@ Handle<std::string> Bio::read(int size)
 	return res;
 }
 
+char *Bio::detachBuffer(size_t &length)
+{
+	LOGGER_FN();
+
+	if (this->type() != BIO_TYPE_MEM){
+		THROW_EXCEPTION(0, Bio, NULL, "Only memory BIO can be detached");
+	}
+	if (BIO_test_flags(this->data_, BIO_FLAGS_MEM_RDONLY)){
+		/*Reading flag is set by read/reset, data of the caller can't be taken*/
+		Handle<std::string> buf = this->read();
+		length = buf->length();
+		char *res = (char *)OPENSSL_malloc(length ? length : 1);
+		memcpy(res, buf->c_str(), length);
+		return res;
+	}
+
+	BUF_MEM *mem = NULL;
+	BIO_get_mem_ptr(this->data_, &mem);
+	BIO_set_close(this->data_, BIO_NOCLOSE);
+
+	char *res = mem->data;
+	length = mem->length;
+	mem->data = NULL;
+	BUF_MEM_free(mem);
+
+	LOGGER_OPENSSL(BIO_free);
+	BIO_free(this->data_);
+	LOGGER_OPENSSL(BIO_new);
+	this->data_ = BIO_new(BIO_s_mem());
+	if (!this->data_)
+		THROW_EXCEPTION(0, Bio, NULL, "BIO_new");
+
+	return res;
+}
+
 void Bio::seek(int index){
 	LOGGER_FN();
 
@@ -0,0 +1,106 @@
+#include "../stdafx.h"
+
+#include <vector>
+#include <mutex>
+
+#include "wrapper/common/buffer_pool.h"
+
+/* 4 KB .. 64 MB */
+#define BUFFER_POOL_CLASSES 15
+
+static std::mutex bufferPoolLock;
+static std::vector<unsigned char *> bufferPoolLists[BUFFER_POOL_CLASSES];
+static unsigned long long bufferPoolHits = 0;
+static unsigned long long bufferPoolMisses = 0;
+
+/* Returns BUFFER_POOL_CLASSES if the size is not pooled */
+static size_t bufferPoolClass(size_t size, size_t &capacity){
+	capacity = BUFFER_POOL_MIN_SIZE;
+	for (size_t cls = 0; cls < BUFFER_POOL_CLASSES; cls++, capacity <<= 1){
+		if (size <= capacity){
+			return cls;
+		}
+	}
+
+	capacity = size;
+	return BUFFER_POOL_CLASSES;
+}
+
+unsigned char *BufferPool::take(size_t size, size_t &capacity){
+	LOGGER_FN();
+
+#ifndef WRAPPER_NO_POOL
+	size_t cls = bufferPoolClass(size, capacity);
+	if (cls < BUFFER_POOL_CLASSES){
+		std::lock_guard<std::mutex> lock(bufferPoolLock);
+		std::vector<unsigned char *> &list = bufferPoolLists[cls];
+		if (!list.empty()){
+			unsigned char *res = list.back();
+			list.pop_back();
+			bufferPoolHits++;
+			return res;
+		}
+		bufferPoolMisses++;
+	}
+	else{
+		std::lock_guard<std::mutex> lock(bufferPoolLock);
+		bufferPoolMisses++;
+	}
+#else
+	capacity = size;
+#endif
+
+	return new unsigned char[capacity];
+}
+
+void BufferPool::give(unsigned char *buff, size_t capacity, size_t used){
+	LOGGER_FN();
+
+	if (!buff){
+		return;
+	}
+
+	OPENSSL_cleanse(buff, used < capacity ? used : capacity);
+
+#ifndef WRAPPER_NO_POOL
+	size_t classCapacity;
+	size_t cls = bufferPoolClass(capacity, classCapacity);
+	if (cls < BUFFER_POOL_CLASSES && classCapacity == capacity){
+		std::lock_guard<std::mutex> lock(bufferPoolLock);
+		std::vector<unsigned char *> &list = bufferPoolLists[cls];
+		if (list.size() < BUFFER_POOL_KEEP){
+			list.push_back(buff);
+			return;
+		}
+	}
+#endif
+
+	delete[] buff;
+}
+
+BufferPool::Stats BufferPool::stats(){
+	std::lock_guard<std::mutex> lock(bufferPoolLock);
+
+	Stats res;
+	res.hits = bufferPoolHits;
+	res.misses = bufferPoolMisses;
+	res.kept = 0;
+	res.keptBytes = 0;
+	for (size_t cls = 0; cls < BUFFER_POOL_CLASSES; cls++){
+		res.kept += bufferPoolLists[cls].size();
+		res.keptBytes += (unsigned long long)bufferPoolLists[cls].size() * (BUFFER_POOL_MIN_SIZE << cls);
+	}
+	return res;
+}
+
+PooledBuffer::PooledBuffer(size_t size)
+	: data_(NULL), size_(size), capacity_(0)
+{
+	if (size){
+		this->data_ = BufferPool::take(size, this->capacity_);
+	}
+}
+
+PooledBuffer::~PooledBuffer(){
+	BufferPool::give(this->data_, this->capacity_, this->size_);
+}
@@ -1,101 +1,310 @@
 #include "../stdafx.h"
 
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 #include "wrapper/common/log.h"
 
-Logger *logger = new Logger();
+/* Not started logger, used when no other is started */
+static Logger *loggerDefault = new Logger();
+std::atomic<Logger *> logger(loggerDefault);
+static thread_local Logger *loggerThread = NULL;
 
-static void writeLoggerLevel(FILE *file, LoggerLevel::LOGGER_LEVEL level){
-	std::string str_level("");
+static const char *getLoggerLevelName(LoggerLevel::LOGGER_LEVEL level){
 	switch (level){
 	case LoggerLevel::Debug:
-		str_level = "DEBUG";
-		break;
+		return "DEBUG";
 	case LoggerLevel::Error:
-		str_level = "ERROR";
-		break;
+		return "ERROR";
 	case LoggerLevel::Info:
-		str_level = "INFO";
-		break;
+		return "INFO";
 	case LoggerLevel::Warning:
-		str_level = "WARNING";
-		break;
+		return "WARNING";
 	case LoggerLevel::OpenSSL:
-		str_level = "OPENSSL";
-		break;
+		return "OPENSSL";
 	case LoggerLevel::Trace:
-		str_level = "TRACE";
-		break;
+		return "TRACE";
 	default:
-		//char *custom = (char *)malloc(20);
-		//sprintf(custom, "UNKNOWN", level);
-		//str_level = custom;
-		str_level = "UNKNOWN";
-		//free(custom);
+		return "UNKNOWN";
 	}
-	str_level += "\t";
-	fwrite(str_level.c_str(), 1, str_level.length(), file);
 }
 
-static void writeLoggerTime(FILE *file, time_t &datetime){
+static size_t formatLoggerTime(char *out, size_t size, time_t datetime){
 	struct tm aTm;
 #ifdef _WIN32
 	localtime_s(&aTm, &datetime);
 #else
 	localtime_r(&datetime, &aTm);
 #endif
-	char _time[30];
-	strftime(_time, 30, "%Y-%m-%d %H:%M:%S ", &aTm);
-	fwrite(_time, 1, strlen(_time), file);
+	return strftime(out, size, "%Y-%m-%d %H:%M:%S ", &aTm);
 }
 
-static void writeLoggerTime(FILE *file){
-	time_t curTime = time(NULL);
-	writeLoggerTime(file, curTime);
+/*
+* Format "LEVEL\tfn: message\n" into out. The record is truncated
+* to size, but always ends with the new line.
+*/
+static size_t formatLoggerRecord(char *out, size_t size, LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *msg, va_list args){
+	int len = snprintf(out, size, "%s\t%s: ", getLoggerLevelName(level), fn);
+	if (len < 0){
+		len = 0;
+	}
+	if ((size_t)len < size){
+		int msgLen = vsnprintf(out + len, size - len, msg, args);
+		if (msgLen > 0){
+			len += msgLen;
+		}
+	}
+	if ((size_t)len > size - 2){
+		len = size - 2;
+	}
+	out[len++] = '\n';
+	out[len] = '\0';
+	return len;
 }
 
-static void writeLoggerFunction(FILE *file, const char* fn){
-	fwrite(fn, 1, strlen(fn), file);
-	fwrite(": ", 1, 2, file);
-}
+struct LoggerRecord{
+	std::atomic<size_t> seq;
+	time_t time;
+	size_t length;
+	char text[LOGGER_RECORD_SIZE];
+};
+
+/*
+* Bounded multi-producer single-consumer queue of log records.
+* Producers never block: if there is no free record the message is dropped.
+* The flusher thread takes records in order and writes them by batches.
+*/
+class LoggerQueue{
+public:
+	LoggerQueue(FILE *file)
+		: file_(file), enqueuePos_(0), dequeuePos_(0), dropped_(0), running_(true), lastTime_(0)
+	{
+		for (size_t i = 0; i < LOGGER_QUEUE_SIZE; i++){
+			records_[i].seq.store(i, std::memory_order_relaxed);
+		}
+		lastTimeStr_[0] = '\0';
+		thread_ = std::thread(&LoggerQueue::run, this);
+	}
+
+	~LoggerQueue(){
+		{
+			std::lock_guard<std::mutex> lock(this->waitLock_);
+			this->running_.store(false, std::memory_order_release);
+		}
+		this->wait_.notify_one();
+		this->thread_.join();
+	}
+
+	void push(LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *msg, va_list args){
+		LoggerRecord *rec;
+		size_t pos = this->enqueuePos_.load(std::memory_order_relaxed);
+		for (;;){
+			rec = &this->records_[pos & (LOGGER_QUEUE_SIZE - 1)];
+			size_t seq = rec->seq.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0){
+				if (this->enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+					break;
+				}
+			}
+			else if (dif < 0){
+				this->dropped_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else{
+				pos = this->enqueuePos_.load(std::memory_order_relaxed);
+			}
+		}
+
+		rec->time = time(NULL);
+		rec->length = formatLoggerRecord(rec->text, sizeof(rec->text), level, fn, msg, args);
+		rec->seq.store(pos + 1, std::memory_order_release);
+
+		/*Wake up the flusher each half of the queue instead of waiting for its timeout*/
+		if (((pos + 1) & (LOGGER_QUEUE_SIZE / 2 - 1)) == 0){
+			this->wait_.notify_one();
+		}
+	}
+
+	unsigned long long dropped() const {
+		return this->dropped_.load(std::memory_order_relaxed);
+	}
+
+protected:
+	void run(){
+		std::string batch;
+		batch.reserve(LOGGER_QUEUE_SIZE * 64);
+
+		for (;;){
+			bool stopping = !this->running_.load(std::memory_order_acquire);
+
+			batch.clear();
+			while (batch.length() < batch.capacity()){
+				LoggerRecord *rec = &this->records_[this->dequeuePos_ & (LOGGER_QUEUE_SIZE - 1)];
+				if (rec->seq.load(std::memory_order_acquire) != this->dequeuePos_ + 1){
+					break;
+				}
+				if (rec->time != this->lastTime_){
+					this->lastTime_ = rec->time;
+					formatLoggerTime(this->lastTimeStr_, sizeof(this->lastTimeStr_), rec->time);
+				}
+				batch.append(this->lastTimeStr_);
+				batch.append(rec->text, rec->length);
+				rec->seq.store(this->dequeuePos_ + LOGGER_QUEUE_SIZE, std::memory_order_release);
+				this->dequeuePos_++;
+			}
+
+			if (!batch.empty()){
+				fwrite(batch.c_str(), 1, batch.length(), this->file_);
+				fflush(this->file_);
+				continue;
+			}
+
+			if (stopping){
+				break;
+			}
+
+			std::unique_lock<std::mutex> lock(this->waitLock_);
+			this->wait_.wait_for(lock, std::chrono::milliseconds(10));
+		}
+	}
+
+protected:
+	FILE *file_;
+	LoggerRecord records_[LOGGER_QUEUE_SIZE];
+	std::atomic<size_t> enqueuePos_;
+	size_t dequeuePos_;
+	std::atomic<unsigned long long> dropped_;
+	std::atomic<bool> running_;
+	time_t lastTime_;
+	char lastTimeStr_[30];
+	std::mutex waitLock_;
+	std::condition_variable wait_;
+	std::thread thread_;
+};
+
+/* The thread is counted as writer while it uses the file or the queue of the logger */
+class LoggerWriter{
+public:
+	LoggerWriter(std::atomic<int> &writers) : writers_(writers){
+		this->writers_.fetch_add(1);
+	}
+
+	~LoggerWriter(){
+		this->writers_.fetch_sub(1, std::memory_order_release);
+	}
+
+protected:
+	std::atomic<int> &writers_;
+};
 
 Logger::~Logger(){
-	delete logger;
+	this->stop();
 };
 
+Logger *Logger::current(){
+	Logger *res = loggerThread;
+	return res ? res : logger.load(std::memory_order_acquire);
+}
+
 void Logger::init() {
 	this->levels = LoggerLevel::Null;
 	this->_file = NULL;
 	this->_filename = NULL;
+	this->_queue = NULL;
+	this->_dropped = 0;
+	this->_writers = 0;
 };
 
-void Logger::start(const char *filename, int levels){
-	if ((this->_file = fopen(filename, "a+")) == NULL) {
+void Logger::waitWriters() const {
+	while (this->_writers.load() != 0){
+		std::this_thread::yield();
+	}
+}
+
+/*
+* Threads which load the file (queue) after the exchange see NULL, the others
+* are counted in _writers before the load
+*/
+FILE *Logger::detach(){
+	FILE *file = this->_file.exchange(NULL);
+	this->waitWriters();
+	return file;
+}
+
+void Logger::start(const char *filename, int levels, bool async){
+	if (this->_file.load() || this->_queue.load()){
+		this->stop();
+	}
+
+	FILE *file;
+	if ((file = fopen(filename, "a+")) == NULL) {
 		THROW_EXCEPTION(0, Logger, NULL, "Error open file");
 	};
 	this->_filename = new std::string(filename);
+
+	if (async){
+		this->_queue.store(new LoggerQueue(file));
+	}
+	this->_file.store(file);
+
 	this->levels = levels;
 
-	logger = this;
+	loggerThread = this;
+	Logger *expected = loggerDefault;
+	logger.compare_exchange_strong(expected, this);
 }
 
 void Logger::stop(){
-	if (this->_file){
-		fclose(this->_file);
-		this->_file = NULL;
-	}
 	this->levels = LoggerLevel::Null;
+
+	if (loggerThread == this){
+		loggerThread = NULL;
+	}
+	Logger *expected = this;
+	logger.compare_exchange_strong(expected, loggerDefault);
+
+	LoggerQueue *queue = this->_queue.exchange(NULL);
+	FILE *file = this->detach();
+
+	if (queue){
+		this->_dropped += queue->dropped();
+		delete queue;
+	}
+
+	if (file){
+		fclose(file);
+	}
 }
 
 void Logger::clear(){
-	if (this->_file){
-		fclose(this->_file);
-		this->_file = NULL;
+	if (this->_queue.load()){
+		THROW_EXCEPTION(0, Logger, NULL, "Can not clear file of asynchronous logger. Stop it first");
 	}
-	if ((this->_file = fopen(this->_filename->c_str(), "w+")) == NULL) {
+
+	FILE *file = this->detach();
+	if (file){
+		fclose(file);
+	}
+	if ((file = fopen(this->_filename->c_str(), "w+")) == NULL) {
 		THROW_EXCEPTION(0, Logger, NULL, "Error open file");
 	};
+	this->_file.store(file);
+}
+
+unsigned long long Logger::dropped() const {
+	LoggerWriter writer(this->_writers);
+
+	unsigned long long res = this->_dropped;
+	LoggerQueue *queue = this->_queue.load();
+	if (queue){
+		res += queue->dropped();
+	}
+	return res;
 }
 
 void Logger::write(LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *msg, ...){
@@ -106,18 +315,29 @@ void Logger::write(LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *
 }
 
 void Logger::write(LoggerLevel::LOGGER_LEVEL level, const char* fn, const char *msg, va_list args){
-	if (this->_file && level && (level & this->levels)){
-		writeLoggerTime(this->_file);
-		writeLoggerLevel(this->_file, level);
-		writeLoggerFunction(this->_file, fn);
-		char *out = (char *)malloc(1024);
-		vsnprintf(out, 1024, msg, args);
-		fwrite(out, 1, strlen(out), this->_file);
-		free(out);
-		std::string newLine("\n");
-		fwrite(newLine.c_str(), 1, newLine.length(), this->_file);
-		fflush(this->_file);
+	if (!(level && this->isEnabled(level))){
+		return;
+	}
+
+	LoggerWriter writer(this->_writers);
+
+	LoggerQueue *queue = this->_queue.load();
+	if (queue){
+		queue->push(level, fn, msg, args);
+		return;
+	}
+
+	FILE *file = this->_file.load();
+	if (!file){
+		return;
 	}
+
+	/*Whole line is written by the one fwrite call*/
+	char out[30 + LOGGER_RECORD_SIZE];
+	size_t len = formatLoggerTime(out, 30, time(NULL));
+	len += formatLoggerRecord(out + len, LOGGER_RECORD_SIZE, level, fn, msg, args);
+	fwrite(out, 1, len, file);
+	fflush(file);
 }
 
 void Logger::debug(const char* fn, const char *msg, ...){
@@ -147,13 +367,3 @@ void Logger::info(const char* fn, const char *msg, ...){
 	this->write(LoggerLevel::Info, fn, msg, args);
 	va_end(args);
 }
-
-LoggerFunction::LoggerFunction(Logger *logger, const char*fn){
-	this->_fn = new std::string(fn);
-	this->_logger = logger;
-	this->_logger->write(LoggerLevel::Trace, this->_fn->c_str(), "Begin");
-}
-
-LoggerFunction::~LoggerFunction(){
-	this->_logger->write(LoggerLevel::Trace, this->_fn->c_str(), "End");
-}
@@ -0,0 +1,370 @@
+#include "../stdafx.h"
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "wrapper/common/bio.h"
+#include "wrapper/common/thread_pool.h"
+
+/*
+* Read-only BIO over a memory mapped file. Pages are read by the kernel
+* on access, so the file is never copied into the heap. The mapping is
+* advised for sequential access; pages of passed windows are dropped,
+* so RSS stays near BIO_MMAP_WINDOW even for multi-GB files.
+* Truncation of the file by another process is not detected: reading
+* the lost pages in mmap_read/mmap_gets raises SIGBUS.
+*/
+#define BIO_MMAP_WINDOW (8 * 1024 * 1024)
+
+struct BioMmap{
+	unsigned char *data;
+	size_t length;
+	size_t pos;
+	size_t window;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+};
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+#define BIO_MMAP_get(b) ((BioMmap *)BIO_get_data(b))
+#else
+#define BIO_MMAP_get(b) ((BioMmap *)(b)->ptr)
+#endif
+
+static void mmapAdvise(BioMmap *m, size_t window, int advice){
+#ifndef _WIN32
+	size_t offset = window * BIO_MMAP_WINDOW;
+	if (offset >= m->length){
+		return;
+	}
+	size_t len = m->length - offset < BIO_MMAP_WINDOW ? m->length - offset : BIO_MMAP_WINDOW;
+	madvise(m->data + offset, len, advice);
+#endif
+}
+
+/* Move to the next window: prefetch it and drop the pages behind */
+static void mmapAdvance(BioMmap *m){
+#ifndef _WIN32
+	size_t window = m->pos / BIO_MMAP_WINDOW;
+	if (window == m->window){
+		return;
+	}
+	if (window > m->window){
+		for (size_t i = m->window; i < window; i++){
+			mmapAdvise(m, i, MADV_DONTNEED);
+		}
+	}
+	mmapAdvise(m, window + 1, MADV_WILLNEED);
+	m->window = window;
+#endif
+}
+
+static void mmapClose(BioMmap *m){
+#ifdef _WIN32
+	if (m->data){
+		UnmapViewOfFile(m->data);
+	}
+	if (m->mapping){
+		CloseHandle(m->mapping);
+	}
+	if (m->file != INVALID_HANDLE_VALUE){
+		CloseHandle(m->file);
+	}
+#else
+	if (m->data){
+		munmap(m->data, m->length);
+	}
+#endif
+	delete m;
+}
+
+static BioMmap *mmapOpen(const char *filename){
+	BioMmap *m = new BioMmap();
+	m->data = NULL;
+	m->length = 0;
+	m->pos = 0;
+	m->window = 0;
+
+#ifdef _WIN32
+	m->mapping = NULL;
+	m->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m->file == INVALID_HANDLE_VALUE){
+		mmapClose(m);
+		return NULL;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m->file, &size)){
+		mmapClose(m);
+		return NULL;
+	}
+	m->length = (size_t)size.QuadPart;
+	if (!m->length){
+		return m;
+	}
+
+	m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m->mapping){
+		mmapClose(m);
+		return NULL;
+	}
+	m->data = (unsigned char *)MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m->data){
+		mmapClose(m);
+		return NULL;
+	}
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0){
+		mmapClose(m);
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0){
+		close(fd);
+		mmapClose(m);
+		return NULL;
+	}
+	m->length = (size_t)st.st_size;
+	if (!m->length){
+		close(fd);
+		return m;
+	}
+
+	void *data = mmap(NULL, m->length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED){
+		mmapClose(m);
+		return NULL;
+	}
+	m->data = (unsigned char *)data;
+
+	madvise(m->data, m->length, MADV_SEQUENTIAL);
+	mmapAdvise(m, 0, MADV_WILLNEED);
+	mmapAdvise(m, 1, MADV_WILLNEED);
+#endif
+
+	return m;
+}
+
+/* Reads fail when the pool task is cancelled, so OpenSSL loops stop */
+static int mmap_read(BIO *b, char *out, int outl){
+	BioMmap *m = BIO_MMAP_get(b);
+	if (!m || !out || outl <= 0){
+		return 0;
+	}
+	if (ThreadPool::cancelled()){
+		return -1;
+	}
+
+	size_t len = m->length - m->pos;
+	if (len > (size_t)outl){
+		len = (size_t)outl;
+	}
+	memcpy(out, m->data + m->pos, len);
+	m->pos += len;
+	mmapAdvance(m);
+
+	return (int)len;
+}
+
+static int mmap_write(BIO *, const char *, int){
+	BIOerr(BIO_F_BIO_WRITE, BIO_R_WRITE_TO_READ_ONLY_BIO);
+	return -1;
+}
+
+static int mmap_gets(BIO *b, char *buf, int size){
+	BioMmap *m = BIO_MMAP_get(b);
+	if (!m || !buf || size <= 0){
+		return 0;
+	}
+	if (ThreadPool::cancelled()){
+		return -1;
+	}
+
+	size_t len = m->length - m->pos;
+	if (len > (size_t)(size - 1)){
+		len = (size_t)(size - 1);
+	}
+	const unsigned char *eol = (const unsigned char *)memchr(m->data + m->pos, '\n', len);
+	if (eol){
+		len = eol - (m->data + m->pos) + 1;
+	}
+	memcpy(buf, m->data + m->pos, len);
+	buf[len] = '\0';
+	m->pos += len;
+	mmapAdvance(m);
+
+	return (int)len;
+}
+
+static long mmap_ctrl(BIO *b, int cmd, long num, void *ptr){
+	BioMmap *m = BIO_MMAP_get(b);
+	if (!m){
+		return 0;
+	}
+
+	switch (cmd){
+	case BIO_CTRL_RESET:
+		m->pos = 0;
+		mmapAdvance(m);
+		return 1;
+	case BIO_C_FILE_SEEK:
+		if (num < 0 || (size_t)num > m->length){
+			return -1;
+		}
+		m->pos = (size_t)num;
+		mmapAdvance(m);
+		return num;
+	case BIO_C_FILE_TELL:
+		return (long)m->pos;
+	case BIO_CTRL_EOF:
+		return m->pos >= m->length;
+	case BIO_CTRL_PENDING:
+		return (long)(m->length - m->pos);
+	case BIO_CTRL_INFO:
+		if (ptr){
+			*(char **)ptr = (char *)m->data + m->pos;
+		}
+		return (long)(m->length - m->pos);
+	case BIO_CTRL_WPENDING:
+		return 0;
+	case BIO_CTRL_FLUSH:
+	case BIO_CTRL_DUP:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static int mmap_new(BIO *b){
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	BIO_set_data(b, NULL);
+	BIO_set_init(b, 0);
+#else
+	b->ptr = NULL;
+	b->init = 0;
+	b->num = -1;
+#endif
+	return 1;
+}
+
+static int mmap_free(BIO *b){
+	if (!b){
+		return 0;
+	}
+
+	BioMmap *m = BIO_MMAP_get(b);
+	if (m){
+		mmapClose(m);
+	}
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	BIO_set_data(b, NULL);
+	BIO_set_init(b, 0);
+#else
+	b->ptr = NULL;
+	b->init = 0;
+#endif
+	return 1;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+static BIO_METHOD *mmapMethodNew(){
+	BIO_METHOD *method = BIO_meth_new(BIO_TYPE_MMAP, "memory mapped file");
+	if (!method){
+		return NULL;
+	}
+	BIO_meth_set_write(method, mmap_write);
+	BIO_meth_set_read(method, mmap_read);
+	BIO_meth_set_gets(method, mmap_gets);
+	BIO_meth_set_ctrl(method, mmap_ctrl);
+	BIO_meth_set_create(method, mmap_new);
+	BIO_meth_set_destroy(method, mmap_free);
+	return method;
+}
+
+/* Initialization of the local static is thread-safe */
+BIO_METHOD *BIO_s_mmap(){
+	static BIO_METHOD *mmapMethod = mmapMethodNew();
+	return mmapMethod;
+}
+#else
+static BIO_METHOD mmapMethod = {
+	BIO_TYPE_MMAP,
+	"memory mapped file",
+	mmap_write,
+	mmap_read,
+	NULL,
+	mmap_gets,
+	mmap_ctrl,
+	mmap_new,
+	mmap_free,
+	NULL,
+};
+
+BIO_METHOD *BIO_s_mmap(){
+	return &mmapMethod;
+}
+#endif
+
+BIO *BIO_new_mmap(const char *filename){
+	BIO_METHOD *method = BIO_s_mmap();
+	if (!method){
+		return NULL;
+	}
+
+	BioMmap *m = mmapOpen(filename);
+	if (!m){
+		return NULL;
+	}
+
+	BIO *b = BIO_new(method);
+	if (!b){
+		mmapClose(m);
+		return NULL;
+	}
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	BIO_set_data(b, m);
+	BIO_set_init(b, 1);
+#else
+	b->ptr = m;
+	b->init = 1;
+#endif
+	return b;
+}
+
+int BIO_mmap_get_data(BIO *b, const unsigned char **data, size_t *length){
+	if (!b || BIO_method_type(b) != BIO_TYPE_MMAP){
+		return 0;
+	}
+
+	BioMmap *m = BIO_MMAP_get(b);
+	*data = m->data + m->pos;
+	*length = m->length - m->pos;
+	return 1;
+}
+
+int BIO_mmap_skip(BIO *b, size_t length){
+	if (!b || BIO_method_type(b) != BIO_TYPE_MMAP){
+		return 0;
+	}
+
+	BioMmap *m = BIO_MMAP_get(b);
+	if (length > m->length - m->pos){
+		return 0;
+	}
+	m->pos += length;
+	mmapAdvance(m);
+	return 1;
+}
@@ -1,14 +1,264 @@
 #include "../stdafx.h"
 
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string.h>
+
 #include "wrapper/common/openssl.h"
 #include "wrapper/common/common.h"
 
-void OpenSSL::run() {
+/*
+* OpenSSL memory functions. The requested size is kept in a header before
+* the block, because free gets only the pointer. Blocks which fit into
+* POOL_MAX_SIZE with the header are taken from ObjectPool.
+*/
+#define OPENSSL_MEM_HEADER 16
+
+static bool memInstalled = false;
+
+static std::mutex runLock;
+static size_t runCount = 0;
+static std::atomic<unsigned long long> memAllocations(0);
+static std::atomic<unsigned long long> memReleases(0);
+static std::atomic<unsigned long long> memLiveBytes(0);
+static std::atomic<unsigned long long> memAllocatedBytes(0);
+
+static void *memBlockAllocate(size_t total){
+	if (total <= POOL_MAX_SIZE){
+		return ObjectPool::allocate(total);
+	}
+	return ::malloc(total);
+}
+
+static void memBlockRelease(void *block, size_t total){
+	if (total <= POOL_MAX_SIZE){
+		ObjectPool::release(block, total);
+		return;
+	}
+	::free(block);
+}
+
+static void *memMalloc(size_t num){
+	char *block = (char *)memBlockAllocate(num + OPENSSL_MEM_HEADER);
+	if (!block){
+		return NULL;
+	}
+	*(size_t *)block = num;
+
+	memAllocations.fetch_add(1, std::memory_order_relaxed);
+	memLiveBytes.fetch_add(num, std::memory_order_relaxed);
+	memAllocatedBytes.fetch_add(num, std::memory_order_relaxed);
+
+	return block + OPENSSL_MEM_HEADER;
+}
+
+static void memFree(void *ptr){
+	if (!ptr){
+		return;
+	}
+	char *block = (char *)ptr - OPENSSL_MEM_HEADER;
+	size_t num = *(size_t *)block;
+
+	memReleases.fetch_add(1, std::memory_order_relaxed);
+	memLiveBytes.fetch_sub(num, std::memory_order_relaxed);
+
+	memBlockRelease(block, num + OPENSSL_MEM_HEADER);
+}
+
+static void *memRealloc(void *ptr, size_t num){
+	if (!ptr){
+		return memMalloc(num);
+	}
+	if (!num){
+		memFree(ptr);
+		return NULL;
+	}
+
+	char *block = (char *)ptr - OPENSSL_MEM_HEADER;
+	size_t old = *(size_t *)block;
+
+	/* Both blocks are out of the pool, so the system may grow it in place */
+	if (old + OPENSSL_MEM_HEADER > POOL_MAX_SIZE && num + OPENSSL_MEM_HEADER > POOL_MAX_SIZE){
+		block = (char *)::realloc(block, num + OPENSSL_MEM_HEADER);
+		if (!block){
+			return NULL;
+		}
+		*(size_t *)block = num;
+		memLiveBytes.fetch_add(num - old, std::memory_order_relaxed);
+		if (num > old){
+			memAllocatedBytes.fetch_add(num - old, std::memory_order_relaxed);
+		}
+		return block + OPENSSL_MEM_HEADER;
+	}
+
+	void *res = memMalloc(num);
+	if (!res){
+		return NULL;
+	}
+	memcpy(res, ptr, old < num ? old : num);
+	memFree(ptr);
+	return res;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+static void *memMallocEx(size_t num, const char *, int){
+	return memMalloc(num);
+}
+
+static void *memReallocEx(void *ptr, size_t num, const char *, int){
+	return memRealloc(ptr, num);
+}
+
+static void memFreeEx(void *ptr, const char *, int){
+	memFree(ptr);
+}
+#endif
+
+/*
+* Must be called before the first OpenSSL allocation. OpenSSL refuses new
+* functions after it, e.g. when the library is shared with the Node.js
+* process, and then keeps its own allocator.
+*/
+static bool installMemFunctions(){
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	return CRYPTO_set_mem_functions(memMallocEx, memReallocEx, memFreeEx) != 0;
+#else
+	return CRYPTO_set_mem_functions(memMalloc, memRealloc, memFree) != 0;
+#endif
+}
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+/*
+* OpenSSL 1.0 needs locking and thread id callbacks to be used from several
+* threads. Each static lock is placed in its own cache line, so threads
+* taking neighbour locks do not invalidate each other's line.
+*/
+#define OPENSSL_CACHE_LINE 64
+
+struct OpenSSLLock{
+	std::mutex mutex;
+	char pad[OPENSSL_CACHE_LINE - sizeof(std::mutex) % OPENSSL_CACHE_LINE];
+};
+
+struct CRYPTO_dynlock_value{
+	std::mutex mutex;
+};
+
+static char *locksBuffer = NULL;
+static OpenSSLLock *locks = NULL;
+static int locksCount = 0;
+
+/* Address of the thread local is unique for every live thread */
+static thread_local char threadTag;
+
+static void lockingCallback(int mode, int n, const char *file, int line){
+	if (mode & CRYPTO_LOCK){
+		locks[n].mutex.lock();
+	}
+	else{
+		locks[n].mutex.unlock();
+	}
+}
+
+static void threadIdCallback(CRYPTO_THREADID *id){
+	CRYPTO_THREADID_set_pointer(id, &threadTag);
+}
+
+static CRYPTO_dynlock_value *dynlockCreateCallback(const char *file, int line){
+	return new CRYPTO_dynlock_value();
+}
+
+static void dynlockLockCallback(int mode, CRYPTO_dynlock_value *l, const char *file, int line){
+	if (mode & CRYPTO_LOCK){
+		l->mutex.lock();
+	}
+	else{
+		l->mutex.unlock();
+	}
+}
+
+static void dynlockDestroyCallback(CRYPTO_dynlock_value *l, const char *file, int line){
+	delete l;
+}
+
+static void installThreadCallbacks(){
+	if (locks){
+		return;
+	}
+
+	/* Host process (e.g. Node.js sharing its OpenSSL) may have installed them */
+	if (CRYPTO_get_locking_callback()){
+		LOGGER_INFO("OpenSSL locking callback is already installed");
+		return;
+	}
+
+	locksCount = CRYPTO_num_locks();
+	locksBuffer = new char[(locksCount + 1) * sizeof(OpenSSLLock)];
+	size_t offset = OPENSSL_CACHE_LINE - (size_t)locksBuffer % OPENSSL_CACHE_LINE;
+	locks = (OpenSSLLock *)(locksBuffer + offset % OPENSSL_CACHE_LINE);
+	for (int i = 0; i < locksCount; i++){
+		new (&locks[i]) OpenSSLLock();
+	}
+
+	LOGGER_OPENSSL(CRYPTO_THREADID_set_callback);
+	CRYPTO_THREADID_set_callback(threadIdCallback);
+	LOGGER_OPENSSL(CRYPTO_set_locking_callback);
+	CRYPTO_set_locking_callback(lockingCallback);
+
+	CRYPTO_set_dynlock_create_callback(dynlockCreateCallback);
+	CRYPTO_set_dynlock_lock_callback(dynlockLockCallback);
+	CRYPTO_set_dynlock_destroy_callback(dynlockDestroyCallback);
+}
+
+static void removeThreadCallbacks(){
+	if (!locks){
+		return;
+	}
+
+	LOGGER_OPENSSL(CRYPTO_set_locking_callback);
+	CRYPTO_set_locking_callback(NULL);
+	CRYPTO_set_dynlock_create_callback(NULL);
+	CRYPTO_set_dynlock_lock_callback(NULL);
+	CRYPTO_set_dynlock_destroy_callback(NULL);
+
+	for (int i = 0; i < locksCount; i++){
+		locks[i].~OpenSSLLock();
+	}
+	delete[] locksBuffer;
+	locksBuffer = NULL;
+	locks = NULL;
+	locksCount = 0;
+}
+#else
+/* OpenSSL 1.1 and later is thread-safe without callbacks */
+static void installThreadCallbacks(){}
+static void removeThreadCallbacks(){}
+#endif
+
+void OpenSSL::run(OpenSSLProfile::OPENSSL_PROFILE profile) {
 	LOGGER_FN();
 
-	CRYPTO_malloc_debug_init();
-	CRYPTO_set_mem_debug_options(V_CRYPTO_MDEBUG_ALL);
-	
+	std::lock_guard<std::mutex> lock(runLock);
+	if (runCount++){
+		LOGGER_INFO("OpenSSL is already initialized");
+		return;
+	}
+
+	if (profile == OpenSSLProfile::Debug){
+		CRYPTO_malloc_debug_init();
+		CRYPTO_set_mem_debug_options(V_CRYPTO_MDEBUG_ALL);
+	}
+	else if (!memInstalled){
+		LOGGER_OPENSSL(CRYPTO_set_mem_functions);
+		memInstalled = installMemFunctions();
+		if (!memInstalled){
+			LOGGER_WARN("OpenSSL has already allocated memory, default allocator is used");
+		}
+	}
+
+	installThreadCallbacks();
+
 	LOGGER_OPENSSL(ERR_load_crypto_strings);
 	ERR_load_crypto_strings();
 
@@ -26,6 +276,11 @@ void OpenSSL::run() {
 void OpenSSL::stop() {
 	LOGGER_FN();
 
+	std::lock_guard<std::mutex> lock(runLock);
+	if (!runCount || --runCount){
+		return;
+	}
+
 	LOGGER_OPENSSL(OBJ_cleanup);
 	OBJ_cleanup();
 
@@ -46,6 +301,20 @@ void OpenSSL::stop() {
 
 	LOGGER_OPENSSL(ERR_free_strings);
 	ERR_free_strings();
+
+	removeThreadCallbacks();
+}
+
+void OpenSSL::threadCleanup() {
+	LOGGER_FN();
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+	LOGGER_OPENSSL(ERR_remove_thread_state);
+	ERR_remove_thread_state(NULL);
+#else
+	LOGGER_OPENSSL(OPENSSL_thread_stop);
+	OPENSSL_thread_stop();
+#endif
 }
 
 Handle<std::string> OpenSSL::printErrors()
@@ -57,3 +326,13 @@ Handle<std::string> OpenSSL::printErrors()
 
 	return out->read();
 }
+
+OpenSSL::MemoryStats OpenSSL::memoryStats(){
+	MemoryStats res;
+	res.installed = memInstalled;
+	res.allocations = memAllocations.load(std::memory_order_relaxed);
+	res.releases = memReleases.load(std::memory_order_relaxed);
+	res.liveBytes = memLiveBytes.load(std::memory_order_relaxed);
+	res.allocatedBytes = memAllocatedBytes.load(std::memory_order_relaxed);
+	return res;
+}
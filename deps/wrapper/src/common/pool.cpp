@@ -0,0 +1,240 @@
+#include "../stdafx.h"
+
+#include <new>
+#include <atomic>
+#include <mutex>
+
+#include "wrapper/common/common.h"
+
+#define POOL_CLASSES (POOL_MAX_SIZE / POOL_GRANULARITY)
+/* Count of blocks moved between thread cache and shared list at once */
+#define POOL_BATCH 32
+
+struct PoolBlock{
+	PoolBlock *next;
+};
+
+struct PoolList{
+	PoolBlock *head;
+	size_t count;
+};
+
+static std::mutex poolLocks[POOL_CLASSES];
+static PoolList poolShared[POOL_CLASSES];
+
+/* Counters of exited threads and of requests served without thread cache */
+static std::atomic<unsigned long long> poolAllocations(0);
+static std::atomic<unsigned long long> poolReleases(0);
+static std::atomic<unsigned long long> poolSlabs(0);
+static std::atomic<unsigned long long> poolLarge(0);
+
+static inline size_t poolClass(size_t size){
+	return size ? (size - 1) / POOL_GRANULARITY : 0;
+}
+
+static void poolCarveSlab(PoolList &list, size_t cls){
+	size_t blockSize = (cls + 1) * POOL_GRANULARITY;
+	char *slab = (char *)::operator new(POOL_SLAB_SIZE);
+	poolSlabs.fetch_add(1, std::memory_order_relaxed);
+	for (size_t offset = 0; offset + blockSize <= POOL_SLAB_SIZE; offset += blockSize){
+		PoolBlock *block = (PoolBlock *)(slab + offset);
+		block->next = list.head;
+		list.head = block;
+		list.count++;
+	}
+}
+
+/* Move up to count blocks from src to dst */
+static void poolMove(PoolList &dst, PoolList &src, size_t count){
+	while (count-- && src.head){
+		PoolBlock *block = src.head;
+		src.head = block->next;
+		src.count--;
+		block->next = dst.head;
+		dst.head = block;
+		dst.count++;
+	}
+}
+
+/* Set when the thread cache is destroyed, blocks then go to shared lists directly */
+static thread_local bool poolCacheDestroyed = false;
+
+class PoolCache;
+
+/* Live thread caches, walked by ObjectPool::stats() */
+static std::mutex poolCachesLock;
+static PoolCache *poolCaches = NULL;
+
+/*
+* Thread cache of free blocks. Its counters are written only by the owner
+* thread, so they are updated without locked instructions.
+*/
+class PoolCache{
+public:
+	PoolCache()
+		: allocations(0), releases(0), prev_(NULL), next_(NULL)
+	{
+		for (size_t i = 0; i < POOL_CLASSES; i++){
+			lists[i].head = NULL;
+			lists[i].count = 0;
+		}
+
+		std::lock_guard<std::mutex> lock(poolCachesLock);
+		this->next_ = poolCaches;
+		if (poolCaches){
+			poolCaches->prev_ = this;
+		}
+		poolCaches = this;
+	}
+
+	/* Return cached blocks to shared lists when the thread exits */
+	~PoolCache(){
+		poolCacheDestroyed = true;
+		for (size_t i = 0; i < POOL_CLASSES; i++){
+			if (lists[i].count){
+				std::lock_guard<std::mutex> lock(poolLocks[i]);
+				poolMove(poolShared[i], lists[i], lists[i].count);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(poolCachesLock);
+		poolAllocations.fetch_add(this->allocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		poolReleases.fetch_add(this->releases.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		if (this->prev_){
+			this->prev_->next_ = this->next_;
+		}
+		else{
+			poolCaches = this->next_;
+		}
+		if (this->next_){
+			this->next_->prev_ = this->prev_;
+		}
+	}
+
+	void *allocate(size_t cls){
+		this->allocations.store(this->allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		PoolList &list = lists[cls];
+		if (!list.head){
+			refill(cls);
+		}
+		PoolBlock *block = list.head;
+		list.head = block->next;
+		list.count--;
+		return block;
+	}
+
+	void release(void *ptr, size_t cls){
+		this->releases.store(this->releases.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		PoolList &list = lists[cls];
+		PoolBlock *block = (PoolBlock *)ptr;
+		block->next = list.head;
+		list.head = block;
+		list.count++;
+
+		if (list.count > 2 * POOL_BATCH){
+			std::lock_guard<std::mutex> lock(poolLocks[cls]);
+			poolMove(poolShared[cls], list, POOL_BATCH);
+		}
+	}
+
+protected:
+	void refill(size_t cls){
+		PoolList &list = lists[cls];
+		{
+			std::lock_guard<std::mutex> lock(poolLocks[cls]);
+			poolMove(list, poolShared[cls], POOL_BATCH);
+		}
+		if (!list.head){
+			poolCarveSlab(list, cls);
+		}
+	}
+
+public:
+	std::atomic<unsigned long long> allocations;
+	std::atomic<unsigned long long> releases;
+	PoolCache *prev_;
+	PoolCache *next_;
+
+protected:
+	PoolList lists[POOL_CLASSES];
+};
+
+static thread_local PoolCache poolCache;
+
+static void *poolSharedAllocate(size_t cls){
+	std::lock_guard<std::mutex> lock(poolLocks[cls]);
+	PoolList &list = poolShared[cls];
+	if (!list.head){
+		poolCarveSlab(list, cls);
+	}
+	PoolBlock *block = list.head;
+	list.head = block->next;
+	list.count--;
+	return block;
+}
+
+static void poolSharedRelease(void *ptr, size_t cls){
+	std::lock_guard<std::mutex> lock(poolLocks[cls]);
+	PoolList &list = poolShared[cls];
+	PoolBlock *block = (PoolBlock *)ptr;
+	block->next = list.head;
+	list.head = block;
+	list.count++;
+}
+
+void *ObjectPool::allocate(size_t size){
+#ifndef WRAPPER_NO_POOL
+	if (size <= POOL_MAX_SIZE){
+		if (!poolCacheDestroyed){
+			return poolCache.allocate(poolClass(size));
+		}
+		poolAllocations.fetch_add(1, std::memory_order_relaxed);
+		return poolSharedAllocate(poolClass(size));
+	}
+#endif
+
+	poolAllocations.fetch_add(1, std::memory_order_relaxed);
+	poolLarge.fetch_add(1, std::memory_order_relaxed);
+	return ::operator new(size);
+}
+
+void ObjectPool::release(void *ptr, size_t size){
+	if (!ptr){
+		return;
+	}
+
+#ifndef WRAPPER_NO_POOL
+	if (size <= POOL_MAX_SIZE){
+		if (!poolCacheDestroyed){
+			poolCache.release(ptr, poolClass(size));
+			return;
+		}
+		poolReleases.fetch_add(1, std::memory_order_relaxed);
+		poolSharedRelease(ptr, poolClass(size));
+		return;
+	}
+#endif
+
+	poolReleases.fetch_add(1, std::memory_order_relaxed);
+	::operator delete(ptr);
+}
+
+ObjectPool::Stats ObjectPool::stats(){
+	Stats res;
+	{
+		std::lock_guard<std::mutex> lock(poolCachesLock);
+		res.allocations = poolAllocations.load(std::memory_order_relaxed);
+		res.releases = poolReleases.load(std::memory_order_relaxed);
+		for (PoolCache *cache = poolCaches; cache; cache = cache->next_){
+			res.allocations += cache->allocations.load(std::memory_order_relaxed);
+			res.releases += cache->releases.load(std::memory_order_relaxed);
+		}
+	}
+	res.live = res.allocations - res.releases;
+	res.slabs = poolSlabs.load(std::memory_order_relaxed);
+	res.slabBytes = res.slabs * POOL_SLAB_SIZE;
+	res.large = poolLarge.load(std::memory_order_relaxed);
+	return res;
+}
@@ -0,0 +1,277 @@
+#include "../stdafx.h"
+
+#include "wrapper/common/common.h"
+#include "wrapper/common/thread_pool.h"
+
+/* Cancel flag of the task running on the thread */
+static thread_local std::atomic<bool> *threadCancel = NULL;
+
+static std::atomic<ThreadPool *> sharedPool(NULL);
+
+ThreadPool::ThreadPool(size_t size)
+	: stopping_(false), size_(0), retiring_(0), running_(0),
+	nextId_(0), completed_(0), rejected_(0), removed_(0)
+{
+	LOGGER_FN();
+
+	for (size_t i = 0; i < THREAD_POOL_PRIORITIES; i++){
+		this->limits_[i] = 0;
+	}
+
+	if (!size){
+		size = ThreadPool::defaultSize();
+	}
+
+	std::lock_guard<std::mutex> lock(this->lock_);
+	this->start(size);
+}
+
+/* Queued tasks are completed before the threads are joined */
+ThreadPool::~ThreadPool(){
+	LOGGER_FN();
+
+	{
+		std::lock_guard<std::mutex> lock(this->lock_);
+		this->stopping_ = true;
+	}
+	this->wait_.notify_all();
+
+	ThreadPool *self = this;
+	sharedPool.compare_exchange_strong(self, NULL);
+
+	for (size_t i = 0; i < this->threads_.size(); i++){
+		this->threads_[i].join();
+	}
+}
+
+/* Called under lock */
+void ThreadPool::start(size_t count){
+	LOGGER_INFO("Start %d threads", (int)count);
+
+	for (size_t i = 0; i < count; i++){
+		this->threads_.push_back(std::thread(&ThreadPool::run, this));
+	}
+	this->size_ += count;
+}
+
+/* Called under lock. Threads which have exited are joined by the caller */
+std::vector<std::thread> ThreadPool::takeRetired(){
+	std::vector<std::thread> res;
+
+	for (size_t i = 0; i < this->retired_.size(); i++){
+		for (size_t j = 0; j < this->threads_.size(); j++){
+			if (this->threads_[j].get_id() == this->retired_[i]){
+				res.push_back(std::move(this->threads_[j]));
+				this->threads_.erase(this->threads_.begin() + j);
+				break;
+			}
+		}
+	}
+	this->retired_.clear();
+
+	return res;
+}
+
+unsigned long long ThreadPool::push(const Task &task, Priority priority, const CancelFlag &cancel){
+	LOGGER_FN();
+
+	if (priority < High || priority > Low){
+		THROW_EXCEPTION(0, ThreadPool, NULL, "Unknown priority %d", (int)priority);
+	}
+
+	unsigned long long id;
+	{
+		std::lock_guard<std::mutex> lock(this->lock_);
+		if (this->stopping_){
+			THROW_EXCEPTION(0, ThreadPool, NULL, "Thread pool is stopped");
+		}
+		std::deque<Item> &queue = this->tasks_[priority];
+		if (this->limits_[priority] && queue.size() >= this->limits_[priority]){
+			this->rejected_++;
+			THROW_EXCEPTION(0, ThreadPool, NULL, "Queue is full (%d pending tasks)", (int)queue.size());
+		}
+
+		Item item;
+		item.id = id = ++this->nextId_;
+		item.task = task;
+		item.cancel = cancel;
+		queue.push_back(item);
+	}
+	this->wait_.notify_one();
+
+	return id;
+}
+
+bool ThreadPool::remove(unsigned long long id){
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->lock_);
+	for (size_t i = 0; i < THREAD_POOL_PRIORITIES; i++){
+		std::deque<Item> &queue = this->tasks_[i];
+		for (std::deque<Item>::iterator it = queue.begin(); it != queue.end(); it++){
+			if (it->id == id){
+				queue.erase(it);
+				this->removed_++;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::resize(size_t size){
+	LOGGER_FN();
+
+	if (!size){
+		size = ThreadPool::defaultSize();
+	}
+
+	std::vector<std::thread> retired;
+	{
+		std::lock_guard<std::mutex> lock(this->lock_);
+		if (this->stopping_){
+			THROW_EXCEPTION(0, ThreadPool, NULL, "Thread pool is stopped");
+		}
+
+		if (size > this->size_){
+			/* Keep threads which are asked to exit, but not exited yet */
+			size_t count = size - this->size_;
+			size_t keep = count < this->retiring_ ? count : this->retiring_;
+			this->retiring_ -= keep;
+			this->size_ += keep;
+			this->start(count - keep);
+		}
+		else if (size < this->size_){
+			this->retiring_ += this->size_ - size;
+			this->size_ = size;
+		}
+
+		retired = this->takeRetired();
+	}
+	this->wait_.notify_all();
+
+	for (size_t i = 0; i < retired.size(); i++){
+		retired[i].join();
+	}
+}
+
+void ThreadPool::setLimit(Priority priority, size_t limit){
+	LOGGER_FN();
+
+	if (priority < High || priority > Low){
+		THROW_EXCEPTION(0, ThreadPool, NULL, "Unknown priority %d", (int)priority);
+	}
+
+	std::lock_guard<std::mutex> lock(this->lock_);
+	this->limits_[priority] = limit;
+}
+
+size_t ThreadPool::size(){
+	std::lock_guard<std::mutex> lock(this->lock_);
+	return this->size_;
+}
+
+size_t ThreadPool::pending(){
+	std::lock_guard<std::mutex> lock(this->lock_);
+	size_t res = 0;
+	for (size_t i = 0; i < THREAD_POOL_PRIORITIES; i++){
+		res += this->tasks_[i].size();
+	}
+	return res;
+}
+
+size_t ThreadPool::idle(){
+	std::lock_guard<std::mutex> lock(this->lock_);
+	size_t busy = this->running_;
+	for (size_t i = 0; i < THREAD_POOL_PRIORITIES; i++){
+		busy += this->tasks_[i].size();
+	}
+	return this->size_ > busy ? this->size_ - busy : 0;
+}
+
+ThreadPool::Stats ThreadPool::stats(){
+	std::lock_guard<std::mutex> lock(this->lock_);
+
+	Stats res;
+	res.size = this->size_;
+	res.running = this->running_;
+	for (size_t i = 0; i < THREAD_POOL_PRIORITIES; i++){
+		res.pending[i] = this->tasks_[i].size();
+		res.limits[i] = this->limits_[i];
+	}
+	res.completed = this->completed_;
+	res.rejected = this->rejected_;
+	res.removed = this->removed_;
+	return res;
+}
+
+size_t ThreadPool::defaultSize(){
+	size_t res = std::thread::hardware_concurrency();
+	return res < 2 ? 2 : res;
+}
+
+void ThreadPool::setShared(ThreadPool *pool){
+	sharedPool = pool;
+}
+
+ThreadPool *ThreadPool::shared(){
+	return sharedPool;
+}
+
+ThreadPool::CancelFlag ThreadPool::newCancelFlag(){
+	return CancelFlag(new std::atomic<bool>(false));
+}
+
+bool ThreadPool::cancelled(){
+	return threadCancel && threadCancel->load(std::memory_order_relaxed);
+}
+
+void ThreadPool::checkCancelled(){
+	if (ThreadPool::cancelled()){
+		THROW_EXCEPTION(0, ThreadPool, NULL, "Operation cancelled");
+	}
+}
+
+void ThreadPool::run(){
+	for (;;){
+		Item item;
+		{
+			std::unique_lock<std::mutex> lock(this->lock_);
+			size_t priority;
+			for (;;){
+				for (priority = 0; priority < THREAD_POOL_PRIORITIES && this->tasks_[priority].empty(); priority++);
+				if (this->stopping_ || this->retiring_ || priority < THREAD_POOL_PRIORITIES){
+					break;
+				}
+				this->wait_.wait(lock);
+			}
+			if (this->retiring_ && !this->stopping_){
+				this->retiring_--;
+				this->retired_.push_back(std::this_thread::get_id());
+				break;
+			}
+			if (priority == THREAD_POOL_PRIORITIES){
+				break;
+			}
+			item = this->tasks_[priority].front();
+			this->tasks_[priority].pop_front();
+			this->running_++;
+		}
+
+		threadCancel = item.cancel.get();
+		try{
+			item.task();
+		}
+		catch (...){
+			LOGGER_ERROR("Unhandled exception in thread pool task");
+		}
+		threadCancel = NULL;
+
+		std::lock_guard<std::mutex> lock(this->lock_);
+		this->running_--;
+		this->completed_++;
+	}
+
+	OpenSSL::threadCleanup();
+}
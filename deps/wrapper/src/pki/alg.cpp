@@ -2,7 +2,7 @@
 #include "wrapper/pki/alg.h"
 
 Algorithm::Algorithm(const char* alg_name)
-	:SSLObject<X509_ALGOR>(X509_ALGOR_new(), &so_X509_ALGOR_free){
+	:SSLObject<X509_ALGOR>(X509_ALGOR_new()){
 	LOGGER_FN();
 	try{
 		init(alg_name);
@@ -14,7 +14,7 @@ Algorithm::Algorithm(const char* alg_name)
 }
 
 Algorithm::Algorithm(Handle<OID> alg_oid)
-	:SSLObject<X509_ALGOR>(X509_ALGOR_new(), &so_X509_ALGOR_free){
+	:SSLObject<X509_ALGOR>(X509_ALGOR_new()){
 	LOGGER_FN();
 
 	if (alg_oid.isEmpty())
@@ -3,7 +3,7 @@
 #include "wrapper/pki/attr.h"
 
 Attribute::Attribute(Handle<OID> oid, int asnType)
-	:SSLObject<X509_ATTRIBUTE>(X509_ATTRIBUTE_new(), &so_X509_ATTRIBUTE_free)
+	:SSLObject<X509_ATTRIBUTE>(X509_ATTRIBUTE_new())
 {
 	LOGGER_FN();
 
@@ -16,7 +16,7 @@ Attribute::Attribute(Handle<OID> oid, int asnType)
 }
 
 Attribute::Attribute(const std::string& oid, int asnType)
-	:SSLObject<X509_ATTRIBUTE>(X509_ATTRIBUTE_new(), &so_X509_ATTRIBUTE_free)
+	:SSLObject<X509_ATTRIBUTE>(X509_ATTRIBUTE_new())
 {
 	LOGGER_FN();
 
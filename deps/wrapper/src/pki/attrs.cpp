@@ -3,7 +3,7 @@
 #include "wrapper/pki/attrs.h"
 
 AttributeCollection::AttributeCollection(stack_st_X509_ATTRIBUTE **data, Handle<SObject> parent)
-	:SSLObject<stack_st_X509_ATTRIBUTE>(sk_X509_ATTRIBUTE_new_null(), &so_stack_st_X509_ATTRIBUTE_free, parent)
+	:SSLObject<stack_st_X509_ATTRIBUTE>(sk_X509_ATTRIBUTE_new_null(), parent)
 {
 	LOGGER_FN();
 
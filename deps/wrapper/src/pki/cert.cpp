@@ -2,7 +2,7 @@
 
 #include "wrapper/pki/cert.h"
 
-Certificate::Certificate(Handle<CertificationRequest> csr) :SSLObject<X509>(X509_new(), &so_X509_free){
+Certificate::Certificate(Handle<CertificationRequest> csr) :SSLObject<X509>(X509_new()){
 	LOGGER_FN();
 
 	try{
@@ -158,7 +158,7 @@ Handle<Certificate> Certificate::duplicate(){
 	return new Certificate(cert);
 }
 
-void Certificate::sign(Handle<Key> key, const char* digest){
+void Certificate::sign(const Handle<Key> &key, const char* digest){
 	LOGGER_FN();
 
 	try{
@@ -310,7 +310,7 @@ Handle<std::string> Certificate::getSubjectName()
 	LOGGER_OPENSSL(X509_NAME_oneline_ex);
 	std::string str_name = X509_NAME_oneline_ex(name);
 
-	Handle<std::string> res = new std::string(str_name.c_str(), str_name.length());
+	Handle<std::string> res = new std::string(std::move(str_name));
 
 	return res;
 }
@@ -327,7 +327,7 @@ Handle<std::string> Certificate::getIssuerName()
 	LOGGER_OPENSSL(X509_NAME_oneline_ex);
 	std::string str_name = X509_NAME_oneline_ex(name);
 
-	Handle<std::string> res = new std::string(str_name.c_str(), str_name.length());
+	Handle<std::string> res = new std::string(std::move(str_name));
 
 	return res;
 }
@@ -470,7 +470,7 @@ Handle<std::string> Certificate::getOrganizationName(){
 	return organizationName;
 }
 
-int Certificate::compare(Handle<Certificate> cert){
+int Certificate::compare(const Handle<Certificate> &cert){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_cmp);
@@ -604,7 +604,7 @@ Handle<ExtensionCollection> Certificate::getExtensions() {
 	return new ExtensionCollection(exts);
 }
 
-void Certificate::setSubject(Handle<std::string> xName) {
+void Certificate::setSubject(const Handle<std::string> &xName) {
 	LOGGER_FN();
 
 	try{
@@ -657,7 +657,7 @@ void Certificate::setSubject(Handle<std::string> xName) {
 	}
 }
 
-void Certificate::setIssuer(Handle<std::string> xName) {
+void Certificate::setIssuer(const Handle<std::string> &xName) {
 	LOGGER_FN();
 
 	try{
@@ -733,7 +733,7 @@ void Certificate::setNotAfter(long offset_sec){
 	X509_gmtime_adj(X509_get_notAfter(this->internal()), offset_sec);
 }
 
-void Certificate::setExtensions(Handle<ExtensionCollection> exts) {
+void Certificate::setExtensions(const Handle<ExtensionCollection> &exts) {
 	LOGGER_FN();
 
 	try {
@@ -779,7 +779,7 @@ void Certificate::setExtensions(Handle<ExtensionCollection> exts) {
 	}
 }
 
-void Certificate::setSerialNumber(Handle<std::string> serial){
+void Certificate::setSerialNumber(const Handle<std::string> &serial){
 	LOGGER_FN();
 
 	ASN1_INTEGER *sno = NULL;
@@ -825,7 +825,7 @@ void Certificate::setSerialNumber(Handle<std::string> serial){
 	return;
 }
 
-bool Certificate::equals(Handle<Certificate> cert){
+bool Certificate::equals(const Handle<Certificate> &cert){
 	LOGGER_FN();
 
 	Handle<std::string> cert1 = this->getThumbprint();
@@ -857,7 +857,7 @@ bool Certificate::isCA() {
 	return (X509_check_ca(this->internal()) > 0);
 }
 
-Handle<std::string> Certificate::hash(Handle<std::string> algorithm){
+Handle<std::string> Certificate::hash(const Handle<std::string> &algorithm){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(EVP_get_digestbyname);
@@ -3,7 +3,7 @@
 #include "wrapper/pki/cert_request.h"
 #include "wrapper/pki/key.h"
 
-CertificationRequest::CertificationRequest(Handle<CertificationRequestInfo> csrinfo) :SSLObject<X509_REQ>(X509_REQ_new(), &so_X509_REQ_free){
+CertificationRequest::CertificationRequest(Handle<CertificationRequestInfo> csrinfo) :SSLObject<X509_REQ>(X509_REQ_new()){
 	LOGGER_FN();
 
 	try{
@@ -1,6 +1,8 @@
 #include "../stdafx.h"
 
 #include "wrapper/pki/cipher.h"
+#include "wrapper/common/thread_pool.h"
+#include "wrapper/cms/enveloped_reader.h"
 
 Cipher::Cipher(){
 	LOGGER_FN();
@@ -24,12 +26,165 @@ Cipher::Cipher(){
 		if (RAND_pseudo_bytes(salt, sizeof salt) < 0){
 			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Invalid generate pseudo rand");
 		}
+
+		/*Password KDF and salt of AEAD data*/
+		Aead::initKdf(kdf, Aead::KDF_PBKDF2_SHA256, 0);
 	}
 	catch (Handle<Exception> &e){
 		THROW_EXCEPTION(0, Cipher, e, "Error init cipher");
 	}
 }
 
+/*
+* cms is not freed: RecipientInfos returned by getRecipientInfos point
+* into it.
+*/
+Cipher::~Cipher(){
+	LOGGER_FN();
+
+	if (benc){
+		LOGGER_OPENSSL(BIO_free_all);
+		BIO_free_all(benc);
+	}
+	if (encerts){
+		LOGGER_OPENSSL(sk_X509_free);
+		sk_X509_free(encerts);
+	}
+
+	OPENSSL_cleanse(key, sizeof key);
+	OPENSSL_cleanse(iv, sizeof iv);
+	OPENSSL_cleanse(bencKey, sizeof bencKey);
+	replace(hpass, NULL);
+	replace(hkey, NULL);
+	replace(hiv, NULL);
+	replace(hsalt, NULL);
+	replace(hmd, NULL);
+}
+
+/*Secret strings are cleansed before free*/
+void Cipher::replace(char *&field, const char *value){
+	if (field){
+		OPENSSL_cleanse(field, strlen(field));
+		free(field);
+	}
+	field = value ? strdup(value) : NULL;
+}
+
+/*
+* Prepare 'benc' for the next message. Cipher BIO and its context are
+* reused; when cipher, key and direction are the same as of the previous
+* call only the iv is set, so the key schedule is not expanded again.
+*/
+void Cipher::initCipherBio(int enc){
+	LOGGER_FN();
+
+	if (benc == NULL){
+		LOGGER_OPENSSL(BIO_new);
+		if ((benc = BIO_new(BIO_f_cipher())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_new(BIO_f_cipher())");
+		}
+		bencCipher = NULL;
+	}
+	else{
+		/*
+		* Detached cipher BIO returns the reset result of its NULL next BIO
+		* (0 or -1 even on success), so it is reset on top of a null sink
+		*/
+		BIO *sink = NULL;
+		LOGGER_OPENSSL(BIO_new);
+		if ((sink = BIO_new(BIO_s_null())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_new(BIO_s_null())");
+		}
+		BIO_push(benc, sink);
+		LOGGER_OPENSSL(BIO_reset);
+		int res = BIO_reset(benc);
+		BIO_pop(benc);
+		BIO_free(sink);
+		if (res != 1){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_reset");
+		}
+	}
+
+	/*Save internal BIO cipher context to 'ctx'*/
+	LOGGER_OPENSSL(BIO_get_cipher_ctx);
+	BIO_get_cipher_ctx(benc, &ctx);
+
+	int keyLen = EVP_CIPHER_key_length(cipher);
+	bool keyed = bencCipher == cipher && bencEnc == enc
+		&& !memcmp(bencKey, key, keyLen);
+
+	LOGGER_OPENSSL(EVP_CipherInit_ex);
+	if (!EVP_CipherInit_ex(ctx, keyed ? NULL : cipher, NULL, keyed ? NULL : key, iv, enc)) {
+		bencCipher = NULL;
+		THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error setting cipher");
+	}
+
+	bencCipher = cipher;
+	bencEnc = enc;
+	memcpy(bencKey, key, keyLen);
+}
+
+/*Detach 'benc' from the output. After error it is freed with its state*/
+void Cipher::releaseCipherBio(bool error){
+	LOGGER_FN();
+
+	if (benc == NULL){
+		return;
+	}
+
+	LOGGER_OPENSSL(BIO_pop);
+	BIO_pop(benc);
+
+	if (error){
+		LOGGER_OPENSSL(BIO_free);
+		BIO_free(benc);
+		benc = NULL;
+		ctx = NULL;
+		bencCipher = NULL;
+	}
+}
+
+/*
+* Write all data of in to out. Memory mapped input is written straight
+* from the mapping; other BIOs are read by bsize blocks through buff.
+* Cancellation of the pool task is checked before every chunk.
+*/
+void Cipher::transfer(BIO *in, BIO *out, unsigned char *buff){
+	LOGGER_FN();
+
+	const unsigned char *data = NULL;
+	size_t length = 0;
+	if (BIO_mmap_get_data(in, &data, &length)){
+		size_t offset = 0;
+		while (offset < length){
+			ThreadPool::checkCancelled();
+			int inl = (int)(length - offset < CIPHER_MMAP_CHUNK ? length - offset : CIPHER_MMAP_CHUNK);
+			LOGGER_OPENSSL(BIO_write);
+			if (BIO_write(out, (const char *)data + offset, inl) != inl) {
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+			}
+			offset += inl;
+		}
+		if (!BIO_mmap_skip(in, length)){
+			THROW_EXCEPTION(0, Cipher, NULL, "Error skipping input bio");
+		}
+		return;
+	}
+
+	for (;;) {
+		ThreadPool::checkCancelled();
+		LOGGER_OPENSSL(BIO_read);
+		int inl = BIO_read(in, (char *)buff, bsize);
+		if (inl <= 0){
+			break;
+		}
+		LOGGER_OPENSSL(BIO_write);
+		if (BIO_write(out, (char *)buff, inl) != inl) {
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+		}
+	}
+}
+
 void Cipher::setCryptoMethod(CryptoMethod::Crypto_Method method){
 	LOGGER_FN();
 
@@ -60,8 +215,12 @@ void Cipher::addRecipientsCerts(Handle<CertificateCollection> certs){
 		}
 
 		for (int i = 0, c = certs->length(); i < c; i++){
+			Handle<Certificate> cert = certs->items(i);
 			LOGGER_OPENSSL(sk_X509_push);
-			sk_X509_push(encerts, (certs->items(i))->internal());
+			if (!sk_X509_push(encerts, cert->internal())){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "sk_X509_push");
+			}
+			hencerts.push_back(cert);
 		}
 	}
 	catch (Handle<Exception> &e){
@@ -76,6 +235,7 @@ void Cipher::setPrivKey(Handle<Key> privkey){
 	if (!rkey){
 		THROW_EXCEPTION(0, Cipher, NULL, "Private key undefined");
 	}
+	hrkey = privkey;
 }
 
 void Cipher::setRecipientCert(Handle<Certificate> cert){
@@ -85,6 +245,7 @@ void Cipher::setRecipientCert(Handle<Certificate> cert){
 	if (!rcert){
 		THROW_EXCEPTION(0, Cipher, NULL, "Recipient certificate undefined");
 	}
+	hrcert = cert;
 }
 
 void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_FORMAT format){
@@ -107,35 +268,38 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 					THROW_EXCEPTION(0, Cipher, NULL, "key  undefined");
 				}
 
-				/*Check IV*/
-				if (hiv == NULL){
+				/*Check IV. Nonce of AEAD is random*/
+				if (hiv == NULL && aead == Aead::NONE){
 					THROW_EXCEPTION(0, Cipher, NULL, "iv undefined");
 				}
 			}
 
-			if ((buff = (unsigned char *)OPENSSL_malloc(EVP_ENCODE_LENGTH(bsize))) == NULL){
-				THROW_EXCEPTION(0, Cipher, NULL, "OPENSSL_malloc failure");
+			if (segmentSize && aead == Aead::NONE){
+				THROW_EXCEPTION(0, Cipher, NULL, "Segmented format requires AEAD");
 			}
 
-			/*
-			* We use 'benc' how cipher BIO method.
-			* This is a filter BIO that encrypts any data written through it
-			*/
-			LOGGER_OPENSSL(BIO_new);
-			if ((benc = BIO_new(BIO_f_cipher())) == NULL){
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_new(BIO_f_cipher())");
+			/*Legacy format has no place for KDF parameters*/
+			if (hkdf && hpass && aead == Aead::NONE){
+				THROW_EXCEPTION(0, Cipher, NULL, "KDF requires AEAD");
 			}
 
-			/*Save internal BIO cipher context to 'ctx'*/
-			LOGGER_OPENSSL(BIO_get_cipher_ctx);
-			BIO_get_cipher_ctx(benc, &ctx);
+			if (segmentSize){
+				AeadSegments::encrypt(aead, hpass, &kdf, key, inSource->internal(), outEnc->internal(), segmentSize, threads);
+				break;
+			}
 
-			/*Use param '1' for encrypt*/
-			LOGGER_OPENSSL(EVP_CipherInit_ex);
-			if (!EVP_CipherInit_ex(ctx, cipher, NULL, key, iv, 1)) {
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error setting cipher");
+			if (aead != Aead::NONE){
+				Aead::encrypt(aead, hpass, &kdf, key, inSource->internal(), outEnc->internal(), bsize);
+				break;
 			}
 
+			/*
+			* We use 'benc' how cipher BIO method.
+			* This is a filter BIO that encrypts any data written through it.
+			* Use param '1' for encrypt
+			*/
+			initCipherBio(1);
+
 			wbio = outEnc->internal();
 
 			/*
@@ -155,17 +319,10 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 				wbio = BIO_push(benc, wbio);
 			}
 
-			/*Write data to bio (cipher BIO method)*/
-			for (;;) {
-				LOGGER_OPENSSL(BIO_read);
-				inl = BIO_read(inSource->internal(), (char *)buff, bsize);
-				if (inl <= 0){
-					break;
-				}
-				LOGGER_OPENSSL(BIO_write);
-				if (BIO_write(wbio, (char *)buff, inl) != inl) {
-					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
-				}
+			{
+				/*Write data to bio (cipher BIO method)*/
+				PooledBuffer buff(bsize);
+				transfer(inSource->internal(), wbio, buff.data());
 			}
 
 			LOGGER_OPENSSL(BIO_flush);
@@ -173,6 +330,8 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 				THROW_EXCEPTION(0, Cipher, NULL, "bad decrypt");
 			}
 
+			releaseCipherBio(false);
+
 			break;
 
 		//****************************************************************************************
@@ -245,6 +404,7 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 		
 	}
 	catch (Handle<Exception> &e){
+		releaseCipherBio(true);
 		THROW_EXCEPTION(0, Cipher, e, "Error encrypt");
 	}	
 }
@@ -266,14 +426,15 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 					THROW_EXCEPTION(0, Cipher, NULL, "key  undefined");
 				}
 
-				/*Check IV*/
-				if (hiv == NULL){
+				/*Check IV. Nonce of AEAD is read from the header*/
+				if (hiv == NULL && aead == Aead::NONE){
 					THROW_EXCEPTION(0, Cipher, NULL, "iv undefined");
 				}
 			}
 
-			if ((buff = (unsigned char *)OPENSSL_malloc(EVP_ENCODE_LENGTH(bsize))) == NULL){
-				THROW_EXCEPTION(0, Cipher, NULL, "OPENSSL_malloc failure");
+			if (aead != Aead::NONE){
+				Aead::decrypt(hpass, key, inEnc->internal(), outDec->internal(), bsize, threads);
+				break;
 			}
 
 			rbio = inEnc->internal();
@@ -295,36 +456,18 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 				}
 			}
 
-			LOGGER_OPENSSL(BIO_new);
-			if ((benc = BIO_new(BIO_f_cipher())) == NULL){
-				THROW_EXCEPTION(0, Cipher, NULL, "BIO_new(BIO_f_cipher())");
-			}
-
-			LOGGER_OPENSSL(BIO_get_cipher_ctx);
-			BIO_get_cipher_ctx(benc, &ctx);
-
 			/*Use param '0' for decrypt*/
-			LOGGER_OPENSSL(EVP_CipherInit_ex);
-			if (!EVP_CipherInit_ex(ctx, cipher, NULL, key, iv, 0)) {
-				THROW_EXCEPTION(0, Cipher, NULL, "Error setting cipher");
-			}
+			initCipherBio(0);
 
 			if (benc != NULL){
 				LOGGER_OPENSSL(BIO_push);
 				wbio = BIO_push(benc, wbio);
 			}
 
-			/*Write data to bio (cipher BIO method)*/
-			for (;;) {
-				LOGGER_OPENSSL(BIO_read);
-				inl = BIO_read(rbio, (char *)buff, bsize);
-				if (inl <= 0){
-					break;
-				}
-				LOGGER_OPENSSL(BIO_write);
-				if (BIO_write(wbio, (char *)buff, inl) != inl) {
-					THROW_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
-				}
+			{
+				/*Write data to bio (cipher BIO method)*/
+				PooledBuffer buff(bsize);
+				transfer(rbio, wbio, buff.data());
 			}
 
 			LOGGER_OPENSSL(BIO_flush);
@@ -332,6 +475,8 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 				THROW_EXCEPTION(0, Cipher, NULL, "bad decrypt");
 			}
 
+			releaseCipherBio(false);
+
 			break;
 
 		//***************************************************************************************
@@ -342,78 +487,258 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 				THROW_EXCEPTION(0, Cipher, NULL, "Recipient cert or key undefined");
 			}
 
-			/* Parse message */
-			switch (format){
-			case DataFormat::DER:
-				LOGGER_OPENSSL(d2i_CMS_bio);
-				if ((cms = d2i_CMS_bio(inEnc->internal(), NULL)) == NULL) {
-					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "d2i_CMS_bio");
-				}
-				break;
+			/* RecipientInfos are parsed first, then encrypted content is streamed to outDec */
+			{
+				EnvelopedDataReader reader(inEnc->internal(), format);
+				cms = reader.readHeader();
+				reader.decrypt(cms, rkey, rcert, outDec->internal(), bsize);
+			}
 
-			case DataFormat::BASE64:
-				LOGGER_OPENSSL(PEM_read_bio_CMS);
-				if ((cms = PEM_read_bio_CMS(inEnc->internal(), NULL, NULL, NULL)) == NULL) {
-					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "PEM_read_bio_CMS");
-				}
-				break;
+			break;
+		default:
+			THROW_EXCEPTION(0, Cipher, NULL, "Unknown crypto method");
+		}
 
-			default:
-				THROW_EXCEPTION(0, Cipher, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
-			}
+		
+	}
+	catch (Handle<Exception> &e){
+		releaseCipherBio(true);
+		THROW_EXCEPTION(0, Cipher, e, "Error decrypt");
+	}
+}
 
-			LOGGER_OPENSSL(CMS_decrypt_set1_pkey);
-			if (!CMS_decrypt_set1_pkey(cms, rkey, rcert)) {
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "CMS_decrypt_set1_pkey 'Error set private key'");
-			}
+void Cipher::decryptRange(Handle<Bio> inEnc, Handle<Bio> outDec, unsigned long long offset, unsigned long long length){
+	LOGGER_FN();
+
+	try{
+		if (hmethod != CryptoMethod::SYMMETRIC){
+			THROW_EXCEPTION(0, Cipher, NULL, "Range is supported for symmetric method only");
+		}
+
+		if (hpass == NULL && hkey == NULL){
+			THROW_EXCEPTION(0, Cipher, NULL, "key  undefined");
+		}
+
+		AeadSegments::decryptRange(hpass, key, inEnc->internal(), outDec->internal(), offset, length, threads);
+	}
+	catch (Handle<Exception> &e){
+		THROW_EXCEPTION(0, Cipher, e, "Error decrypt range");
+	}
+}
+
+Handle<CipherStream> Cipher::createStream(bool encrypt){
+	LOGGER_FN();
+
+	try{
+		if (hmethod != CryptoMethod::SYMMETRIC){
+			THROW_EXCEPTION(0, Cipher, NULL, "Stream is supported for symmetric method only");
+		}
+
+		if (aead != Aead::NONE){
+			THROW_EXCEPTION(0, Cipher, NULL, "Stream is not supported for AEAD");
+		}
 
-			LOGGER_OPENSSL(CMS_decrypt);
-			if (!CMS_decrypt(cms, NULL, NULL, NULL, outDec->internal(), flags)) {
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "CMS_decrypt 'Error decrypt cms'");
+		if (hpass == NULL){
+			if (hkey == NULL){
+				THROW_EXCEPTION(0, Cipher, NULL, "key  undefined");
 			}
 
-			LOGGER_OPENSSL(BIO_flush);
-			if (!BIO_flush(outDec->internal())){
-				THROW_EXCEPTION(0, Cipher, NULL, "bad decrypt");
+			if (hiv == NULL){
+				THROW_EXCEPTION(0, Cipher, NULL, "iv undefined");
 			}
+		}
 
-			break;
-		default:
-			THROW_EXCEPTION(0, Cipher, NULL, "Unknown crypto method");
+		return new CipherStream(*this, encrypt);
+	}
+	catch (Handle<Exception> &e){
+		THROW_EXCEPTION(0, Cipher, e, "Error create cipher stream");
+	}
+}
+
+Handle<CipherSession> Cipher::createSession(){
+	LOGGER_FN();
+
+	try{
+		if (hmethod != CryptoMethod::SYMMETRIC){
+			THROW_EXCEPTION(0, Cipher, NULL, "Session is supported for symmetric method only");
 		}
 
-		
+		/*Password key depends on salt which is not in the messages*/
+		if (hkey == NULL){
+			THROW_EXCEPTION(0, Cipher, NULL, "key  undefined");
+		}
+
+		return new CipherSession(cipher, aead, key);
 	}
 	catch (Handle<Exception> &e){
-		THROW_EXCEPTION(0, Cipher, e, "Error decrypt");
+		THROW_EXCEPTION(0, Cipher, e, "Error create cipher session");
 	}
 }
 
-Handle<CmsRecipientInfoCollection> Cipher::getRecipientInfos(Handle<Bio> inEnc, DataFormat::DATA_FORMAT format) {
+CipherStream::CipherStream(const Cipher &params, bool encrypt)
+	: cipher(params.cipher), dgst(params.dgst), encrypt(encrypt),
+	bsize(params.bsize), buff(params.bsize + EVP_MAX_BLOCK_LENGTH)
+{
 	LOGGER_FN();
 
-	try {
-		STACK_OF(CMS_RecipientInfo) *ris = NULL;
+	if (params.hpass){
+		this->pass = params.hpass;
+	}
+	memcpy(this->key, params.key, sizeof this->key);
+	memcpy(this->iv, params.iv, sizeof this->iv);
+
+	/*Salt of encryption is known, it is written before the first data*/
+	if (encrypt && params.hpass){
+		memcpy(this->header, magic, sizeof magic - 1);
+		memcpy(this->header + sizeof magic - 1, params.salt, PKCS5_SALT_LEN);
+	}
+
+	LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+	if ((this->ctx = EVP_CIPHER_CTX_new()) == NULL){
+		THROW_OPENSSL_EXCEPTION(0, CipherStream, NULL, "EVP_CIPHER_CTX_new");
+	}
+
+	if (encrypt || this->pass.empty()){
+		try{
+			this->init();
+		}
+		catch (Handle<Exception> &e){
+			EVP_CIPHER_CTX_free(this->ctx);
+			throw;
+		}
+	}
+}
+
+CipherStream::~CipherStream(){
+	LOGGER_FN();
+
+	if (this->ctx){
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_free);
+		EVP_CIPHER_CTX_free(this->ctx);
+	}
+	OPENSSL_cleanse(this->key, sizeof this->key);
+	OPENSSL_cleanse(this->iv, sizeof this->iv);
+	if (!this->pass.empty()){
+		OPENSSL_cleanse(&this->pass[0], this->pass.length());
+	}
+}
+
+void CipherStream::init(){
+	LOGGER_FN();
+
+	LOGGER_OPENSSL(EVP_CipherInit_ex);
+	if (!EVP_CipherInit_ex(this->ctx, this->cipher, NULL, this->key, this->iv, this->encrypt ? 1 : 0)) {
+		THROW_OPENSSL_EXCEPTION(0, CipherStream, NULL, "Error setting cipher");
+	}
+}
+
+void CipherStream::write(Handle<Bio> out, const unsigned char *data, int len){
+	if (len <= 0){
+		return;
+	}
+
+	LOGGER_OPENSSL(BIO_write);
+	if (BIO_write(out->internal(), (const char *)data, len) != len) {
+		THROW_OPENSSL_EXCEPTION(0, CipherStream, NULL, "Error writing output bio");
+	}
+}
+
+void CipherStream::update(const unsigned char *in, size_t inl, Handle<Bio> out){
+	LOGGER_FN();
 
-		/* Parse message */
-		switch (format){
-		case DataFormat::DER:
-			LOGGER_OPENSSL(d2i_CMS_bio);
-			if ((cms = d2i_CMS_bio(inEnc->internal(), NULL)) == NULL) {
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "d2i_CMS_bio");
+	if (this->finished){
+		THROW_EXCEPTION(0, CipherStream, NULL, "Stream is finished");
+	}
+
+	if (!this->started){
+		if (this->encrypt){
+			if (!this->pass.empty()){
+				this->write(out, this->header, sizeof this->header);
+			}
+		}
+		else if (!this->pass.empty()){
+			/*Collect "Salted__" and salt, they may come by several chunks*/
+			size_t len = sizeof this->header - this->headerLen;
+			if (len > inl){
+				len = inl;
+			}
+			if (len){
+				memcpy(this->header + this->headerLen, in, len);
+				this->headerLen += len;
+				in += len;
+				inl -= len;
 			}
-			break;
 
-		case DataFormat::BASE64:
-			LOGGER_OPENSSL(PEM_read_bio_CMS);
-			if ((cms = PEM_read_bio_CMS(inEnc->internal(), NULL, NULL, NULL)) == NULL) {
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "PEM_read_bio_CMS");
+			if (this->headerLen < sizeof this->header){
+				return;
 			}
-			break;
 
-		default:
-			THROW_EXCEPTION(0, Cipher, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+			if (memcmp(this->header, magic, sizeof magic - 1)) {
+				THROW_EXCEPTION(0, CipherStream, NULL, "bad magic number");
+			}
+
+			LOGGER_OPENSSL(EVP_BytesToKey);
+			if (EVP_BytesToKey(this->cipher, this->dgst, this->header + sizeof magic - 1,
+				(const unsigned char *)this->pass.c_str(), this->pass.length(), 1, this->key, this->iv) == 0){
+				THROW_OPENSSL_EXCEPTION(0, CipherStream, NULL, "EVP_BytesToKey");
+			}
+
+			this->init();
 		}
+		this->started = true;
+	}
+
+	while (inl){
+		int len = inl < (size_t)this->bsize ? (int)inl : this->bsize;
+		int outl = 0;
+
+		LOGGER_OPENSSL(EVP_CipherUpdate);
+		if (!EVP_CipherUpdate(this->ctx, this->buff.data(), &outl, in, len)){
+			THROW_OPENSSL_EXCEPTION(0, CipherStream, NULL, "EVP_CipherUpdate");
+		}
+		this->write(out, this->buff.data(), outl);
+
+		in += len;
+		inl -= len;
+	}
+}
+
+void CipherStream::final(Handle<Bio> out){
+	LOGGER_FN();
+
+	if (this->finished){
+		THROW_EXCEPTION(0, CipherStream, NULL, "Stream is finished");
+	}
+
+	/*Writes the header of empty encrypted data*/
+	this->update(NULL, 0, out);
+	if (!this->started){
+		THROW_EXCEPTION(0, CipherStream, NULL, "error reading input file");
+	}
+
+	int outl = 0;
+	LOGGER_OPENSSL(EVP_CipherFinal_ex);
+	if (!EVP_CipherFinal_ex(this->ctx, this->buff.data(), &outl)){
+		THROW_OPENSSL_EXCEPTION(0, CipherStream, NULL, "bad decrypt");
+	}
+	this->write(out, this->buff.data(), outl);
+
+	this->finished = true;
+}
+
+bool CipherStream::isFinished(){
+	return this->finished;
+}
+
+Handle<CmsRecipientInfoCollection> Cipher::getRecipientInfos(Handle<Bio> inEnc, DataFormat::DATA_FORMAT format) {
+	LOGGER_FN();
+
+	try {
+		STACK_OF(CMS_RecipientInfo) *ris = NULL;
+
+		/* Encrypted content is not read */
+		EnvelopedDataReader reader(inEnc->internal(), format);
+		cms = reader.readHeader();
 
 		LOGGER_OPENSSL(CMS_get0_RecipientInfos);
 		ris = CMS_get0_RecipientInfos(cms);
@@ -452,7 +777,7 @@ void Cipher::setPass(Handle<std::string> password){
 		THROW_EXCEPTION(0, Cipher, NULL, "Password cannot be empty");
 	}
 	else{
-		hpass = strdup(password->c_str());
+		replace(hpass, password->c_str());
 	}
 
 	LOGGER_OPENSSL(EVP_BytesToKey);
@@ -466,7 +791,7 @@ void Cipher::setSalt(Handle<std::string> saltP){
 
 	try{
 		if (saltP->length() <= 16) {
-			hsalt = strdup(saltP->c_str());
+			replace(hsalt, saltP->c_str());
 		}
 		else{
 			THROW_EXCEPTION(0, Cipher, NULL, "Salt must be no more 16 characters");
@@ -490,7 +815,7 @@ void Cipher::setIV(Handle<std::string> ivP){
 	LOGGER_FN();
 
 	try{
-		hiv = strdup(ivP->c_str());
+		replace(hiv, ivP->c_str());
 
 		if (hiv != NULL){
 			LOGGER_OPENSSL(EVP_CIPHER_iv_length);
@@ -515,7 +840,7 @@ void Cipher::setKey(Handle<std::string> keyP){
 	LOGGER_FN();
 
 	try{
-		hkey = strdup(keyP->c_str());
+		replace(hkey, keyP->c_str());
 
 		if (hkey == NULL) {
 			THROW_EXCEPTION(0, Cipher, NULL, "key undefined");
@@ -598,6 +923,86 @@ Handle<std::string> Cipher::getKey(){
 	}
 }
 
+void Cipher::setAead(Handle<std::string> name){
+	LOGGER_FN();
+
+	try{
+		Aead::Algorithm algorithm = Aead::getAlgorithm(*name);
+
+		if (algorithm == Aead::NONE){
+			LOGGER_OPENSSL(EVP_get_cipherbyname);
+			cipher = EVP_get_cipherbyname(SN_des_ede3_cbc);
+			if (cipher == NULL) {
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error get cipher by name");
+			}
+		}
+		else{
+			cipher = Aead::getCipher(algorithm);
+		}
+
+		aead = algorithm;
+	}
+	catch (Handle<Exception> &e){
+		THROW_EXCEPTION(0, Cipher, e, "Error set AEAD");
+	}
+}
+
+void Cipher::setSegmentSize(unsigned int size){
+	LOGGER_FN();
+
+	if (size > AEAD_MAX_SEGMENT_SIZE){
+		THROW_EXCEPTION(0, Cipher, NULL, "Segment size must be no more %d bytes", AEAD_MAX_SEGMENT_SIZE);
+	}
+
+	segmentSize = size;
+}
+
+void Cipher::setThreads(size_t count){
+	LOGGER_FN();
+
+	threads = count;
+}
+
+void Cipher::setBufferSize(int size){
+	LOGGER_FN();
+
+	if (size < SIZE || size > BUFFER_POOL_MAX_SIZE){
+		THROW_EXCEPTION(0, Cipher, NULL, "Buffer size must be from %d to %d bytes", SIZE, BUFFER_POOL_MAX_SIZE);
+	}
+
+	bsize = size;
+}
+
+void Cipher::setKdf(Handle<std::string> name, unsigned int cost){
+	LOGGER_FN();
+
+	try{
+		Aead::initKdf(kdf, Aead::getKdf(*name), cost);
+		hkdf = true;
+	}
+	catch (Handle<Exception> &e){
+		THROW_EXCEPTION(0, Cipher, e, "Error set KDF");
+	}
+}
+
+Handle<std::string> Cipher::getKdf(){
+	LOGGER_FN();
+
+	return new std::string(Aead::getKdfName(kdf.id));
+}
+
+int Cipher::getBufferSize(){
+	LOGGER_FN();
+
+	return bsize;
+}
+
+Handle<std::string> Cipher::getAead(){
+	LOGGER_FN();
+
+	return new std::string(Aead::getName(aead));
+}
+
 Handle<std::string> Cipher::getAlgorithm(){
 	LOGGER_FN();
 	
@@ -627,6 +1032,12 @@ Handle<std::string> Cipher::getMode(){
 		else if (EVP_CIPH_OFB_MODE == EVP_CIPHER_mode(cipher)){
 			temp = "ofb";
 		}
+		else if (EVP_CIPH_GCM_MODE == EVP_CIPHER_mode(cipher)){
+			temp = "gcm";
+		}
+		else if (aead == Aead::CHACHA20_POLY1305){
+			temp = "poly1305";
+		}
 
 		Handle<std::string> res = new std::string(temp);
 
@@ -0,0 +1,615 @@
+#include "../stdafx.h"
+
+#include <openssl/rand.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_AES
+#define HWCAP_AES (1 << 3)
+#endif
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#endif
+
+#include "wrapper/pki/cipher.h"
+#include "wrapper/pki/cipher_aead.h"
+#include "wrapper/pki/cipher_segments.h"
+#include "wrapper/pki/key_cache.h"
+#include "wrapper/common/thread_pool.h"
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305)
+#define AEAD_HAVE_CHACHA
+#endif
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && !defined(OPENSSL_NO_SCRYPT)
+#define AEAD_HAVE_SCRYPT
+#endif
+
+static void readExact(BIO *in, unsigned char *out, int len){
+	LOGGER_OPENSSL(BIO_read);
+	if (BIO_read(in, (char *)out, len) != len){
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "error reading input file");
+	}
+}
+
+static void writeAll(BIO *out, const unsigned char *data, int len){
+	LOGGER_OPENSSL(BIO_write);
+	if (len > 0 && BIO_write(out, (const char *)data, len) != len) {
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "Error writing output bio");
+	}
+}
+
+Aead::Algorithm Aead::getAlgorithm(const std::string &name){
+	LOGGER_FN();
+
+	if (name.empty()){
+		return NONE;
+	}
+	if (name == "auto"){
+		return Aead::preferred();
+	}
+	if (name == "aes-256-gcm"){
+		return AES_256_GCM;
+	}
+	if (name == "chacha20-poly1305"){
+		return CHACHA20_POLY1305;
+	}
+
+	THROW_EXCEPTION(0, Aead, NULL, "Unknown AEAD algorithm '%s'", name.c_str());
+}
+
+const char *Aead::getName(Algorithm algorithm){
+	switch (algorithm){
+	case AES_256_GCM:
+		return "aes-256-gcm";
+	case CHACHA20_POLY1305:
+		return "chacha20-poly1305";
+	default:
+		return "";
+	}
+}
+
+const EVP_CIPHER *Aead::getCipher(Algorithm algorithm){
+	LOGGER_FN();
+
+	switch (algorithm){
+	case AES_256_GCM:
+		LOGGER_OPENSSL(EVP_aes_256_gcm);
+		return EVP_aes_256_gcm();
+	case CHACHA20_POLY1305:
+#ifdef AEAD_HAVE_CHACHA
+		LOGGER_OPENSSL(EVP_chacha20_poly1305);
+		return EVP_chacha20_poly1305();
+#else
+		THROW_EXCEPTION(0, Aead, NULL, "ChaCha20-Poly1305 is not supported by OpenSSL");
+#endif
+	default:
+		THROW_EXCEPTION(0, Aead, NULL, "Unknown AEAD algorithm %d", (int)algorithm);
+	}
+}
+
+/*
+* GCM is fast only with both AES rounds and carry-less multiplication
+* (GHASH) in hardware: AES-NI and PCLMULQDQ on x86, AES and PMULL on ARMv8.
+*/
+bool Aead::hasAesHardware(){
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)){
+		return false;
+	}
+	return (ecx & bit_AES) && (ecx & bit_PCLMUL);
+#elif defined(_M_X64) || defined(_M_IX86)
+	int regs[4];
+	__cpuid(regs, 1);
+	return (regs[2] & (1 << 25)) && (regs[2] & (1 << 1));
+#elif defined(__aarch64__) && defined(__linux__)
+	unsigned long hwcap = getauxval(AT_HWCAP);
+	return (hwcap & HWCAP_AES) && (hwcap & HWCAP_PMULL);
+#elif defined(__aarch64__) && defined(__APPLE__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+Aead::Algorithm Aead::preferred(){
+	static const Algorithm res = Aead::hasAesHardware() ? AES_256_GCM :
+#ifdef AEAD_HAVE_CHACHA
+		CHACHA20_POLY1305;
+#else
+		AES_256_GCM;
+#endif
+	return res;
+}
+
+Aead::Kdf Aead::getKdf(const std::string &name){
+	LOGGER_FN();
+
+	if (name == "pbkdf2" || name == "pbkdf2-sha256"){
+		return KDF_PBKDF2_SHA256;
+	}
+	if (name == "scrypt"){
+		return KDF_SCRYPT;
+	}
+
+	THROW_EXCEPTION(0, Aead, NULL, "Unknown KDF '%s'", name.c_str());
+}
+
+const char *Aead::getKdfName(Kdf kdf){
+	switch (kdf){
+	case KDF_PBKDF2_SHA256:
+		return "pbkdf2";
+	case KDF_SCRYPT:
+		return "scrypt";
+	default:
+		return "";
+	}
+}
+
+void Aead::initKdf(KdfParams &params, Kdf kdf, unsigned int cost){
+	LOGGER_FN();
+
+	params.id = kdf;
+	params.iterations = 0;
+	params.logN = 0;
+	params.r = 0;
+	params.p = 0;
+
+	switch (kdf){
+	case KDF_PBKDF2_SHA256:
+		params.iterations = cost ? cost : AEAD_PBKDF2_ITER;
+		if (params.iterations < AEAD_MIN_PBKDF2_ITER){
+			THROW_EXCEPTION(0, Aead, NULL, "PBKDF2 iterations must be at least %d", AEAD_MIN_PBKDF2_ITER);
+		}
+		break;
+	case KDF_SCRYPT:
+		if (cost && (cost < AEAD_MIN_SCRYPT_LOGN || cost > AEAD_MAX_SCRYPT_LOGN)){
+			THROW_EXCEPTION(0, Aead, NULL, "scrypt log2(N) must be from %d to %d", AEAD_MIN_SCRYPT_LOGN, AEAD_MAX_SCRYPT_LOGN);
+		}
+		params.logN = (unsigned char)(cost ? cost : AEAD_SCRYPT_LOGN);
+		params.r = AEAD_SCRYPT_R;
+		params.p = AEAD_SCRYPT_P;
+		break;
+	default:
+		break;
+	}
+	Aead::checkKdf(params);
+
+	LOGGER_OPENSSL(RAND_bytes);
+	if (RAND_bytes(params.salt, AEAD_SALT_LEN) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "RAND_bytes");
+	}
+}
+
+/* Cost of the header is limited, else a crafted file takes the CPU or memory */
+void Aead::checkKdf(const KdfParams &params){
+	LOGGER_FN();
+
+	switch (params.id){
+	case KDF_NONE:
+		break;
+	case KDF_PBKDF2_SHA256:
+		if (!params.iterations || params.iterations > AEAD_MAX_PBKDF2_ITER){
+			THROW_EXCEPTION(0, Aead, NULL, "Invalid PBKDF2 iterations %u", params.iterations);
+		}
+		break;
+	case KDF_SCRYPT:
+#ifdef AEAD_HAVE_SCRYPT
+		if (!params.logN || params.logN > AEAD_MAX_SCRYPT_LOGN || !params.r || !params.p
+			|| params.p > AEAD_MAX_SCRYPT_P
+			|| 128ULL * params.r << params.logN > AEAD_MAX_SCRYPT_MEM){
+			THROW_EXCEPTION(0, Aead, NULL, "Invalid scrypt parameters N=2^%d r=%d p=%d",
+				(int)params.logN, (int)params.r, (int)params.p);
+		}
+		break;
+#else
+		THROW_EXCEPTION(0, Aead, NULL, "scrypt is not supported by OpenSSL");
+#endif
+	default:
+		THROW_EXCEPTION(0, Aead, NULL, "Unknown KDF %d", (int)params.id);
+	}
+}
+
+size_t Aead::writeKdf(const KdfParams &params, unsigned char *out){
+	size_t len = 0;
+
+	out[len++] = AEAD_SALT_LEN;
+	memcpy(out + len, params.salt, AEAD_SALT_LEN);
+	len += AEAD_SALT_LEN;
+
+	if (params.id == KDF_SCRYPT){
+		out[len++] = params.logN;
+		out[len++] = params.r;
+		out[len++] = params.p;
+		out[len++] = 0;
+	}
+	else{
+		out[len++] = (unsigned char)(params.iterations >> 24);
+		out[len++] = (unsigned char)(params.iterations >> 16);
+		out[len++] = (unsigned char)(params.iterations >> 8);
+		out[len++] = (unsigned char)params.iterations;
+	}
+
+	return len;
+}
+
+size_t Aead::writeHeader(const Header &header, unsigned char *out){
+	size_t len = 0;
+
+	memcpy(out, AEAD_MAGIC, AEAD_MAGIC_LEN);
+	len += AEAD_MAGIC_LEN;
+	out[len++] = header.version;
+	out[len++] = (unsigned char)header.algorithm;
+	out[len++] = (unsigned char)header.kdf.id;
+	out[len++] = AEAD_NONCE_LEN;
+
+	if (header.kdf.id != KDF_NONE){
+		len += Aead::writeKdf(header.kdf, out + len);
+	}
+
+	memcpy(out + len, header.nonce, AEAD_NONCE_LEN);
+	len += AEAD_NONCE_LEN;
+
+	if (header.version == AEAD_VERSION_SEGMENTS){
+		out[len++] = (unsigned char)(header.segmentSize >> 24);
+		out[len++] = (unsigned char)(header.segmentSize >> 16);
+		out[len++] = (unsigned char)(header.segmentSize >> 8);
+		out[len++] = (unsigned char)header.segmentSize;
+	}
+
+	return len;
+}
+
+size_t Aead::readHeader(BIO *in, Header &header, unsigned char *raw){
+	LOGGER_FN();
+
+	size_t len = AEAD_MAGIC_LEN + 4;
+	readExact(in, raw, (int)len);
+
+	if (memcmp(raw, AEAD_MAGIC, AEAD_MAGIC_LEN)){
+		THROW_EXCEPTION(0, Aead, NULL, "bad magic number");
+	}
+
+	header.version = raw[AEAD_MAGIC_LEN];
+	if (header.version != AEAD_VERSION && header.version != AEAD_VERSION_SEGMENTS){
+		THROW_EXCEPTION(0, Aead, NULL, "Unsupported AEAD format version %d", (int)header.version);
+	}
+
+	header.algorithm = (Algorithm)raw[AEAD_MAGIC_LEN + 1];
+	Aead::getCipher(header.algorithm);
+
+	KdfParams &kdf = header.kdf;
+	kdf.id = (Kdf)raw[AEAD_MAGIC_LEN + 2];
+	kdf.iterations = 0;
+	kdf.logN = kdf.r = kdf.p = 0;
+	if (raw[AEAD_MAGIC_LEN + 3] != AEAD_NONCE_LEN){
+		THROW_EXCEPTION(0, Aead, NULL, "Unsupported nonce length %d", (int)raw[AEAD_MAGIC_LEN + 3]);
+	}
+
+	if (kdf.id != KDF_NONE){
+		readExact(in, raw + len, 1 + AEAD_SALT_LEN + 4);
+		if (raw[len] != AEAD_SALT_LEN){
+			THROW_EXCEPTION(0, Aead, NULL, "Unsupported salt length %d", (int)raw[len]);
+		}
+		memcpy(kdf.salt, raw + len + 1, AEAD_SALT_LEN);
+		len += 1 + AEAD_SALT_LEN;
+
+		if (kdf.id == KDF_SCRYPT){
+			kdf.logN = raw[len];
+			kdf.r = raw[len + 1];
+			kdf.p = raw[len + 2];
+		}
+		else{
+			kdf.iterations = ((unsigned int)raw[len] << 24) | ((unsigned int)raw[len + 1] << 16) |
+				((unsigned int)raw[len + 2] << 8) | (unsigned int)raw[len + 3];
+		}
+		len += 4;
+	}
+	Aead::checkKdf(kdf);
+
+	readExact(in, raw + len, AEAD_NONCE_LEN);
+	memcpy(header.nonce, raw + len, AEAD_NONCE_LEN);
+	len += AEAD_NONCE_LEN;
+
+	header.segmentSize = 0;
+	if (header.version == AEAD_VERSION_SEGMENTS){
+		readExact(in, raw + len, 4);
+		header.segmentSize = ((unsigned int)raw[len] << 24) | ((unsigned int)raw[len + 1] << 16) |
+			((unsigned int)raw[len + 2] << 8) | (unsigned int)raw[len + 3];
+		len += 4;
+		if (!header.segmentSize || header.segmentSize > AEAD_MAX_SEGMENT_SIZE){
+			THROW_EXCEPTION(0, Aead, NULL, "Invalid segment size %u", header.segmentSize);
+		}
+	}
+
+	return len;
+}
+
+/*
+* Files of one batch share the salt of their Cipher, so the key of the
+* batch is derived once for encryption and once for decryption.
+*/
+void Aead::deriveKey(const char *pass, const KdfParams &params, unsigned char *key){
+	LOGGER_FN();
+
+	unsigned char raw[2 + AEAD_SALT_LEN + 4];
+	raw[0] = (unsigned char)params.id;
+	size_t rawLen = 1 + Aead::writeKdf(params, raw + 1);
+
+	unsigned char id[KEY_CACHE_ID_LEN];
+	KeyCache::makeId(pass, raw, rawLen, id);
+	if (KeyCache::get(id, key, AEAD_KEY_LEN)){
+		return;
+	}
+
+	switch (params.id){
+	case KDF_PBKDF2_SHA256:
+		LOGGER_OPENSSL(PKCS5_PBKDF2_HMAC);
+		if (!PKCS5_PBKDF2_HMAC(pass, (int)strlen(pass), params.salt, AEAD_SALT_LEN,
+			(int)params.iterations, EVP_sha256(), AEAD_KEY_LEN, key)){
+			THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "PKCS5_PBKDF2_HMAC");
+		}
+		break;
+#ifdef AEAD_HAVE_SCRYPT
+	case KDF_SCRYPT:
+		/* V is 128 * r * N bytes, B is 128 * r * p bytes */
+		LOGGER_OPENSSL(EVP_PBE_scrypt);
+		if (!EVP_PBE_scrypt(pass, strlen(pass), params.salt, AEAD_SALT_LEN,
+			1ULL << params.logN, params.r, params.p,
+			128ULL * params.r * ((1ULL << params.logN) + params.p + 2), key, AEAD_KEY_LEN)){
+			THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "EVP_PBE_scrypt");
+		}
+		break;
+#endif
+	default:
+		THROW_EXCEPTION(0, Aead, NULL, "Unknown KDF %d", (int)params.id);
+	}
+
+	KeyCache::put(id, key, AEAD_KEY_LEN);
+}
+
+EVP_CIPHER_CTX *Aead::init(const Header &header, const unsigned char *key,
+	const unsigned char *aad, size_t aadLen, bool encrypt)
+{
+	LOGGER_FN();
+
+	const EVP_CIPHER *cipher = Aead::getCipher(header.algorithm);
+
+	LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+	EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+	if (!ctx){
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "EVP_CIPHER_CTX_new");
+	}
+
+	int outl = 0;
+	int enc = encrypt ? 1 : 0;
+	LOGGER_OPENSSL(EVP_CipherInit_ex);
+	if (!EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, enc)
+		|| !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, AEAD_NONCE_LEN, NULL)
+		|| !EVP_CipherInit_ex(ctx, NULL, NULL, key, header.nonce, enc)
+		|| !EVP_CipherUpdate(ctx, NULL, &outl, aad, (int)aadLen)){
+		EVP_CIPHER_CTX_free(ctx);
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "Error setting cipher");
+	}
+
+	return ctx;
+}
+
+void Aead::update(EVP_CIPHER_CTX *ctx, const unsigned char *in, int inl, unsigned char *buff, BIO *out){
+	int outl = 0;
+
+	LOGGER_OPENSSL(EVP_CipherUpdate);
+	if (!EVP_CipherUpdate(ctx, buff, &outl, in, inl)){
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "EVP_CipherUpdate");
+	}
+	writeAll(out, buff, outl);
+}
+
+void Aead::initHeader(Header &header, Algorithm algorithm, bool password, const KdfParams *kdf,
+	unsigned int segmentSize)
+{
+	LOGGER_FN();
+
+	header.version = segmentSize ? AEAD_VERSION_SEGMENTS : AEAD_VERSION;
+	header.algorithm = algorithm;
+	header.segmentSize = segmentSize;
+
+	if (!password){
+		memset(&header.kdf, 0, sizeof header.kdf);
+		header.kdf.id = KDF_NONE;
+	}
+	else if (kdf){
+		Aead::checkKdf(*kdf);
+		header.kdf = *kdf;
+	}
+	else{
+		Aead::initKdf(header.kdf, KDF_PBKDF2_SHA256, 0);
+	}
+
+	LOGGER_OPENSSL(RAND_bytes);
+	if (RAND_bytes(header.nonce, AEAD_NONCE_LEN) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "RAND_bytes");
+	}
+}
+
+void Aead::encrypt(Algorithm algorithm, const char *pass, const KdfParams *kdf, const unsigned char *key,
+	BIO *in, BIO *out, int bsize)
+{
+	LOGGER_FN();
+
+	Header header;
+	Aead::initHeader(header, algorithm, pass != NULL, kdf, 0);
+
+	unsigned char raw[AEAD_MAX_HEADER_LEN];
+	size_t rawLen = Aead::writeHeader(header, raw);
+
+	unsigned char derived[AEAD_KEY_LEN];
+	if (pass){
+		Aead::deriveKey(pass, header.kdf, derived);
+		key = derived;
+	}
+
+	EVP_CIPHER_CTX *ctx = NULL;
+	try{
+		ctx = Aead::init(header, key, raw, rawLen, true);
+		OPENSSL_cleanse(derived, sizeof derived);
+
+		writeAll(out, raw, (int)rawLen);
+
+		const unsigned char *data = NULL;
+		size_t length = 0;
+		if (BIO_mmap_get_data(in, &data, &length)){
+			PooledBuffer buff(CIPHER_MMAP_CHUNK);
+			for (size_t offset = 0; offset < length;){
+				ThreadPool::checkCancelled();
+				int inl = (int)(length - offset < CIPHER_MMAP_CHUNK ? length - offset : CIPHER_MMAP_CHUNK);
+				Aead::update(ctx, data + offset, inl, buff.data(), out);
+				offset += inl;
+			}
+			if (!BIO_mmap_skip(in, length)){
+				THROW_EXCEPTION(0, Aead, NULL, "Error skipping input bio");
+			}
+		}
+		else{
+			PooledBuffer buff(2 * (size_t)bsize);
+			for (;;){
+				ThreadPool::checkCancelled();
+				LOGGER_OPENSSL(BIO_read);
+				int inl = BIO_read(in, (char *)buff.data(), bsize);
+				if (inl <= 0){
+					break;
+				}
+				Aead::update(ctx, buff.data(), inl, buff.data() + bsize, out);
+			}
+		}
+
+		int outl = 0;
+		unsigned char tag[AEAD_TAG_LEN];
+		LOGGER_OPENSSL(EVP_CipherFinal_ex);
+		if (!EVP_CipherFinal_ex(ctx, tag, &outl)
+			|| !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AEAD_TAG_LEN, tag)){
+			THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "Error finalize cipher");
+		}
+		writeAll(out, tag, AEAD_TAG_LEN);
+
+		EVP_CIPHER_CTX_free(ctx);
+	}
+	catch (Handle<Exception> &e){
+		OPENSSL_cleanse(derived, sizeof derived);
+		if (ctx){
+			EVP_CIPHER_CTX_free(ctx);
+		}
+		throw;
+	}
+}
+
+/*
+* Plaintext is written before the tag is checked. The caller must drop
+* the output if "bad decrypt" is thrown.
+*/
+void Aead::decrypt(const char *pass, const unsigned char *key, BIO *in, BIO *out, int bsize, size_t threads){
+	LOGGER_FN();
+
+	Header header;
+	unsigned char raw[AEAD_MAX_HEADER_LEN];
+	size_t rawLen = Aead::readHeader(in, header, raw);
+
+	unsigned char derived[AEAD_KEY_LEN];
+	if (header.kdf.id != KDF_NONE){
+		if (!pass){
+			THROW_EXCEPTION(0, Aead, NULL, "Data is encrypted by password");
+		}
+		Aead::deriveKey(pass, header.kdf, derived);
+		key = derived;
+	}
+
+	if (header.version == AEAD_VERSION_SEGMENTS){
+		try{
+			AeadSegments::decrypt(header, raw, rawLen, key, in, out, threads);
+		}
+		catch (Handle<Exception> &e){
+			OPENSSL_cleanse(derived, sizeof derived);
+			throw;
+		}
+		OPENSSL_cleanse(derived, sizeof derived);
+		return;
+	}
+
+	EVP_CIPHER_CTX *ctx = NULL;
+	try{
+		ctx = Aead::init(header, key, raw, rawLen, false);
+		OPENSSL_cleanse(derived, sizeof derived);
+
+		unsigned char tag[AEAD_TAG_LEN];
+		const unsigned char *data = NULL;
+		size_t length = 0;
+		if (BIO_mmap_get_data(in, &data, &length)){
+			if (length < AEAD_TAG_LEN){
+				THROW_EXCEPTION(0, Aead, NULL, "error reading input file");
+			}
+			size_t dataLen = length - AEAD_TAG_LEN;
+			PooledBuffer buff(CIPHER_MMAP_CHUNK);
+			for (size_t offset = 0; offset < dataLen;){
+				ThreadPool::checkCancelled();
+				int inl = (int)(dataLen - offset < CIPHER_MMAP_CHUNK ? dataLen - offset : CIPHER_MMAP_CHUNK);
+				Aead::update(ctx, data + offset, inl, buff.data(), out);
+				offset += inl;
+			}
+			memcpy(tag, data + dataLen, AEAD_TAG_LEN);
+			if (!BIO_mmap_skip(in, length)){
+				THROW_EXCEPTION(0, Aead, NULL, "Error skipping input bio");
+			}
+		}
+		else{
+			/*Last AEAD_TAG_LEN bytes read so far are kept at the start of the input buffer*/
+			PooledBuffer buff(2 * ((size_t)bsize + AEAD_TAG_LEN));
+			unsigned char *inBuff = buff.data();
+			unsigned char *outBuff = buff.data() + bsize + AEAD_TAG_LEN;
+			int held = 0;
+			for (;;){
+				ThreadPool::checkCancelled();
+				LOGGER_OPENSSL(BIO_read);
+				int inl = BIO_read(in, (char *)inBuff + held, bsize);
+				if (inl <= 0){
+					break;
+				}
+				int total = held + inl;
+				if (total > AEAD_TAG_LEN){
+					Aead::update(ctx, inBuff, total - AEAD_TAG_LEN, outBuff, out);
+					memmove(inBuff, inBuff + total - AEAD_TAG_LEN, AEAD_TAG_LEN);
+					held = AEAD_TAG_LEN;
+				}
+				else{
+					held = total;
+				}
+			}
+			if (held != AEAD_TAG_LEN){
+				THROW_EXCEPTION(0, Aead, NULL, "error reading input file");
+			}
+			memcpy(tag, inBuff, AEAD_TAG_LEN);
+		}
+
+		int outl = 0;
+		unsigned char last[EVP_MAX_BLOCK_LENGTH];
+		LOGGER_OPENSSL(EVP_CipherFinal_ex);
+		if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AEAD_TAG_LEN, tag)
+			|| !EVP_CipherFinal_ex(ctx, last, &outl)){
+			THROW_OPENSSL_EXCEPTION(0, Aead, NULL, "bad decrypt");
+		}
+
+		EVP_CIPHER_CTX_free(ctx);
+	}
+	catch (Handle<Exception> &e){
+		OPENSSL_cleanse(derived, sizeof derived);
+		if (ctx){
+			EVP_CIPHER_CTX_free(ctx);
+		}
+		throw;
+	}
+}
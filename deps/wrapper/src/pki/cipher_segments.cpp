@@ -0,0 +1,627 @@
+#include "../stdafx.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+#include "wrapper/pki/cipher.h"
+#include "wrapper/pki/cipher_segments.h"
+#include "wrapper/common/thread_pool.h"
+
+/* Segments of one batch per thread */
+#define AEAD_SEGMENTS_PER_THREAD 2
+/*
+* Buffers of one batch. Segment size of decryption comes from the header
+* which is not authenticated yet, so it must not choose the memory alone
+*/
+#define AEAD_SEGMENTS_BATCH_MEM	(64 * 1024 * 1024)
+
+struct Segment{
+	unsigned long long index;
+	bool last;
+	/* Decryption input includes the tag */
+	const unsigned char *in;
+	size_t inl;
+	unsigned char *out;
+	size_t outl;
+};
+
+/*
+* Cipher contexts of one call, the key is set once per context and every
+* segment sets only its nonce. The calling thread takes part in every
+* batch, other contexts are used by helper tasks of ThreadPool::shared().
+* Helpers are queued for idle threads of the pool only, so concurrent
+* calls do not start more threads than the pool has; without the shared
+* pool segments are processed by the calling thread.
+*/
+class SegmentWorkers{
+public:
+	SegmentWorkers(const Aead::Header &header, const unsigned char *key, bool encrypt, size_t threads);
+	~SegmentWorkers();
+
+	size_t size();
+
+	/* Process segments and wait for them. trailer is authenticated by the last segment */
+	void run(std::vector<Segment> &segments, const unsigned char *aad, size_t aadLen, const unsigned char *trailer);
+
+protected:
+	/*
+	* State of one batch shared with its helper tasks. Helper which starts
+	* after the batch is closed (workers is NULL) does nothing
+	*/
+	struct Batch{
+		std::mutex lock;
+		std::condition_variable done;
+		SegmentWorkers *workers;
+		size_t active;
+	};
+
+	static void help(const std::shared_ptr<Batch> &batch, size_t worker);
+	void work(size_t worker);
+	void process(EVP_CIPHER_CTX *ctx, Segment &segment);
+	void clear();
+
+protected:
+	unsigned char nonce_[AEAD_NONCE_LEN];
+	bool encrypt_;
+	std::vector<EVP_CIPHER_CTX *> ctxs_;
+	ThreadPool *pool_;
+
+	std::mutex lock_;
+	Handle<Exception> error_;
+
+	std::vector<Segment> *segments_;
+	const unsigned char *aad_;
+	size_t aadLen_;
+	const unsigned char *trailer_;
+	std::atomic<size_t> next_;
+};
+
+SegmentWorkers::SegmentWorkers(const Aead::Header &header, const unsigned char *key, bool encrypt, size_t threads)
+	: encrypt_(encrypt), pool_(ThreadPool::shared()),
+	segments_(NULL), aad_(NULL), aadLen_(0), trailer_(NULL), next_(0)
+{
+	LOGGER_FN();
+
+	memcpy(this->nonce_, header.nonce, AEAD_NONCE_LEN);
+
+	size_t helpers = this->pool_ ? this->pool_->idle() : 0;
+	if (threads > helpers + 1){
+		threads = helpers + 1;
+	}
+
+	const EVP_CIPHER *cipher = Aead::getCipher(header.algorithm);
+	int enc = encrypt ? 1 : 0;
+
+	for (size_t i = 0; i < threads; i++){
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+		EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+		if (ctx){
+			this->ctxs_.push_back(ctx);
+		}
+
+		LOGGER_OPENSSL(EVP_CipherInit_ex);
+		if (!ctx
+			|| !EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, enc)
+			|| !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, AEAD_NONCE_LEN, NULL)
+			|| !EVP_CipherInit_ex(ctx, NULL, NULL, key, NULL, enc)){
+			this->clear();
+			THROW_OPENSSL_EXCEPTION(0, SegmentWorkers, NULL, "Error setting cipher");
+		}
+	}
+}
+
+SegmentWorkers::~SegmentWorkers(){
+	LOGGER_FN();
+
+	this->clear();
+}
+
+void SegmentWorkers::clear(){
+	for (size_t i = 0; i < this->ctxs_.size(); i++){
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_free);
+		EVP_CIPHER_CTX_free(this->ctxs_[i]);
+	}
+	this->ctxs_.clear();
+}
+
+size_t SegmentWorkers::size(){
+	return this->ctxs_.size();
+}
+
+void SegmentWorkers::run(std::vector<Segment> &segments, const unsigned char *aad, size_t aadLen, const unsigned char *trailer){
+	LOGGER_FN();
+
+	this->segments_ = &segments;
+	this->aad_ = aad;
+	this->aadLen_ = aadLen;
+	this->trailer_ = trailer;
+	this->next_ = 0;
+	this->error_ = NULL;
+
+	std::shared_ptr<Batch> batch(new Batch());
+	batch->workers = this;
+	batch->active = 0;
+
+	/* Busy pool or full queue only leaves more segments to this thread */
+	for (size_t i = 1; i < this->ctxs_.size() && segments.size() > i; i++){
+		try{
+			this->pool_->push(std::bind(&SegmentWorkers::help, batch, i), ThreadPool::Low);
+		}
+		catch (Handle<Exception> &){
+			break;
+		}
+	}
+
+	this->work(0);
+
+	{
+		std::unique_lock<std::mutex> lock(batch->lock);
+		batch->workers = NULL;
+		while (batch->active){
+			batch->done.wait(lock);
+		}
+	}
+
+	if (!this->error_.isEmpty()){
+		Handle<Exception> e = this->error_;
+		this->error_ = NULL;
+		throw e;
+	}
+}
+
+void SegmentWorkers::help(const std::shared_ptr<Batch> &batch, size_t worker){
+	SegmentWorkers *workers;
+	{
+		std::lock_guard<std::mutex> lock(batch->lock);
+		if (!batch->workers){
+			return;
+		}
+		workers = batch->workers;
+		batch->active++;
+	}
+
+	workers->work(worker);
+
+	std::lock_guard<std::mutex> lock(batch->lock);
+	if (!--batch->active){
+		batch->done.notify_one();
+	}
+}
+
+void SegmentWorkers::work(size_t worker){
+	for (;;){
+		size_t i = this->next_.fetch_add(1);
+		if (i >= this->segments_->size()){
+			break;
+		}
+
+		try{
+			this->process(this->ctxs_[worker], (*this->segments_)[i]);
+		}
+		catch (Handle<Exception> &e){
+			std::lock_guard<std::mutex> lock(this->lock_);
+			if (this->error_.isEmpty()){
+				this->error_ = e;
+			}
+			this->next_ = this->segments_->size();
+		}
+	}
+}
+
+void SegmentWorkers::process(EVP_CIPHER_CTX *ctx, Segment &segment){
+	unsigned char nonce[AEAD_NONCE_LEN];
+	memcpy(nonce, this->nonce_, AEAD_NONCE_LEN);
+	for (int i = 0; i < 8; i++){
+		nonce[AEAD_NONCE_LEN - 1 - i] ^= (unsigned char)(segment.index >> (8 * i));
+	}
+	if (segment.last){
+		nonce[0] ^= 0x80;
+	}
+
+	int enc = this->encrypt_ ? 1 : 0;
+	int outl = 0;
+	if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, nonce, enc)
+		|| !EVP_CipherUpdate(ctx, NULL, &outl, this->aad_, (int)this->aadLen_)
+		|| (segment.last && !EVP_CipherUpdate(ctx, NULL, &outl, this->trailer_, AEAD_TRAILER_LEN))){
+		THROW_OPENSSL_EXCEPTION(0, SegmentWorkers, NULL, "Error setting cipher");
+	}
+
+	size_t len = this->encrypt_ ? segment.inl : segment.inl - AEAD_TAG_LEN;
+	if (len && !EVP_CipherUpdate(ctx, segment.out, &outl, segment.in, (int)len)){
+		THROW_OPENSSL_EXCEPTION(0, SegmentWorkers, NULL, "EVP_CipherUpdate");
+	}
+
+	if (this->encrypt_){
+		if (!EVP_CipherFinal_ex(ctx, segment.out + len, &outl)
+			|| !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AEAD_TAG_LEN, segment.out + len)){
+			THROW_OPENSSL_EXCEPTION(0, SegmentWorkers, NULL, "Error finalize cipher");
+		}
+		segment.outl = len + AEAD_TAG_LEN;
+	}
+	else{
+		unsigned char tag[AEAD_TAG_LEN];
+		unsigned char last[EVP_MAX_BLOCK_LENGTH];
+		memcpy(tag, segment.in + len, AEAD_TAG_LEN);
+		if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AEAD_TAG_LEN, tag)
+			|| !EVP_CipherFinal_ex(ctx, last, &outl)){
+			THROW_OPENSSL_EXCEPTION(0, SegmentWorkers, NULL, "bad decrypt");
+		}
+		segment.outl = len;
+	}
+}
+
+/* Segments of one batch for buffers of segmentMem bytes per segment */
+static size_t batchLimit(size_t segmentMem){
+	size_t res = AEAD_SEGMENTS_BATCH_MEM / segmentMem;
+	return res ? res : 1;
+}
+
+static size_t batchSize(size_t workers, size_t limit){
+	size_t res = workers * AEAD_SEGMENTS_PER_THREAD;
+	return res < limit ? res : limit;
+}
+
+/* Threads for segments, but no more than segments of one batch (limit) */
+static size_t threadCount(size_t threads, unsigned long long segments, size_t limit){
+	if (segments > limit){
+		segments = limit;
+	}
+	if (!threads){
+		threads = std::thread::hardware_concurrency();
+	}
+	if (threads > segments){
+		threads = (size_t)segments;
+	}
+	return threads ? threads : 1;
+}
+
+static size_t readFull(BIO *in, unsigned char *out, size_t len){
+	size_t res = 0;
+	while (res < len){
+		LOGGER_OPENSSL(BIO_read);
+		int inl = BIO_read(in, (char *)out + res, (int)(len - res));
+		if (inl <= 0){
+			break;
+		}
+		res += inl;
+	}
+	return res;
+}
+
+static void writeAll(BIO *out, const unsigned char *data, size_t len){
+	LOGGER_OPENSSL(BIO_write);
+	if (len && BIO_write(out, (const char *)data, (int)len) != (int)len) {
+		THROW_OPENSSL_EXCEPTION(0, AeadSegments, NULL, "Error writing output bio");
+	}
+}
+
+/* Not yet read data of memory mapped file or memory BIO */
+static bool getData(BIO *in, const unsigned char **data, size_t *length){
+	if (BIO_mmap_get_data(in, data, length)){
+		return true;
+	}
+
+	if (BIO_method_type(in) == BIO_TYPE_MEM){
+		char *ptr = NULL;
+		long len = BIO_get_mem_data(in, &ptr);
+		if (len < 0){
+			return false;
+		}
+		*data = (const unsigned char *)ptr;
+		*length = (size_t)len;
+		return true;
+	}
+
+	return false;
+}
+
+static void writeTrailer(unsigned char *trailer, unsigned long long length){
+	memcpy(trailer, AEAD_TRAILER_MAGIC, AEAD_MAGIC_LEN);
+	for (int i = 0; i < 8; i++){
+		trailer[AEAD_TRAILER_LEN - 1 - i] = (unsigned char)(length >> (8 * i));
+	}
+}
+
+/* Plaintext length of the trailer. Changed trailer fails the last segment anyway */
+static unsigned long long readTrailer(const unsigned char *trailer){
+	if (memcmp(trailer, AEAD_TRAILER_MAGIC, AEAD_MAGIC_LEN)){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "bad decrypt");
+	}
+
+	unsigned long long res = 0;
+	for (int i = AEAD_MAGIC_LEN; i < AEAD_TRAILER_LEN; i++){
+		res = (res << 8) | trailer[i];
+	}
+	return res;
+}
+
+void AeadSegments::encrypt(Aead::Algorithm algorithm, const char *pass, const Aead::KdfParams *kdf,
+	const unsigned char *key, BIO *in, BIO *out, unsigned int segmentSize, size_t threads)
+{
+	LOGGER_FN();
+
+	if (!segmentSize || segmentSize > AEAD_MAX_SEGMENT_SIZE){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "Invalid segment size %u", segmentSize);
+	}
+
+	Aead::Header header;
+	Aead::initHeader(header, algorithm, pass != NULL, kdf, segmentSize);
+
+	unsigned char raw[AEAD_MAX_HEADER_LEN];
+	size_t rawLen = Aead::writeHeader(header, raw);
+
+	unsigned char derived[AEAD_KEY_LEN];
+	if (pass){
+		Aead::deriveKey(pass, header.kdf, derived);
+		key = derived;
+	}
+
+	try{
+		const unsigned char *data = NULL;
+		size_t length = 0;
+		bool mapped = BIO_mmap_get_data(in, &data, &length) != 0;
+		size_t recordLen = (size_t)segmentSize + AEAD_TAG_LEN;
+		size_t limit = batchLimit(recordLen + (mapped ? 0 : segmentSize));
+
+		SegmentWorkers workers(header, key, true,
+			threadCount(threads, mapped ? length / segmentSize + 1 : (unsigned long long)-1, limit));
+		OPENSSL_cleanse(derived, sizeof derived);
+
+		writeAll(out, raw, rawLen);
+
+		size_t batch = batchSize(workers.size(), limit);
+		PooledBuffer outBuff(batch * recordLen);
+		PooledBuffer inBuff(mapped ? 0 : batch * segmentSize);
+		std::vector<Segment> segments;
+		unsigned char trailer[AEAD_TRAILER_LEN];
+		unsigned long long index = 0;
+		unsigned long long total = 0;
+		bool last = false;
+
+		while (!last){
+			ThreadPool::checkCancelled();
+
+			segments.clear();
+			for (size_t i = 0; i < batch && !last; i++){
+				Segment segment;
+				segment.index = index++;
+				segment.out = outBuff.data() + i * recordLen;
+				if (mapped){
+					segment.in = data + total;
+					segment.inl = length - total < segmentSize ? length - total : segmentSize;
+				}
+				else{
+					segment.in = inBuff.data() + i * segmentSize;
+					segment.inl = readFull(in, inBuff.data() + i * segmentSize, segmentSize);
+				}
+				/*The last segment is shorter, it is empty if the data ends on the boundary*/
+				segment.last = last = segment.inl < segmentSize;
+				total += segment.inl;
+				segments.push_back(segment);
+			}
+
+			if (last){
+				writeTrailer(trailer, total);
+			}
+
+			workers.run(segments, raw, rawLen, trailer);
+
+			for (size_t i = 0; i < segments.size(); i++){
+				writeAll(out, segments[i].out, segments[i].outl);
+			}
+		}
+
+		writeAll(out, trailer, AEAD_TRAILER_LEN);
+
+		if (mapped && !BIO_mmap_skip(in, length)){
+			THROW_EXCEPTION(0, AeadSegments, NULL, "Error skipping input bio");
+		}
+	}
+	catch (Handle<Exception> &e){
+		OPENSSL_cleanse(derived, sizeof derived);
+		throw;
+	}
+}
+
+void AeadSegments::decrypt(const Aead::Header &header, const unsigned char *raw, size_t rawLen,
+	const unsigned char *key, BIO *in, BIO *out, size_t threads)
+{
+	LOGGER_FN();
+
+	size_t segmentSize = header.segmentSize;
+	size_t recordLen = segmentSize + AEAD_TAG_LEN;
+
+	const unsigned char *data = NULL;
+	size_t length = 0;
+	bool mapped = BIO_mmap_get_data(in, &data, &length) != 0;
+
+	unsigned char trailer[AEAD_TRAILER_LEN];
+	if (mapped){
+		if (length < AEAD_TAG_LEN + AEAD_TRAILER_LEN){
+			THROW_EXCEPTION(0, AeadSegments, NULL, "error reading input file");
+		}
+		length -= AEAD_TRAILER_LEN;
+		memcpy(trailer, data + length, AEAD_TRAILER_LEN);
+	}
+
+	/*Slot of not mapped input keeps the next bytes which may be the trailer*/
+	size_t slotLen = recordLen + AEAD_TRAILER_LEN;
+	size_t limit = batchLimit(segmentSize + (mapped ? 0 : slotLen));
+
+	SegmentWorkers workers(header, key, false,
+		threadCount(threads, mapped ? length / recordLen + 1 : (unsigned long long)-1, limit));
+
+	size_t batch = batchSize(workers.size(), limit);
+	PooledBuffer outBuff(batch * segmentSize);
+	PooledBuffer inBuff(mapped ? 0 : batch * slotLen);
+	std::vector<Segment> segments;
+	const unsigned char *carry = NULL;
+	size_t carryLen = 0;
+	size_t offset = 0;
+	unsigned long long index = 0;
+	unsigned long long total = 0;
+	bool last = false;
+
+	while (!last){
+		ThreadPool::checkCancelled();
+
+		segments.clear();
+		for (size_t i = 0; i < batch && !last; i++){
+			Segment segment;
+			segment.index = index++;
+			segment.out = outBuff.data() + i * segmentSize;
+
+			if (mapped){
+				size_t rest = length - offset;
+				segment.in = data + offset;
+				segment.inl = rest < recordLen ? rest : recordLen;
+				segment.last = rest < recordLen;
+				offset += segment.inl;
+			}
+			else{
+				unsigned char *slot = inBuff.data() + i * slotLen;
+				if (carryLen){
+					memmove(slot, carry, carryLen);
+				}
+				size_t inl = carryLen + readFull(in, slot + carryLen, slotLen - carryLen);
+				segment.in = slot;
+				segment.last = inl < slotLen;
+				if (segment.last){
+					segment.inl = inl < AEAD_TRAILER_LEN ? 0 : inl - AEAD_TRAILER_LEN;
+					if (segment.inl >= AEAD_TAG_LEN){
+						memcpy(trailer, slot + segment.inl, AEAD_TRAILER_LEN);
+					}
+				}
+				else{
+					segment.inl = recordLen;
+					carry = slot + recordLen;
+					carryLen = AEAD_TRAILER_LEN;
+				}
+			}
+
+			if (segment.inl < AEAD_TAG_LEN){
+				THROW_EXCEPTION(0, AeadSegments, NULL, "error reading input file");
+			}
+
+			last = segment.last;
+			total += segment.inl - AEAD_TAG_LEN;
+			segments.push_back(segment);
+		}
+
+		if (last && readTrailer(trailer) != total){
+			THROW_EXCEPTION(0, AeadSegments, NULL, "bad decrypt");
+		}
+
+		workers.run(segments, raw, rawLen, trailer);
+
+		for (size_t i = 0; i < segments.size(); i++){
+			writeAll(out, segments[i].out, segments[i].outl);
+		}
+	}
+
+	if (mapped && !BIO_mmap_skip(in, length + AEAD_TRAILER_LEN)){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "Error skipping input bio");
+	}
+}
+
+void AeadSegments::decryptRange(const char *pass, const unsigned char *key, BIO *in, BIO *out,
+	unsigned long long offset, unsigned long long length, size_t threads)
+{
+	LOGGER_FN();
+
+	Aead::Header header;
+	unsigned char raw[AEAD_MAX_HEADER_LEN];
+	size_t rawLen = Aead::readHeader(in, header, raw);
+	if (header.version != AEAD_VERSION_SEGMENTS){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "Data is not segmented");
+	}
+
+	const unsigned char *data = NULL;
+	size_t size = 0;
+	if (!getData(in, &data, &size)){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "Range is decrypted from file or buffer only");
+	}
+	if (size < AEAD_TAG_LEN + AEAD_TRAILER_LEN){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "error reading input file");
+	}
+
+	size_t segmentSize = header.segmentSize;
+	size_t recordLen = segmentSize + AEAD_TAG_LEN;
+	size_t ctLen = size - AEAD_TRAILER_LEN;
+	const unsigned char *trailer = data + ctLen;
+	unsigned long long count = ctLen / recordLen + 1;
+	size_t lastLen = ctLen % recordLen;
+	if (lastLen < AEAD_TAG_LEN){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "error reading input file");
+	}
+
+	unsigned long long plain = readTrailer(trailer);
+	if (plain != (count - 1) * segmentSize + lastLen - AEAD_TAG_LEN){
+		THROW_EXCEPTION(0, AeadSegments, NULL, "bad decrypt");
+	}
+
+	if (offset >= plain || !length){
+		return;
+	}
+	if (length > plain - offset){
+		length = plain - offset;
+	}
+
+	unsigned long long first = offset / segmentSize;
+	unsigned long long end = (offset + length - 1) / segmentSize + 1;
+
+	unsigned char derived[AEAD_KEY_LEN];
+	if (header.kdf.id != Aead::KDF_NONE){
+		if (!pass){
+			THROW_EXCEPTION(0, AeadSegments, NULL, "Data is encrypted by password");
+		}
+		Aead::deriveKey(pass, header.kdf, derived);
+		key = derived;
+	}
+
+	try{
+		size_t limit = batchLimit(segmentSize);
+		SegmentWorkers workers(header, key, false, threadCount(threads, end - first, limit));
+		OPENSSL_cleanse(derived, sizeof derived);
+
+		size_t batch = batchSize(workers.size(), limit);
+		PooledBuffer outBuff(batch * segmentSize);
+		std::vector<Segment> segments;
+
+		for (unsigned long long index = first; index < end;){
+			ThreadPool::checkCancelled();
+
+			segments.clear();
+			for (size_t i = 0; i < batch && index < end; i++, index++){
+				Segment segment;
+				segment.index = index;
+				segment.last = index == count - 1;
+				segment.in = data + index * recordLen;
+				segment.inl = segment.last ? lastLen : recordLen;
+				segment.out = outBuff.data() + i * segmentSize;
+				segments.push_back(segment);
+			}
+
+			workers.run(segments, raw, rawLen, trailer);
+
+			for (size_t i = 0; i < segments.size(); i++){
+				unsigned long long start = segments[i].index * segmentSize;
+				size_t skip = offset > start ? (size_t)(offset - start) : 0;
+				size_t len = segments[i].outl - skip;
+				if (start + skip + len > offset + length){
+					len = (size_t)(offset + length - start - skip);
+				}
+				writeAll(out, segments[i].out + skip, len);
+			}
+		}
+	}
+	catch (Handle<Exception> &e){
+		OPENSSL_cleanse(derived, sizeof derived);
+		throw;
+	}
+}
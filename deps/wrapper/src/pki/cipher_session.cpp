@@ -0,0 +1,164 @@
+#include "../stdafx.h"
+
+#include <openssl/rand.h>
+
+#include "wrapper/pki/cipher_session.h"
+
+CipherSession::CipherSession(const EVP_CIPHER *cipher, Aead::Algorithm aead, const unsigned char *key)
+	: cipher(cipher), aead(aead), messages(0), encCtx(NULL), decCtx(NULL)
+{
+	LOGGER_FN();
+
+	if (!cipher){
+		THROW_EXCEPTION(0, CipherSession, NULL, "Cipher undefined");
+	}
+
+	this->ivLen = aead != Aead::NONE ? AEAD_NONCE_LEN : EVP_CIPHER_iv_length(cipher);
+	memcpy(this->key, key, EVP_CIPHER_key_length(cipher));
+
+	LOGGER_OPENSSL(RAND_bytes);
+	if (RAND_bytes(this->nonce, sizeof this->nonce) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "RAND_bytes");
+	}
+}
+
+CipherSession::~CipherSession(){
+	LOGGER_FN();
+
+	if (this->encCtx){
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_free);
+		EVP_CIPHER_CTX_free(this->encCtx);
+	}
+	if (this->decCtx){
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_free);
+		EVP_CIPHER_CTX_free(this->decCtx);
+	}
+	OPENSSL_cleanse(this->key, sizeof this->key);
+}
+
+/* Context is keyed on the first use */
+EVP_CIPHER_CTX *CipherSession::context(bool encrypt){
+	LOGGER_FN();
+
+	EVP_CIPHER_CTX *&ctx = encrypt ? this->encCtx : this->decCtx;
+	if (ctx){
+		return ctx;
+	}
+
+	LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+	EVP_CIPHER_CTX *res = EVP_CIPHER_CTX_new();
+	if (!res){
+		THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "EVP_CIPHER_CTX_new");
+	}
+
+	int enc = encrypt ? 1 : 0;
+	LOGGER_OPENSSL(EVP_CipherInit_ex);
+	if (!EVP_CipherInit_ex(res, this->cipher, NULL, NULL, NULL, enc)
+		|| (this->aead != Aead::NONE && !EVP_CIPHER_CTX_ctrl(res, EVP_CTRL_GCM_SET_IVLEN, AEAD_NONCE_LEN, NULL))
+		|| !EVP_CipherInit_ex(res, NULL, NULL, this->key, NULL, enc)){
+		EVP_CIPHER_CTX_free(res);
+		THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "Error setting cipher");
+	}
+
+	ctx = res;
+	return ctx;
+}
+
+size_t CipherSession::encryptedLength(size_t inl){
+	if (this->aead != Aead::NONE){
+		return AEAD_NONCE_LEN + inl + AEAD_TAG_LEN;
+	}
+	return this->ivLen + inl + EVP_CIPHER_block_size(this->cipher);
+}
+
+size_t CipherSession::encrypt(const unsigned char *in, size_t inl, unsigned char *out){
+	LOGGER_FN();
+
+	if (inl > INT_MAX - EVP_MAX_BLOCK_LENGTH){
+		THROW_EXCEPTION(0, CipherSession, NULL, "Message is too long");
+	}
+
+	EVP_CIPHER_CTX *ctx = this->context(true);
+
+	unsigned char *iv = out;
+	if (this->aead != Aead::NONE){
+		memcpy(iv, this->nonce, AEAD_NONCE_LEN);
+		for (int i = 0; i < 8; i++){
+			iv[AEAD_NONCE_LEN - 1 - i] ^= (unsigned char)(this->messages >> (8 * i));
+		}
+	}
+	else if (this->ivLen){
+		LOGGER_OPENSSL(RAND_bytes);
+		if (RAND_bytes(iv, this->ivLen) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "RAND_bytes");
+		}
+	}
+	this->messages++;
+
+	unsigned char *data = out + this->ivLen;
+	int outl = 0;
+	int len = 0;
+	LOGGER_OPENSSL(EVP_CipherInit_ex);
+	if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, this->ivLen ? iv : NULL, 1)
+		|| !EVP_CipherUpdate(ctx, data, &outl, in, (int)inl)
+		|| !EVP_CipherFinal_ex(ctx, data + outl, &len)){
+		THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "Error encrypt message");
+	}
+	outl += len;
+
+	if (this->aead != Aead::NONE){
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_ctrl);
+		if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AEAD_TAG_LEN, data + outl)){
+			THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "Error get tag");
+		}
+		outl += AEAD_TAG_LEN;
+	}
+
+	return this->ivLen + outl;
+}
+
+size_t CipherSession::decrypt(const unsigned char *in, size_t inl, unsigned char *out){
+	LOGGER_FN();
+
+	size_t tagLen = this->aead != Aead::NONE ? AEAD_TAG_LEN : 0;
+	if (inl < this->ivLen + tagLen){
+		THROW_EXCEPTION(0, CipherSession, NULL, "Message is too short");
+	}
+	if (inl > INT_MAX){
+		THROW_EXCEPTION(0, CipherSession, NULL, "Message is too long");
+	}
+
+	EVP_CIPHER_CTX *ctx = this->context(false);
+
+	const unsigned char *data = in + this->ivLen;
+	int dataLen = (int)(inl - this->ivLen - tagLen);
+	int outl = 0;
+	int len = 0;
+
+	LOGGER_OPENSSL(EVP_CipherInit_ex);
+	if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, this->ivLen ? in : NULL, 0)
+		|| !EVP_CipherUpdate(ctx, out, &outl, data, dataLen)){
+		THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "Error decrypt message");
+	}
+
+	if (tagLen){
+		unsigned char tag[AEAD_TAG_LEN];
+		memcpy(tag, data + dataLen, AEAD_TAG_LEN);
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_ctrl);
+		if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AEAD_TAG_LEN, tag)){
+			THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "Error set tag");
+		}
+	}
+
+	LOGGER_OPENSSL(EVP_CipherFinal_ex);
+	if (!EVP_CipherFinal_ex(ctx, out + outl, &len)){
+		OPENSSL_cleanse(out, outl);
+		THROW_OPENSSL_EXCEPTION(0, CipherSession, NULL, "bad decrypt");
+	}
+
+	return outl + len;
+}
+
+unsigned long long CipherSession::getMessages(){
+	return this->messages;
+}
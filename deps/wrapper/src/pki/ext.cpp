@@ -3,7 +3,7 @@
 #include "wrapper/pki/ext.h"
 
 Extension::Extension(Handle<OID> oid, Handle<std::string> value)
-	:SSLObject<X509_EXTENSION>(X509_EXTENSION_new(), &so_X509_EXTENSION_free) {
+	:SSLObject<X509_EXTENSION>(X509_EXTENSION_new()) {
 	LOGGER_FN();
 
 	try {
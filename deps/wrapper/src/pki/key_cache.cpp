@@ -0,0 +1,138 @@
+#include "../stdafx.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include "wrapper/pki/key_cache.h"
+
+struct KeyCacheEntry{
+	std::string id;
+	unsigned char key[KEY_CACHE_MAX_KEY_LEN];
+	size_t keyLen;
+};
+
+/* Front of the list is the most recently used key */
+static std::mutex keyCacheLock;
+static std::list<KeyCacheEntry> keyCacheList;
+static std::map<std::string, std::list<KeyCacheEntry>::iterator> keyCacheIndex;
+static size_t keyCacheCapacity = KEY_CACHE_CAPACITY;
+static unsigned long long keyCacheHits = 0;
+static unsigned long long keyCacheMisses = 0;
+
+static unsigned char keyCacheSecret[32];
+static bool keyCacheSecretReady = false;
+
+/* Must be called under keyCacheLock */
+static void keyCacheEvict(size_t capacity){
+	while (keyCacheList.size() > capacity){
+		KeyCacheEntry &entry = keyCacheList.back();
+		OPENSSL_cleanse(entry.key, sizeof entry.key);
+		keyCacheIndex.erase(entry.id);
+		keyCacheList.pop_back();
+	}
+}
+
+void KeyCache::makeId(const char *pass, const unsigned char *params, size_t paramsLen, unsigned char *id){
+	LOGGER_FN();
+
+	{
+		std::lock_guard<std::mutex> lock(keyCacheLock);
+		if (!keyCacheSecretReady){
+			LOGGER_OPENSSL(RAND_bytes);
+			if (RAND_bytes(keyCacheSecret, sizeof keyCacheSecret) <= 0){
+				THROW_OPENSSL_EXCEPTION(0, KeyCache, NULL, "RAND_bytes");
+			}
+			keyCacheSecretReady = true;
+		}
+	}
+
+	std::string data((const char *)params, paramsLen);
+	data.append(pass);
+
+	unsigned int len = KEY_CACHE_ID_LEN;
+	LOGGER_OPENSSL(HMAC);
+	unsigned char *res = HMAC(EVP_sha256(), keyCacheSecret, sizeof keyCacheSecret,
+		(const unsigned char *)data.data(), data.length(), id, &len);
+	OPENSSL_cleanse(&data[0], data.length());
+	if (!res){
+		THROW_OPENSSL_EXCEPTION(0, KeyCache, NULL, "HMAC");
+	}
+}
+
+bool KeyCache::get(const unsigned char *id, unsigned char *key, size_t keyLen){
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(keyCacheLock);
+
+	std::map<std::string, std::list<KeyCacheEntry>::iterator>::iterator it =
+		keyCacheIndex.find(std::string((const char *)id, KEY_CACHE_ID_LEN));
+	if (it == keyCacheIndex.end() || it->second->keyLen != keyLen){
+		keyCacheMisses++;
+		return false;
+	}
+
+	keyCacheList.splice(keyCacheList.begin(), keyCacheList, it->second);
+	memcpy(key, it->second->key, keyLen);
+	keyCacheHits++;
+	return true;
+}
+
+void KeyCache::put(const unsigned char *id, const unsigned char *key, size_t keyLen){
+	LOGGER_FN();
+
+	if (keyLen > KEY_CACHE_MAX_KEY_LEN){
+		THROW_EXCEPTION(0, KeyCache, NULL, "Key is too long");
+	}
+
+	std::lock_guard<std::mutex> lock(keyCacheLock);
+	if (!keyCacheCapacity){
+		return;
+	}
+
+	std::string name((const char *)id, KEY_CACHE_ID_LEN);
+	std::map<std::string, std::list<KeyCacheEntry>::iterator>::iterator it = keyCacheIndex.find(name);
+	if (it != keyCacheIndex.end()){
+		/* Derived by two threads at once */
+		keyCacheList.splice(keyCacheList.begin(), keyCacheList, it->second);
+		return;
+	}
+
+	keyCacheList.push_front(KeyCacheEntry());
+	KeyCacheEntry &entry = keyCacheList.front();
+	entry.id = name;
+	memcpy(entry.key, key, keyLen);
+	entry.keyLen = keyLen;
+	keyCacheIndex[name] = keyCacheList.begin();
+
+	keyCacheEvict(keyCacheCapacity);
+}
+
+void KeyCache::setCapacity(size_t capacity){
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(keyCacheLock);
+	keyCacheCapacity = capacity;
+	keyCacheEvict(capacity);
+}
+
+void KeyCache::clear(){
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(keyCacheLock);
+	keyCacheEvict(0);
+}
+
+KeyCache::Stats KeyCache::stats(){
+	std::lock_guard<std::mutex> lock(keyCacheLock);
+
+	Stats res;
+	res.hits = keyCacheHits;
+	res.misses = keyCacheMisses;
+	res.size = keyCacheList.size();
+	res.capacity = keyCacheCapacity;
+	return res;
+}
@@ -0,0 +1,180 @@
+#include "../stdafx.h"
+
+#include "wrapper/pki/key_pool.h"
+
+KeyPool::KeyPool(ThreadPool *threads)
+	: threads_(threads), stopping_(false), running_(0)
+{
+	LOGGER_FN();
+
+	this->stats_.hits = 0;
+	this->stats_.misses = 0;
+	this->stats_.generated = 0;
+	this->stats_.failures = 0;
+	this->stats_.ready = 0;
+}
+
+/* Waits for the scheduled generations, they reference the pool */
+KeyPool::~KeyPool(){
+	LOGGER_FN();
+
+	std::unique_lock<std::mutex> lock(this->lock_);
+	this->stopping_ = true;
+	while (this->running_){
+		this->idle_.wait(lock);
+	}
+}
+
+std::string KeyPool::profileName(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt){
+	std::string res = *algorithm;
+	for (size_t i = 0; i < pkeyopt.size(); i++){
+		res += '\n';
+		res += pkeyopt[i];
+	}
+	return res;
+}
+
+Handle<Key> KeyPool::generate(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt){
+	LOGGER_FN();
+
+	Handle<Key> key = new Key();
+	return key->generate(algorithm, pkeyopt);
+}
+
+void KeyPool::reserve(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt, size_t count){
+	LOGGER_FN();
+
+	if (algorithm.isEmpty() || !algorithm->length()) {
+		THROW_EXCEPTION(0, KeyPool, NULL, "Parameter algorithm empty");
+	}
+
+	std::string name = KeyPool::profileName(algorithm, pkeyopt);
+
+	std::lock_guard<std::mutex> lock(this->lock_);
+	std::map<std::string, Profile>::iterator it = this->profiles_.find(name);
+	if (it == this->profiles_.end()){
+		if (!count){
+			return;
+		}
+		Profile &profile = this->profiles_[name];
+		profile.algorithm = new std::string(*algorithm);
+		profile.pkeyopt = pkeyopt;
+		profile.size = 0;
+		profile.scheduled = 0;
+		it = this->profiles_.find(name);
+	}
+
+	Profile &profile = it->second;
+	profile.size = count;
+	while (profile.keys.size() > count){
+		profile.keys.pop_back();
+		this->stats_.ready--;
+	}
+
+	if (!count && !profile.scheduled){
+		this->profiles_.erase(it);
+		return;
+	}
+
+	this->refill(name, profile);
+}
+
+Handle<Key> KeyPool::take(Handle<std::string> algorithm, const std::vector<std::string> &pkeyopt){
+	LOGGER_FN();
+
+	if (algorithm.isEmpty() || !algorithm->length()) {
+		THROW_EXCEPTION(0, KeyPool, NULL, "Parameter algorithm empty");
+	}
+
+	std::string name = KeyPool::profileName(algorithm, pkeyopt);
+	{
+		std::lock_guard<std::mutex> lock(this->lock_);
+		std::map<std::string, Profile>::iterator it = this->profiles_.find(name);
+		if (it != this->profiles_.end() && !it->second.keys.empty()){
+			Handle<Key> res = it->second.keys.front();
+			it->second.keys.pop_front();
+			this->stats_.hits++;
+			this->stats_.ready--;
+			this->refill(name, it->second);
+			return res;
+		}
+		this->stats_.misses++;
+		if (it != this->profiles_.end()){
+			this->refill(name, it->second);
+		}
+	}
+
+	LOGGER_INFO("Pool is empty, generate key");
+	return KeyPool::generate(algorithm, pkeyopt);
+}
+
+KeyPool::Stats KeyPool::stats(){
+	std::lock_guard<std::mutex> lock(this->lock_);
+	return this->stats_;
+}
+
+void KeyPool::refill(const std::string &name, Profile &profile){
+	while (!this->stopping_ && profile.keys.size() + profile.scheduled < profile.size){
+		profile.scheduled++;
+		this->running_++;
+		try{
+			this->threads_->push(std::bind(&KeyPool::fill, this, name), ThreadPool::Low);
+		}
+		catch (Handle<Exception> &e){
+			/* Full queue of background jobs, refill on the next take */
+			LOGGER_ERROR("Key generation is not scheduled: %s", e->what());
+			profile.scheduled--;
+			this->running_--;
+			return;
+		}
+	}
+}
+
+/* Called on the pool thread */
+void KeyPool::fill(const std::string &name){
+	LOGGER_FN();
+
+	Handle<std::string> algorithm;
+	std::vector<std::string> pkeyopt;
+	{
+		std::lock_guard<std::mutex> lock(this->lock_);
+		std::map<std::string, Profile>::iterator it = this->profiles_.find(name);
+		if (!this->stopping_ && it != this->profiles_.end() && it->second.size){
+			algorithm = it->second.algorithm;
+			pkeyopt = it->second.pkeyopt;
+		}
+	}
+
+	Handle<Key> key;
+	if (!algorithm.isEmpty()){
+		try{
+			key = KeyPool::generate(algorithm, pkeyopt);
+		}
+		catch (Handle<Exception> &e){
+			LOGGER_ERROR("Key generation failed: %s", e->what());
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(this->lock_);
+	std::map<std::string, Profile>::iterator it = this->profiles_.find(name);
+	if (it != this->profiles_.end()){
+		Profile &profile = it->second;
+		profile.scheduled--;
+		if (key.isEmpty()){
+			if (!algorithm.isEmpty()){
+				this->stats_.failures++;
+			}
+		}
+		else if (profile.keys.size() < profile.size){
+			profile.keys.push_back(key);
+			this->stats_.generated++;
+			this->stats_.ready++;
+		}
+		if (!profile.size && !profile.scheduled){
+			this->profiles_.erase(it);
+		}
+	}
+
+	this->running_--;
+	this->idle_.notify_all();
+}
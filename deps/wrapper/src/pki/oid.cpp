@@ -5,7 +5,7 @@
 #include "wrapper/pki/oid.h"
 
 OID::OID(const std::string& val)
-	: SSLObject<ASN1_OBJECT>(ASN1_OBJECT_new(), &so_ASN1_OBJECT_free)
+	: SSLObject<ASN1_OBJECT>(ASN1_OBJECT_new())
 {
 	LOGGER_FN();
 
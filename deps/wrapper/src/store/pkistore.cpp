@@ -26,7 +26,7 @@ PkiStore::PkiStore(Handle<std::string> json){
 	}
 }
 
-Handle<PkiItemCollection> PkiStore::find(Handle<Filter> filter){
+Handle<PkiItemCollection> PkiStore::find(const Handle<Filter> &filter){
 	LOGGER_FN();
 
 	try{
@@ -41,7 +41,7 @@ Handle<PkiItemCollection> PkiStore::find(Handle<Filter> filter){
 	}
 }
 
-Handle<PkiItem> PkiStore::findKey(Handle<Filter> filter){
+Handle<PkiItem> PkiStore::findKey(const Handle<Filter> &filter){
 	LOGGER_FN();
 
 	try{
@@ -307,6 +307,10 @@ Handle<CertificateCollection> PkiStore::getCerts(){
 void PkiStore::addProvider(Handle<Provider> provider) {
 	LOGGER_FN();
 
+	if (provider.isEmpty()){
+		THROW_EXCEPTION(0, PkiStore, NULL, "Provider is not loaded");
+	}
+
 	providers->push(provider);
 
 	Handle<PkiItemCollection> tempColl = provider->getProviderItemCollection();
@@ -1,6 +1,7 @@
 #include "../stdafx.h"
 
 #include "wrapper/store/provider_system.h"
+#include "wrapper/common/thread_pool.h"
 
 Provider_System::Provider_System(Handle<std::string> folder){
 	LOGGER_FN();
@@ -56,6 +57,10 @@ void Provider_System::init(Handle<std::string> folder){
 			continue;
 		}
 		while ((ent = readdir(dir)) != NULL) {
+			/* Scan on the pool thread stops between files when it is cancelled */
+			if (ThreadPool::cancelled())
+				break;
+
 			const std::string file_name = ent->d_name;
 			const std::string uri = dirInCertStore + CROSSPLATFORM_SLASH +   file_name;
 
@@ -81,6 +86,8 @@ void Provider_System::init(Handle<std::string> folder){
 			BIO_free(bioFile);
 		}
 		closedir(dir);
+
+		ThreadPool::checkCancelled();
 	}
 #endif
 #if defined(OPENSSL_SYS_WINDOWS) 
@@ -123,6 +130,9 @@ void Provider_System::init(Handle<std::string> folder){
 				std::string uri = dirInCertStore + CROSSPLATFORM_SLASH + std::string(file_name.begin(), file_name.end());
 				const bool is_directory = (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
 
+				if (ThreadPool::cancelled())
+					break;
+
 				if (file_name[0] == '.')
 					continue;
 
@@ -145,6 +155,8 @@ void Provider_System::init(Handle<std::string> folder){
 			} while (FindNextFile(dir, &file_data));
 
 			FindClose(dir);
+
+			ThreadPool::checkCancelled();
 		}
 	}
 	catch (Handle<Exception> &e){
@@ -408,7 +420,10 @@ Handle<Certificate> Provider_System::getCertFromURI(Handle<std::string> uri, Han
 		LOGGER_OPENSSL(BIO_read_filename);
 		if (BIO_read_filename(bioFile, uri->c_str()) > 0){
 			LOGGER_OPENSSL(BIO_seek);
-			BIO_seek(bioFile, 0);
+			if (BIO_seek(bioFile, 0) < 0){
+				BIO_free(bioFile);
+				THROW_OPENSSL_EXCEPTION(0, Provider_System, NULL, "BIO_seek");
+			}
 
 			if (strcmp(format->c_str(), "PEM") == 0){
 				LOGGER_OPENSSL(PEM_read_bio_X509);
@@ -450,7 +465,10 @@ Handle<CRL> Provider_System::getCRLFromURI(Handle<std::string> uri, Handle<std::
 		LOGGER_OPENSSL(BIO_read_filename);
 		if (BIO_read_filename(bioFile, uri->c_str()) > 0){
 			LOGGER_OPENSSL(BIO_seek);
-			BIO_seek(bioFile, 0);
+			if (BIO_seek(bioFile, 0) < 0){
+				BIO_free(bioFile);
+				THROW_OPENSSL_EXCEPTION(0, Provider_System, NULL, "BIO_seek");
+			}
 
 			if (strcmp(format->c_str(), "PEM") == 0){
 				LOGGER_OPENSSL(PEM_read_bio_X509_CRL);
@@ -491,7 +509,10 @@ Handle<CertificationRequest> Provider_System::getCSRFromURI(Handle<std::string>
 		LOGGER_OPENSSL(BIO_read_filename);
 		if (BIO_read_filename(bioFile, uri->c_str()) > 0){
 			LOGGER_OPENSSL(BIO_seek);
-			BIO_seek(bioFile, 0);
+			if (BIO_seek(bioFile, 0) < 0){
+				BIO_free(bioFile);
+				THROW_OPENSSL_EXCEPTION(0, Provider_System, NULL, "BIO_seek");
+			}
 
 			if (strcmp(format->c_str(), "PEM") == 0){
 				LOGGER_OPENSSL(PEM_read_bio_X509_REQ);
@@ -536,7 +557,10 @@ Handle<Key> Provider_System::getKeyFromURI(Handle<std::string> uri, Handle<std::
 		LOGGER_OPENSSL(BIO_read_filename);
 		if (BIO_read_filename(bioFile, uri->c_str()) > 0){
 			LOGGER_OPENSSL(BIO_seek);
-			BIO_seek(bioFile, 0);
+			if (BIO_seek(bioFile, 0) < 0){
+				BIO_free(bioFile);
+				THROW_OPENSSL_EXCEPTION(0, Provider_System, NULL, "BIO_seek");
+			}
 
 			if (strcmp(format->c_str(), "PEM") == 0){
 				LOGGER_OPENSSL(PEM_read_bio_PrivateKey);
@@ -246,31 +246,32 @@ int PkiItemCollection::length(){
 	return _items.size();
 }
 
-void PkiItemCollection::push(Handle<PkiItem> v){
+void PkiItemCollection::push(const Handle<PkiItem> &v){
 	LOGGER_FN();
 
 	_items.push_back((*v.operator->()));
 }
 
-void PkiItemCollection::push(PkiItem &v){
+void PkiItemCollection::push(const PkiItem &v){
 	LOGGER_FN();
 
 	_items.push_back(v);
 }
 
-Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
+Handle<PkiItemCollection> PkiItemCollection::find(const Handle<Filter> &filter) {
 	LOGGER_FN();
 
 	try{
 		Handle<PkiItemCollection> filteredItems = new PkiItemCollection();
 
 		for (int i = 0, c = this->length(); i < c; i++){
+			const PkiItem &item = this->_items[i];
 			bool result = 1;
 
 			if (filter->types.size() > 0){
 				result = 0;
 				for (int j = 0; j < filter->types.size(); j++){
-					if (strcmp(this->items(i)->type->c_str(), filter->types[j]->c_str()) == 0){
+					if (strcmp(item.type->c_str(), filter->types[j]->c_str()) == 0){
 						result = 1;
 						break;
 					}
@@ -283,7 +284,7 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			if (filter->providers.size() > 0){
 				result = 0;
 				for (int j = 0; j < filter->providers.size(); j++){
-					if (strcmp(this->items(i)->provider->c_str(), filter->providers[j]->c_str()) == 0){
+					if (strcmp(item.provider->c_str(), filter->providers[j]->c_str()) == 0){
 						result = 1;
 						break;
 					}
@@ -296,7 +297,7 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			if (filter->categorys.size() > 0){
 				result = 0;
 				for (int j = 0; j < filter->categorys.size(); j++){
-					if (strcmp(this->items(i)->category->c_str(), filter->categorys[j]->c_str()) == 0){
+					if (strcmp(item.category->c_str(), filter->categorys[j]->c_str()) == 0){
 						result = 1;
 						break;
 					}
@@ -307,7 +308,7 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			}
 
 			if (!(filter->hash.isEmpty())){
-				if (strcmp(this->items(i)->hash->c_str(), filter->hash->c_str()) == 0){
+				if (strcmp(item.hash->c_str(), filter->hash->c_str()) == 0){
 					result = 1;
 				}
 				else{
@@ -317,8 +318,8 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			}
 
 			if (!(filter->subjectName.isEmpty())){
-				if ((strcmp(this->items(i)->certSubjectName->c_str(), filter->subjectName->c_str()) == 0) ||
-					(strcmp(this->items(i)->csrSubjectName->c_str(), filter->subjectName->c_str()) == 0)){
+				if ((strcmp(item.certSubjectName->c_str(), filter->subjectName->c_str()) == 0) ||
+					(strcmp(item.csrSubjectName->c_str(), filter->subjectName->c_str()) == 0)){
 					result = 1;
 				}
 				else{
@@ -328,8 +329,8 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			}
 
 			if (!(filter->subjectFriendlyName.isEmpty())){
-				if ((strcmp(this->items(i)->certSubjectFriendlyName->c_str(), filter->subjectFriendlyName->c_str()) == 0) ||
-					(strcmp(this->items(i)->csrSubjectFriendlyName->c_str(), filter->subjectFriendlyName->c_str()) == 0)){
+				if ((strcmp(item.certSubjectFriendlyName->c_str(), filter->subjectFriendlyName->c_str()) == 0) ||
+					(strcmp(item.csrSubjectFriendlyName->c_str(), filter->subjectFriendlyName->c_str()) == 0)){
 					result = 1;
 				}
 				else{
@@ -339,8 +340,8 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			}
 
 			if (!(filter->issuerName.isEmpty())){
-				if ((strcmp(this->items(i)->certIssuerName->c_str(), filter->issuerName->c_str()) == 0) ||
-					(strcmp(this->items(i)->crlIssuerName->c_str(), filter->issuerName->c_str()) == 0)){
+				if ((strcmp(item.certIssuerName->c_str(), filter->issuerName->c_str()) == 0) ||
+					(strcmp(item.crlIssuerName->c_str(), filter->issuerName->c_str()) == 0)){
 					result = 1;
 				}
 				else{
@@ -350,8 +351,8 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			}
 
 			if (!(filter->issuerFriendlyName.isEmpty())){
-				if ((strcmp(this->items(i)->certIssuerFriendlyName->c_str(), filter->issuerFriendlyName->c_str()) == 0) ||
-					(strcmp(this->items(i)->crlIssuerFriendlyName->c_str(), filter->issuerFriendlyName->c_str()) == 0)){
+				if ((strcmp(item.certIssuerFriendlyName->c_str(), filter->issuerFriendlyName->c_str()) == 0) ||
+					(strcmp(item.crlIssuerFriendlyName->c_str(), filter->issuerFriendlyName->c_str()) == 0)){
 					result = 1;
 				}
 				else{
@@ -361,7 +362,7 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 			}
 
 			if (!(filter->serial.isEmpty())){
-				if (strcmp(this->items(i)->certSerial->c_str(), filter->serial->c_str()) == 0){
+				if (strcmp(item.certSerial->c_str(), filter->serial->c_str()) == 0){
 					result = 1;
 				}
 				else{
@@ -370,7 +371,7 @@ Handle<PkiItemCollection> PkiItemCollection::find(Handle<Filter> filter) {
 				}
 			}
 
-			filteredItems->push(this->items(i));
+			filteredItems->push(item);
 		}
 
 		return filteredItems;
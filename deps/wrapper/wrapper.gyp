@@ -3,17 +3,26 @@
         {
             "target_name": "wrapper",
             "type": "static_library",
+            "variables": {
+                "wrapper_no_logger%": 0,
+                "wrapper_atomic_refcount%": 1,
+                "wrapper_no_pool%": 0
+            },
             "include_dirs": ["include", "jsoncpp"],
             "sources": [
                 "src/stdafx.cpp",
                 "src/utils/jwt.cpp",
                 "src/utils/csp.cpp",
                 "src/common/bio.cpp",
+                "src/common/buffer_pool.cpp",
                 "src/common/common.cpp",
                 "src/common/excep.cpp",
                 "src/common/log.cpp",
+                "src/common/mmap.cpp",
                 "src/common/openssl.cpp",
+                "src/common/pool.cpp",
                 "src/common/prov.cpp",
+                "src/common/thread_pool.cpp",
                 "src/pki/crl.cpp",
                 "src/pki/crls.cpp",
                 "src/pki/revoked.cpp",
@@ -21,9 +30,14 @@
                 "src/pki/cert.cpp",
                 "src/pki/certs.cpp",
                 "src/pki/key.cpp",
+                "src/pki/key_pool.cpp",
+                "src/pki/key_cache.cpp",
                 "src/pki/cert_request_info.cpp",
                 "src/pki/cert_request.cpp",
                 "src/pki/cipher.cpp",
+                "src/pki/cipher_aead.cpp",
+                "src/pki/cipher_segments.cpp",
+                "src/pki/cipher_session.cpp",
                 "src/pki/chain.cpp",
                 "src/pki/pkcs12.cpp",
                 "src/pki/revocation.cpp",
@@ -46,6 +60,7 @@
                 "src/cms/signed_data.cpp",
                 "src/cms/cmsRecipientInfo.cpp",
                 "src/cms/cmsRecipientInfos.cpp",
+                "src/cms/enveloped_reader.cpp",
                 "jsoncpp/jsoncpp.cpp"
             ],
             "xcode_settings": {
@@ -59,6 +74,33 @@
                 "MACOSX_DEPLOYMENT_TARGET": "10.7"
             },
             "conditions": [
+                [
+                    "wrapper_no_logger==1",
+                    {
+                        "defines": ["WRAPPER_NO_LOGGER"],
+                        "direct_dependent_settings": {
+                            "defines": ["WRAPPER_NO_LOGGER"]
+                        }
+                    }
+                ],
+                [
+                    "wrapper_atomic_refcount==1",
+                    {
+                        "defines": ["WRAPPER_ATOMIC_REFCOUNT"],
+                        "direct_dependent_settings": {
+                            "defines": ["WRAPPER_ATOMIC_REFCOUNT"]
+                        }
+                    }
+                ],
+                [
+                    "wrapper_no_pool==1",
+                    {
+                        "defines": ["WRAPPER_NO_POOL"],
+                        "direct_dependent_settings": {
+                            "defines": ["WRAPPER_NO_POOL"]
+                        }
+                    }
+                ],
                 [
                     "OS=='win'",
                     {
@@ -54,6 +54,7 @@ declare namespace native {
     namespace PKI {
         class Key {
             generate(algorithm: string, pkeyopts?: string[]): Key;
+            generateAsync(algorithm: string, pkeyopts: string[], done: (err: Error, key: Key) => void): number;
             readPrivateKey(filename: string, format: trusted.DataFormat, password: string): any;
             readPublicKey(filename: string, format: trusted.DataFormat): any;
             writePrivateKey(filename: string, format: trusted.DataFormat, password: string): any;
@@ -61,6 +62,29 @@ declare namespace native {
             compare(key: Key): number;
             duplicate(): Key;
         }
+        interface IKeyPoolStats {
+            hits: number;
+            misses: number;
+            generated: number;
+            failures: number;
+            ready: number;
+        }
+        class KeyPool {
+            reserve(algorithm: string, pkeyopts: string[], count: number): void;
+            take(algorithm: string, pkeyopts?: string[]): Key;
+            getStats(): IKeyPoolStats;
+        }
+        interface IKeyCacheStats {
+            hits: number;
+            misses: number;
+            size: number;
+            capacity: number;
+        }
+        class KeyCache {
+            setCapacity(capacity: number): void;
+            clear(): void;
+            getStats(): IKeyCacheStats;
+        }
         class Algorithm {
             constructor(name?: string);
             getTypeId(): OID;
@@ -105,6 +129,31 @@ declare namespace native {
             pop(): void;
             removeAt(index: number): void;
         }
+        /**
+         * Properties of certificate read by one native call.
+         * Dates are in the format of getNotBefore(), thumbprint is hex
+         */
+        interface ICertificateInfo {
+            version: number;
+            subjectFriendlyName: string;
+            issuerFriendlyName: string;
+            subjectName: string;
+            issuerName: string;
+            notBefore: string;
+            notAfter: string;
+            serialNumber: string;
+            thumbprint: string;
+            type: number;
+            keyUsage: number;
+            signatureAlgorithm: string;
+            signatureDigestAlgorithm: string;
+            publicKeyAlgorithm: string;
+            organizationName: string;
+            OCSPUrls: string[];
+            CAIssuersUrls: string[];
+            isSelfSigned: boolean;
+            isCA: boolean;
+        }
         class Certificate {
             constructor(param?: PKI.Certificate | PKI.CertificationRequest);
             getSubjectFriendlyName(): string;
@@ -134,6 +183,7 @@ declare namespace native {
             setExtensions(exts: ExtensionCollection): void;
             isSelfSigned(): boolean;
             isCA(): boolean;
+            getInfo(): ICertificateInfo;
             sign(key: Key, digest?: string): void;
             load(filename: string, dataFormat?: trusted.DataFormat): void;
             import(raw: Buffer, dataFormat: trusted.DataFormat): void;
@@ -164,6 +214,18 @@ declare namespace native {
             pop(): void;
             removeAt(index: number): void;
         }
+        interface ICrlInfo {
+            version: number;
+            issuerName: string;
+            issuerFriendlyName: string;
+            lastUpdate: string;
+            nextUpdate: string;
+            thumbprint: string;
+            signatureAlgorithm: string;
+            signatureDigestAlgorithm: string;
+            authorityKeyid: string;
+            crlNumber: string;
+        }
         class CRL {
             getEncoded(): Buffer;
             getSignature(): Buffer;
@@ -179,6 +241,7 @@ declare namespace native {
             getAuthorityKeyid(): string;
             getCrlNumber(): string;
             getRevoked(): RevokedCollection;
+            getInfo(): ICrlInfo;
             load(filename: string, dataFormat: trusted.DataFormat): void;
             import(raw: Buffer, dataFormat: trusted.DataFormat): void;
             save(filename: string, dataFormat: trusted.DataFormat): void;
@@ -235,11 +298,25 @@ declare namespace native {
             save(filename: string, dataFormat: trusted.DataFormat): void;
             getEncodedHEX(): Buffer;
         }
+        class CipherStream {
+            update(chunk: Buffer): Buffer;
+            updateAsync(chunk: Buffer, done: (err: Error, res: Buffer) => void): number;
+            final(): Buffer;
+        }
+        class CipherSession {
+            encrypt(message: Buffer): Buffer;
+            decrypt(message: Buffer): Buffer;
+        }
         class Cipher {
             constructor();
             setCryptoMethod(method: trusted.CryptoMethod): void;
             encrypt(filenameSource: string, filenameEnc: string, format: trusted.DataFormat): void;
             decrypt(filenameEnc: string, filenameDec: string, format?: trusted.DataFormat): void;
+            encryptAsync(data: string | Buffer, format: trusted.DataFormat, done: (err: Error, res: Buffer) => void): number;
+            decryptAsync(data: string | Buffer, format: trusted.DataFormat, done: (err: Error, res: Buffer) => void): number;
+            createStream(encrypt: boolean): CipherStream;
+            decryptRange(data: string | Buffer, offset: number, length: number): Buffer;
+            createSession(): CipherSession;
             addRecipientsCerts(certs: CertificateCollection): void;
             setPrivKey(rkey: Key): void;
             setRecipientCert(rcert: Certificate): void;
@@ -247,10 +324,17 @@ declare namespace native {
             setDigest(digest: string): void;
             setIV(iv: string): void;
             setKey(key: string): void;
+            setAead(name: string): void;
+            setSegmentSize(size: number): void;
+            setThreads(threads: number): void;
+            setBufferSize(size: number): void;
+            setKdf(name: string, cost?: number): void;
             setSalt(salt: string): void;
             getSalt(): Buffer;
             getIV(): Buffer;
             getKey(): Buffer;
+            getAead(): string;
+            getKdf(): string;
             getAlgorithm(): string;
             getMode(): string;
             getDigestAlgorithm(): string;
@@ -294,6 +378,9 @@ declare namespace native {
             addCertificate(cert: PKI.Certificate): void;
             verify(certs?: PKI.CertificateCollection): boolean;
             sign(): void;
+            loadAsync(filename: string, dataFormat: trusted.DataFormat, done: (err: Error) => void): number;
+            verifyAsync(certs: PKI.CertificateCollection, done: (err: Error, res: boolean) => void): number;
+            signAsync(done: (err: Error) => void): number;
         }
         class SignerCollection {
             items(index: number): Signer;
@@ -408,7 +495,8 @@ declare namespace native {
             type: string;
         }
         class Provider_System extends Provider {
-            constructor(folder: string);
+            constructor(folder?: string);
+            loadAsync(folder: string, done: (err: Error) => void): number;
             objectToPkiItem(pathr: string): IPkiItem;
         }
         class ProviderMicrosoft extends Provider {
@@ -497,6 +585,7 @@ declare namespace native {
             setSignatureAlgorithm(signatureAlgorithm: string): void;
             setSignatureDigestAlgorithm(signatureDigestAlgorithm: string): void;
             setPublicKeyAlgorithm(publicKeyAlgorithm: string): void;
+            getInfo(): IPkiItem;
         }
     }
     namespace UTILS {
@@ -520,9 +609,46 @@ declare namespace native {
             verify(modulePath: string, cacerts?: PKI.CertificateCollection): object;
         }
         class Logger {
-            start(filename: string, level: trusted.LoggerLevel): void;
+            start(filename: string, level: trusted.LoggerLevel, async?: boolean): void;
             stop(): void;
             clear(): void;
+            getDropped(): number;
+        }
+        interface IObjectPoolStats {
+            allocations: number;
+            releases: number;
+            live: number;
+            slabs: number;
+            slabBytes: number;
+            large: number;
+        }
+        interface IOpenSSLMemoryStats {
+            installed: boolean;
+            allocations: number;
+            releases: number;
+            liveBytes: number;
+            allocatedBytes: number;
+        }
+        class ObjectPool {
+            getStats(): IObjectPoolStats;
+            getOpenSSLStats(): IOpenSSLMemoryStats;
+        }
+        interface IThreadPoolStats {
+            size: number;
+            running: number;
+            pending: number[];
+            limits: number[];
+            completed: number;
+            rejected: number;
+            removed: number;
+        }
+        class ThreadPool {
+            getStats(): IThreadPoolStats;
+            resize(size: number): void;
+            setLimit(priority: trusted.utils.ThreadPriority, limit: number): void;
+            setPriority(priority: number): void;
+            getLastJob(): number;
+            cancel(id: number): boolean;
         }
         class Csp {
             isGost2001CSPAvailable(): boolean;
@@ -565,6 +691,18 @@ declare namespace trusted {
         static wrap<TIn, TOut extends IBaseObject>(obj: TIn): TOut;
         handle: T;
     }
+    type AsyncCallback<T> = (err: Error, res?: T) => void;
+    /**
+     * Run native async method. Result is passed to done or,
+     * if done is not set, to the returned Promise
+     *
+     * @export
+     * @template T
+     * @param {(cb: AsyncCallback<T>) => void} fn Calls native method with callback
+     * @param {AsyncCallback<T>} [done]
+     * @returns {Promise<T>} undefined if done is set
+     */
+    function callAsync<T>(fn: (cb: AsyncCallback<T>) => void, done?: AsyncCallback<T>): Promise<T>;
 }
 declare namespace trusted.core {
     interface ICollection {
@@ -805,11 +943,12 @@ declare namespace trusted.utils {
          * @static
          * @param {string} filename
          * @param {LoggerLevel} [level=DEFAULT_LOGGER_LEVEL]
+         * @param {boolean} [async=false] Write records from the background thread
          * @returns {Logger}
          *
          * @memberOf Logger
          */
-        static start(filename: string, level?: LoggerLevel): Logger;
+        static start(filename: string, level?: LoggerLevel, async?: boolean): Logger;
         /**
          * Creates an instance of Logger.
          *
@@ -821,11 +960,20 @@ declare namespace trusted.utils {
          *
          * @param {string} filename
          * @param {LoggerLevel} [level=DEFAULT_LOGGER_LEVEL]
+         * @param {boolean} [async=false] Write records from the background thread
          * @returns {void}
          *
          * @memberOf Logger
          */
-        start(filename: string, level?: LoggerLevel): void;
+        start(filename: string, level?: LoggerLevel, async?: boolean): void;
+        /**
+         * Count of records dropped by the asynchronous logger because its queue was full
+         *
+         * @readonly
+         * @type {number}
+         * @memberOf Logger
+         */
+        readonly dropped: number;
         /**
          * Stop write log file
          *
@@ -1109,6 +1257,145 @@ declare namespace trusted.utils {
         constructor();
     }
 }
+declare namespace trusted.utils {
+    /**
+     * Statistics of the native allocator of wrapper objects
+     *
+     * @export
+     * @class ObjectPool
+     * @extends {BaseObject<native.UTILS.ObjectPool>}
+     */
+    class ObjectPool extends BaseObject<native.UTILS.ObjectPool> {
+        /**
+         * Return allocator counters
+         *
+         * @static
+         * @returns {native.UTILS.IObjectPoolStats}
+         * @memberof ObjectPool
+         */
+        static getStats(): native.UTILS.IObjectPoolStats;
+        /**
+         * Return counters of OpenSSL allocations.
+         * Allocation rate is the difference of allocatedBytes between two calls
+         *
+         * @static
+         * @returns {native.UTILS.IOpenSSLMemoryStats}
+         * @memberof ObjectPool
+         */
+        static getOpenSSLStats(): native.UTILS.IOpenSSLMemoryStats;
+        /**
+         * Creates an instance of ObjectPool.
+         *
+         * @memberof ObjectPool
+         */
+        constructor();
+        /**
+         * Allocator counters
+         *
+         * @readonly
+         * @type {native.UTILS.IObjectPoolStats}
+         * @memberof ObjectPool
+         */
+        readonly stats: native.UTILS.IObjectPoolStats;
+        /**
+         * Counters of OpenSSL allocations
+         *
+         * @readonly
+         * @type {native.UTILS.IOpenSSLMemoryStats}
+         * @memberof ObjectPool
+         */
+        readonly openssl: native.UTILS.IOpenSSLMemoryStats;
+    }
+}
+declare namespace trusted.utils {
+    /**
+     * Priority of the native thread pool queue
+     *
+     * @export
+     * @enum {number}
+     */
+    enum ThreadPriority {
+        /** Interactive operations */
+        HIGH = 0,
+        NORMAL = 1,
+        /** Bulk and background jobs (Cipher, store scan, key pool) */
+        LOW = 2,
+    }
+    /**
+     * Job queued to the native thread pool
+     *
+     * @export
+     * @interface IThreadPoolJob
+     * @template T
+     */
+    interface IThreadPoolJob<T> {
+        /** Job id for ThreadPool.cancel(), 0 if nothing is queued */
+        id: number;
+        result: T;
+    }
+    /**
+     * Native thread pool of async methods (sign, verify, encrypt, key generation, store scan).
+     * Queue of lower priority runs only when queues of higher priorities are empty.
+     * Async method throws if its queue is full.
+     *
+     * @export
+     * @class ThreadPool
+     * @extends {BaseObject<native.UTILS.ThreadPool>}
+     */
+    class ThreadPool extends BaseObject<native.UTILS.ThreadPool> {
+        /**
+         * Return pool counters. pending and limits are indexed by ThreadPriority
+         *
+         * @static
+         * @returns {native.UTILS.IThreadPoolStats}
+         * @memberof ThreadPool
+         */
+        static getStats(): native.UTILS.IThreadPoolStats;
+        /**
+         * Set count of threads. Pool is shared by all JS threads of the process
+         *
+         * @static
+         * @param {number} size 0 - count of hardware threads
+         * @memberof ThreadPool
+         */
+        static resize(size: number): void;
+        /**
+         * Limit count of pending jobs of the priority
+         *
+         * @static
+         * @param {ThreadPriority} priority
+         * @param {number} limit 0 - unlimited
+         * @memberof ThreadPool
+         */
+        static setLimit(priority: ThreadPriority, limit: number): void;
+        /**
+         * Call async method with the priority and return id of its job
+         *
+         * @example
+         * const job = ThreadPool.schedule(() => cipher.encryptAsync(file), ThreadPriority.LOW);
+         * ThreadPool.cancel(job.id);
+         * job.result.catch((err) => console.log(err.message)); // Operation cancelled
+         *
+         * @static
+         * @template T
+         * @param {() => T} fn Calls async method
+         * @param {ThreadPriority} [priority] default is own priority of the method
+         * @returns {IThreadPoolJob<T>}
+         * @memberof ThreadPool
+         */
+        static schedule<T>(fn: () => T, priority?: ThreadPriority): IThreadPoolJob<T>;
+        /**
+         * Cancel job queued from this JS thread. Not started job is completed
+         * with "Operation cancelled" error, running one stops on its next check
+         *
+         * @static
+         * @param {number} id
+         * @returns {boolean} false if the job is already completed
+         * @memberof ThreadPool
+         */
+        static cancel(id: number): boolean;
+    }
+}
 declare namespace trusted.pki {
     /**
      * Key usage flags
@@ -1176,6 +1463,17 @@ declare namespace trusted.pki {
          * @memberof Key
          */
         generate(algorithm: string, pkeyopts?: string[]): Key;
+        /**
+         * Generate key on the native thread pool.
+         * Key is taken from KeyPool if the profile is reserved
+         *
+         * @param {string} algorithm
+         * @param {string[]} [pkeyopts]
+         * @param {AsyncCallback<Key>} [done]
+         * @returns {Promise<Key>} If done is not set
+         * @memberof Key
+         */
+        generateAsync(algorithm: string, pkeyopts?: string[], done?: AsyncCallback<Key>): Promise<Key>;
         /**
          * Load private key from file
          *
@@ -1229,6 +1527,82 @@ declare namespace trusted.pki {
         compare(key: Key): number;
     }
 }
+declare namespace trusted.pki {
+    /**
+     * Pool of pre-generated keys. Keys of reserved profiles
+     * (algorithm and pkeyopts) are generated on the native thread pool
+     *
+     * @export
+     * @class KeyPool
+     * @extends {BaseObject<native.PKI.KeyPool>}
+     */
+    class KeyPool extends BaseObject<native.PKI.KeyPool> {
+        /**
+         * Keep count keys of the profile ready. Count 0 removes the profile
+         *
+         * @static
+         * @param {string} algorithm
+         * @param {string[]} pkeyopts
+         * @param {number} count
+         * @memberof KeyPool
+         */
+        static reserve(algorithm: string, pkeyopts: string[], count: number): void;
+        /**
+         * Take key from the pool. If there is no ready key it is generated
+         *
+         * @static
+         * @param {string} algorithm
+         * @param {string[]} [pkeyopts]
+         * @returns {Key}
+         * @memberof KeyPool
+         */
+        static take(algorithm: string, pkeyopts?: string[]): Key;
+        /**
+         * Return hit/miss counters of the pool
+         *
+         * @static
+         * @returns {native.PKI.IKeyPoolStats}
+         * @memberof KeyPool
+         */
+        static getStats(): native.PKI.IKeyPoolStats;
+    }
+}
+declare namespace trusted.pki {
+    /**
+     * Cache of keys derived from passwords by Cipher (PBKDF2, scrypt).
+     * Data encrypted by one Cipher shares the salt, so the key of a batch
+     * is derived once. Keys are cleansed when they leave the cache
+     *
+     * @export
+     * @class KeyCache
+     * @extends {BaseObject<native.PKI.KeyCache>}
+     */
+    class KeyCache extends BaseObject<native.PKI.KeyCache> {
+        /**
+         * Set count of cached keys. Least recently used keys are evicted
+         *
+         * @static
+         * @param {number} capacity 0 - keys are not cached
+         * @memberof KeyCache
+         */
+        static setCapacity(capacity: number): void;
+        /**
+         * Remove and cleanse all keys
+         *
+         * @static
+         * @memberof KeyCache
+         */
+        static clear(): void;
+        /**
+         * Return hit/miss counters of the cache
+         *
+         * @static
+         * @returns {native.PKI.IKeyCacheStats}
+         * @memberof KeyCache
+         */
+        static getStats(): native.PKI.IKeyCacheStats;
+    }
+}
 declare namespace trusted.pki {
     /**
      * Wrap ASN1_OBJECT
@@ -1846,6 +2220,15 @@ declare namespace trusted.pki {
          * @memberOf Certificate
          */
         duplicate(): Certificate;
+        /**
+         * Return all read only properties (except extensions) by one native call.
+         * Use it instead of several getters to list many certificates
+         *
+         * @returns {native.PKI.ICertificateInfo}
+         *
+         * @memberOf Certificate
+         */
+        toJSON(): native.PKI.ICertificateInfo;
         /**
          * Signs certificate using the given private key
          *
@@ -2422,6 +2805,15 @@ declare namespace trusted.pki {
          * @memberOf Crl
          */
         duplicate(): Crl;
+        /**
+         * Return all read only properties (except encoded data) by one native call.
+         * Use it instead of several getters to list many CRLs
+         *
+         * @returns {native.PKI.ICrlInfo}
+         *
+         * @memberOf Crl
+         */
+        toJSON(): native.PKI.ICrlInfo;
     }
 }
 declare namespace trusted.pki {
@@ -2630,6 +3022,78 @@ declare namespace trusted.pki {
         verifyChain(chain: CertificateCollection, crls: CrlCollection): boolean;
     }
 }
+declare namespace trusted.pki {
+    /**
+     * Transform stream of symmetric encryption (decryption).
+     * Chunks are processed on the native thread pool one by one, so the
+     * stream follows highWaterMark backpressure of its writer and reader.
+     * Output is the same as of Cipher.encrypt ("Salted__" header for password).
+     *
+     * @example
+     * req.pipe(cipher.createEncryptStream()).pipe(fs.createWriteStream("upload.enc"));
+     *
+     * @export
+     * @class CipherStream
+     */
+    class CipherStream {
+        handle: native.PKI.CipherStream;
+        /**
+         * Creates an instance of CipherStream. Use Cipher.createEncryptStream()
+         * or Cipher.createDecryptStream()
+         *
+         * @param {native.PKI.CipherStream} handle
+         * @param {object} [options] Options of stream.Transform (highWaterMark)
+         *
+         * @memberOf CipherStream
+         */
+        constructor(handle: native.PKI.CipherStream, options?: object);
+        pipe<T extends NodeJS.WritableStream>(destination: T, options?: { end?: boolean; }): T;
+        write(chunk: Buffer | string, cb?: Function): boolean;
+        end(chunk?: Buffer | string, cb?: Function): void;
+        on(event: string, listener: Function): this;
+        _transform(chunk: Buffer, encoding: string, callback: (err?: Error) => void): void;
+        _flush(callback: (err?: Error) => void): void;
+    }
+}
+declare namespace trusted.pki {
+    /**
+     * Symmetric encryption of many small messages with one key.
+     * The cipher context is keyed once, every message only sets its IV
+     * (nonce), which is written before the ciphertext. AEAD messages also
+     * carry the tag. Use Cipher.createSession()
+     *
+     * @export
+     * @class CipherSession
+     * @extends {BaseObject<native.PKI.CipherSession>}
+     */
+    class CipherSession extends BaseObject<native.PKI.CipherSession> {
+        /**
+         * Creates an instance of CipherSession.
+         * @param {native.PKI.CipherSession} handle
+         *
+         * @memberOf CipherSession
+         */
+        constructor(handle: native.PKI.CipherSession);
+        /**
+         * Encrypt one message
+         *
+         * @param {Buffer} message
+         * @returns {Buffer} IV (nonce), ciphertext and tag of AEAD
+         *
+         * @memberOf CipherSession
+         */
+        encrypt(message: Buffer): Buffer;
+        /**
+         * Decrypt message of encrypt(). Throws if the tag (padding) is wrong
+         *
+         * @param {Buffer} message
+         * @returns {Buffer}
+         *
+         * @memberOf CipherSession
+         */
+        decrypt(message: Buffer): Buffer;
+    }
+}
 declare namespace trusted.pki {
     /**
      * Encrypt and decrypt operations
@@ -2655,7 +3119,8 @@ declare namespace trusted.pki {
          */
         cryptoMethod: CryptoMethod;
         /**
-         * Encrypt data
+         * Encrypt data. The source file is memory mapped and must not be
+         * truncated until the call returns
          *
          * @param {string} filenameSource This file will encrypted
          * @param {string} filenameEnc File path for save encrypted data
@@ -2665,7 +3130,8 @@ declare namespace trusted.pki {
          */
         encrypt(filenameSource: string, filenameEnc: string, format: DataFormat): void;
         /**
-         * Decrypt data
+         * Decrypt data. The encrypted file is memory mapped and must not be
+         * truncated until the call returns
          *
          * @param {string} filenameEnc This file will decrypt
          * @param {string} filenameDec File path for save decrypted data
@@ -2674,6 +3140,80 @@ declare namespace trusted.pki {
          * @memberOf Cipher
          */
         decrypt(filenameEnc: string, filenameDec: string, format?: DataFormat): void;
+        /**
+         * Encrypt data on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {(string | Buffer)} data Data or path of file to encrypt
+         * @param {DataFormat} [format=DataFormat.DER]
+         * @param {AsyncCallback<Buffer>} [done]
+         * @returns {Promise<Buffer>} If done is not set
+         *
+         * @memberOf Cipher
+         */
+        encryptAsync(data: string | Buffer, format?: DataFormat, done?: AsyncCallback<Buffer>): Promise<Buffer>;
+        /**
+         * Decrypt data on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {(string | Buffer)} data Encrypted data or path of file
+         * @param {DataFormat} [format] Detected if not set
+         * @param {AsyncCallback<Buffer>} [done]
+         * @returns {Promise<Buffer>} If done is not set
+         *
+         * @memberOf Cipher
+         */
+        decryptAsync(data: string | Buffer, format?: DataFormat, done?: AsyncCallback<Buffer>): Promise<Buffer>;
+        /**
+         * Create Transform stream which encrypts data written to it (symmetric method)
+         *
+         * @param {object} [options] Options of stream.Transform (highWaterMark)
+         * @returns {CipherStream}
+         *
+         * @memberOf Cipher
+         */
+        createEncryptStream(options?: object): CipherStream;
+        /**
+         * Create Transform stream which decrypts data written to it (symmetric method)
+         *
+         * @param {object} [options] Options of stream.Transform (highWaterMark)
+         * @returns {CipherStream}
+         *
+         * @memberOf Cipher
+         */
+        createDecryptStream(options?: object): CipherStream;
+        /**
+         * Decrypt plaintext bytes [offset, offset + length) of segmented AEAD data.
+         * Only segments of the range are read and decrypted
+         *
+         * @param {(string | Buffer)} data Encrypted data or path of file
+         * @param {number} offset
+         * @param {number} length Range is cut by the end of data
+         * @returns {Buffer}
+         *
+         * @memberOf Cipher
+         */
+        decryptRange(data: string | Buffer, offset: number, length: number): Buffer;
+        /**
+         * Create session for many small messages with the current key (symmetric method).
+         * Session keeps the key, so password and iv are not used
+         *
+         * @returns {CipherSession}
+         *
+         * @memberOf Cipher
+         */
+        createSession(): CipherSession;
+        /**
+         * Set password KDF of AEAD data: "pbkdf2" (default) or "scrypt".
+         * Its cost is written to the header. New salt is generated and shared
+         * by data encrypted after, so the key is derived once (see KeyCache)
+         *
+         * @param {string} name
+         * @param {number} [cost] PBKDF2 iterations (100000) or log2(N) of scrypt (15)
+         *
+         * @memberOf Cipher
+         */
+        setKdf(name: string, cost?: number): void;
         /**
          * Add recipients certificates
          *
@@ -2703,6 +3243,41 @@ declare namespace trusted.pki {
         readonly riv: Buffer;
         iv: string;
         readonly rkey: Buffer;
+        /**
+         * AEAD algorithm of symmetric method: "auto", "aes-256-gcm", "chacha20-poly1305".
+         * "auto" selects AES-GCM if the CPU has AES instructions, else ChaCha20-Poly1305.
+         * Empty string returns to the legacy format. Set it before the key
+         *
+         * @memberOf Cipher
+         */
+        aead: string;
+        /**
+         * Segment size of AEAD data in bytes. Segments are encrypted by several
+         * threads and any range of data can be decrypted. 0 - data is one segment
+         *
+         * @memberOf Cipher
+         */
+        segmentSize: number;
+        /**
+         * Threads of segmented encryption and decryption, 0 - count of hardware threads.
+         * Helper threads are taken from idle threads of the native thread pool
+         *
+         * @memberOf Cipher
+         */
+        threads: number;
+        /**
+         * Size of I/O buffers of encryption and streams in bytes (default 8192)
+         *
+         * @memberOf Cipher
+         */
+        bufferSize: number;
+        /**
+         * Password KDF of AEAD data
+         *
+         * @readonly
+         * @memberOf Cipher
+         */
+        readonly kdf: string;
         key: string;
         readonly rsalt: Buffer;
         salt: string;
@@ -3183,6 +3758,18 @@ declare namespace trusted.cms {
          * @memberOf SignedData
          */
         static load(filename: string, format?: DataFormat): SignedData;
+        /**
+         * Load signed data from file location on the native thread pool
+         *
+         * @static
+         * @param {string} filename File location
+         * @param {DataFormat} [format] PEM | DER
+         * @param {AsyncCallback<SignedData>} [done]
+         * @returns {Promise<SignedData>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        static loadAsync(filename: string, format?: DataFormat, done?: AsyncCallback<SignedData>): Promise<SignedData>;
         /**
          * Load signed data from memory
          *
@@ -3278,7 +3865,8 @@ declare namespace trusted.cms {
          */
         signers(): SignerCollection;
         /**
-         * Load sign from file location
+         * Load sign from file location. The file is memory mapped while
+         * it is parsed and must not be truncated meanwhile
          *
          * @param {string} filename File location
          * @param {DataFormat} [format] PEM | DER
@@ -3286,6 +3874,18 @@ declare namespace trusted.cms {
          * @memberOf SignedData
          */
         load(filename: string, format?: DataFormat): void;
+        /**
+         * Load sign from file location on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {string} filename File location
+         * @param {DataFormat} [format] PEM | DER
+         * @param {AsyncCallback<void>} [done]
+         * @returns {Promise<void>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        loadAsync(filename: string, format?: DataFormat, done?: AsyncCallback<void>): Promise<void>;
         /**
          * Load sign from memory
          *
@@ -3332,6 +3932,17 @@ declare namespace trusted.cms {
          * @memberOf SignedData
          */
         verify(certs?: pki.CertificateCollection): boolean;
+        /**
+         * Verify signature on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {CertificateCollection} [certs] Certificate collection
+         * @param {AsyncCallback<boolean>} [done]
+         * @returns {Promise<boolean>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        verifyAsync(certs?: pki.CertificateCollection, done?: AsyncCallback<boolean>): Promise<boolean>;
         /**
          * Create sign
          *
@@ -3339,6 +3950,16 @@ declare namespace trusted.cms {
          * @memberOf SignedData
          */
         sign(): void;
+        /**
+         * Create sign on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {AsyncCallback<void>} [done]
+         * @returns {Promise<void>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        signAsync(done?: AsyncCallback<void>): Promise<void>;
     }
 }
 declare namespace trusted.pkistore {
@@ -3452,13 +4073,24 @@ declare namespace trusted.pkistore {
      */
     class Provider_System extends BaseObject<native.PKISTORE.Provider_System> {
         /**
-         * Creates an instance of Provider_System.
+         * Scan folder on the native thread pool (Low priority)
          *
+         * @static
          * @param {string} folder Path
+         * @param {AsyncCallback<Provider_System>} [done]
+         * @returns {Promise<Provider_System>} undefined if done is set
          *
          * @memberOf Provider_System
          */
-        constructor(folder: string);
+        static loadAsync(folder: string, done?: AsyncCallback<Provider_System>): Promise<Provider_System>;
+        /**
+         * Creates an instance of Provider_System.
+         *
+         * @param {string} [folder] Path. Without folder provider is empty until loadAsync() is done
+         *
+         * @memberOf Provider_System
+         */
+        constructor(folder?: string);
         /**
          * Return PkiItem for pki object
          *
@@ -3530,6 +4162,14 @@ declare namespace trusted.pkistore {
         signatureAlgorithm: string;
         signatureDigestAlgorithm: string;
         publicKeyAlgorithm: string;
+        /**
+         * Return all fields of item by one native call
+         *
+         * @returns {native.PKISTORE.IPkiItem}
+         *
+         * @memberOf PkiItem
+         */
+        toJSON(): native.PKISTORE.IPkiItem;
     }
     class PkiStore extends BaseObject<native.PKISTORE.PkiStore> {
         private cashJson;
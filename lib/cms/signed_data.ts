@@ -86,6 +86,25 @@ namespace trusted.cms {
             return cms;
         }
 
+        /**
+         * Load signed data from file location on the native thread pool
+         *
+         * @static
+         * @param {string} filename File location
+         * @param {DataFormat} [format] PEM | DER
+         * @param {AsyncCallback<SignedData>} [done]
+         * @returns {Promise<SignedData>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        public static loadAsync(filename: string, format?: DataFormat,
+                                done?: AsyncCallback<SignedData>): Promise<SignedData> {
+            const cms: SignedData = new SignedData();
+            return callAsync<SignedData>((cb) => {
+                cms.handle.loadAsync(filename, format, (err: Error) => cb(err, err ? undefined : cms));
+            }, done);
+        }
+
         /**
          * Load signed data from memory
          *
@@ -281,7 +300,8 @@ namespace trusted.cms {
         }
 
         /**
-         * Load sign from file location
+         * Load sign from file location. The file is memory mapped while
+         * it is parsed and must not be truncated meanwhile
          *
          * @param {string} filename File location
          * @param {DataFormat} [format] PEM | DER
@@ -292,6 +312,21 @@ namespace trusted.cms {
             this.handle.load(filename, format);
         }
 
+        /**
+         * Load sign from file location on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {string} filename File location
+         * @param {DataFormat} [format] PEM | DER
+         * @param {AsyncCallback<void>} [done]
+         * @returns {Promise<void>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        public loadAsync(filename: string, format?: DataFormat, done?: AsyncCallback<void>): Promise<void> {
+            return callAsync<void>((cb) => this.handle.loadAsync(filename, format, cb), done);
+        }
+
         /**
          * Load sign from memory
          *
@@ -358,6 +393,24 @@ namespace trusted.cms {
             return this.handle.verify(certsD.handle);
         }
 
+        /**
+         * Verify signature on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {CertificateCollection} [certs] Certificate collection
+         * @param {AsyncCallback<boolean>} [done]
+         * @returns {Promise<boolean>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        public verifyAsync(certs?: pki.CertificateCollection, done?: AsyncCallback<boolean>): Promise<boolean> {
+            let certsD: pki.CertificateCollection = certs;
+            if (!certs) {
+                certsD = new pki.CertificateCollection();
+            }
+            return callAsync<boolean>((cb) => this.handle.verifyAsync(certsD.handle, cb), done);
+        }
+
         /**
          * Create sign
          *
@@ -367,5 +420,18 @@ namespace trusted.cms {
         public sign(): void {
             this.handle.sign();
         }
+
+        /**
+         * Create sign on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {AsyncCallback<void>} [done]
+         * @returns {Promise<void>} If done is not set
+         *
+         * @memberOf SignedData
+         */
+        public signAsync(done?: AsyncCallback<void>): Promise<void> {
+            return callAsync<void>((cb) => this.handle.signAsync(cb), done);
+        }
     }
 }
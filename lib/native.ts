@@ -7,6 +7,7 @@ declare namespace native {
     namespace PKI {
         class Key {
             public generate(algorithm: string, pkeyopts?: string[]): Key;
+            public generateAsync(algorithm: string, pkeyopts: string[], done: (err: Error, key: Key) => void): number;
             public readPrivateKey(filename: string, format: trusted.DataFormat, password: string);
             public readPublicKey(filename: string, format: trusted.DataFormat);
             public writePrivateKey(filename: string, format: trusted.DataFormat, password: string);
@@ -16,6 +17,33 @@ declare namespace native {
             public duplicate(): Key;
         }
 
+        export interface IKeyPoolStats {
+            hits: number;
+            misses: number;
+            generated: number;
+            failures: number;
+            ready: number;
+        }
+
+        class KeyPool {
+            public reserve(algorithm: string, pkeyopts: string[], count: number): void;
+            public take(algorithm: string, pkeyopts?: string[]): Key;
+            public getStats(): IKeyPoolStats;
+        }
+
+        export interface IKeyCacheStats {
+            hits: number;
+            misses: number;
+            size: number;
+            capacity: number;
+        }
+
+        class KeyCache {
+            public setCapacity(capacity: number): void;
+            public clear(): void;
+            public getStats(): IKeyCacheStats;
+        }
+
         class Algorithm {
             constructor(name?: string);
             public getTypeId(): OID;
@@ -66,6 +94,32 @@ declare namespace native {
             public removeAt(index: number): void;
         }
 
+        /**
+         * Properties of certificate read by one native call.
+         * Dates are in the format of getNotBefore(), thumbprint is hex
+         */
+        export interface ICertificateInfo {
+            version: number;
+            subjectFriendlyName: string;
+            issuerFriendlyName: string;
+            subjectName: string;
+            issuerName: string;
+            notBefore: string;
+            notAfter: string;
+            serialNumber: string;
+            thumbprint: string;
+            type: number;
+            keyUsage: number;
+            signatureAlgorithm: string;
+            signatureDigestAlgorithm: string;
+            publicKeyAlgorithm: string;
+            organizationName: string;
+            OCSPUrls: string[];
+            CAIssuersUrls: string[];
+            isSelfSigned: boolean;
+            isCA: boolean;
+        }
+
         class Certificate {
             constructor(param?: PKI.Certificate | PKI.CertificationRequest);
             public getSubjectFriendlyName(): string;
@@ -95,6 +149,7 @@ declare namespace native {
             public setExtensions(exts: ExtensionCollection): void;
             public isSelfSigned(): boolean;
             public isCA(): boolean;
+            public getInfo(): ICertificateInfo;
 
             public sign(key: Key, digest?: string): void;
             public load(filename: string, dataFormat?: trusted.DataFormat): void;
@@ -131,6 +186,19 @@ declare namespace native {
             public removeAt(index: number): void;
         }
 
+        export interface ICrlInfo {
+            version: number;
+            issuerName: string;
+            issuerFriendlyName: string;
+            lastUpdate: string;
+            nextUpdate: string;
+            thumbprint: string;
+            signatureAlgorithm: string;
+            signatureDigestAlgorithm: string;
+            authorityKeyid: string;
+            crlNumber: string;
+        }
+
         class CRL {
             public getEncoded(): Buffer;
             public getSignature(): Buffer;
@@ -146,6 +214,7 @@ declare namespace native {
             public getAuthorityKeyid(): string;
             public getCrlNumber(): string;
             public getRevoked(): RevokedCollection;
+            public getInfo(): ICrlInfo;
 
             public load(filename: string, dataFormat: trusted.DataFormat): void;
             public import(raw: Buffer, dataFormat: trusted.DataFormat): void;
@@ -209,11 +278,29 @@ declare namespace native {
             public getEncodedHEX(): Buffer;
         }
 
+        class CipherStream {
+            public update(chunk: Buffer): Buffer;
+            public updateAsync(chunk: Buffer, done: (err: Error, res: Buffer) => void): number;
+            public final(): Buffer;
+        }
+
+        class CipherSession {
+            public encrypt(message: Buffer): Buffer;
+            public decrypt(message: Buffer): Buffer;
+        }
+
         class Cipher {
             constructor();
             public setCryptoMethod(method: trusted.CryptoMethod): void;
             public encrypt(filenameSource: string, filenameEnc: string, format: trusted.DataFormat): void;
             public decrypt(filenameEnc: string, filenameDec: string, format?: trusted.DataFormat): void;
+            public encryptAsync(data: string | Buffer, format: trusted.DataFormat,
+                                done: (err: Error, res: Buffer) => void): number;
+            public decryptAsync(data: string | Buffer, format: trusted.DataFormat,
+                                done: (err: Error, res: Buffer) => void): number;
+            public createStream(encrypt: boolean): CipherStream;
+            public decryptRange(data: string | Buffer, offset: number, length: number): Buffer;
+            public createSession(): CipherSession;
             public addRecipientsCerts(certs: CertificateCollection): void;
             public setPrivKey(rkey: Key): void;
             public setRecipientCert(rcert: Certificate): void;
@@ -221,10 +308,17 @@ declare namespace native {
             public setDigest(digest: string): void;
             public setIV(iv: string): void;
             public setKey(key: string): void;
+            public setAead(name: string): void;
+            public setSegmentSize(size: number): void;
+            public setThreads(threads: number): void;
+            public setBufferSize(size: number): void;
+            public setKdf(name: string, cost?: number): void;
             public setSalt(salt: string): void;
             public getSalt(): Buffer;
             public getIV(): Buffer;
             public getKey(): Buffer;
+            public getAead(): string;
+            public getKdf(): string;
             public getAlgorithm(): string;
             public getMode(): string;
             public getDigestAlgorithm(): string;
@@ -274,6 +368,9 @@ declare namespace native {
             public addCertificate(cert: PKI.Certificate): void;
             public verify(certs?: PKI.CertificateCollection): boolean;
             public sign(): void;
+            public loadAsync(filename: string, dataFormat: trusted.DataFormat, done: (err: Error) => void): number;
+            public verifyAsync(certs: PKI.CertificateCollection, done: (err: Error, res: boolean) => void): number;
+            public signAsync(done: (err: Error) => void): number;
         }
 
         class SignerCollection {
@@ -404,7 +501,8 @@ declare namespace native {
 
         /* tslint:disable-next-line:class-name */
         class Provider_System extends Provider {
-            constructor(folder: string);
+            constructor(folder?: string);
+            public loadAsync(folder: string, done: (err: Error) => void): number;
             public objectToPkiItem(pathr: string): IPkiItem;
         }
 
@@ -509,6 +607,7 @@ declare namespace native {
             public setSignatureAlgorithm(signatureAlgorithm: string): void;
             public setSignatureDigestAlgorithm(signatureDigestAlgorithm: string): void;
             public setPublicKeyAlgorithm(publicKeyAlgorithm: string): void;
+            public getInfo(): IPkiItem;
         }
     }
 
@@ -536,9 +635,51 @@ declare namespace native {
         }
 
         class Logger {
-            public start(filename: string, level: trusted.LoggerLevel): void;
+            public start(filename: string, level: trusted.LoggerLevel, async?: boolean): void;
             public stop(): void;
             public clear(): void;
+            public getDropped(): number;
+        }
+
+        export interface IObjectPoolStats {
+            allocations: number;
+            releases: number;
+            live: number;
+            slabs: number;
+            slabBytes: number;
+            large: number;
+        }
+
+        export interface IOpenSSLMemoryStats {
+            installed: boolean;
+            allocations: number;
+            releases: number;
+            liveBytes: number;
+            allocatedBytes: number;
+        }
+
+        class ObjectPool {
+            public getStats(): IObjectPoolStats;
+            public getOpenSSLStats(): IOpenSSLMemoryStats;
+        }
+
+        export interface IThreadPoolStats {
+            size: number;
+            running: number;
+            pending: number[];
+            limits: number[];
+            completed: number;
+            rejected: number;
+            removed: number;
+        }
+
+        class ThreadPool {
+            public getStats(): IThreadPoolStats;
+            public resize(size: number): void;
+            public setLimit(priority: trusted.utils.ThreadPriority, limit: number): void;
+            public setPriority(priority: number): void;
+            public getLastJob(): number;
+            public cancel(id: number): boolean;
         }
 
         class Csp {
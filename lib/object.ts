@@ -16,4 +16,33 @@ namespace trusted {
 
         public handle: T;
     }
+
+    export type AsyncCallback<T> = (err: Error, res?: T) => void;
+
+    /**
+     * Run native async method. Result is passed to done or,
+     * if done is not set, to the returned Promise
+     *
+     * @export
+     * @template T
+     * @param {(cb: AsyncCallback<T>) => void} fn Calls native method with callback
+     * @param {AsyncCallback<T>} [done]
+     * @returns {Promise<T>} undefined if done is set
+     */
+    export function callAsync<T>(fn: (cb: AsyncCallback<T>) => void, done?: AsyncCallback<T>): Promise<T> {
+        if (done) {
+            fn(done);
+            return undefined;
+        }
+
+        return new Promise<T>((resolve, reject) => {
+            fn((err: Error, res?: T) => {
+                if (err) {
+                    reject(err);
+                } else {
+                    resolve(res);
+                }
+            });
+        });
+    }
 }
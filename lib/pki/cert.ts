@@ -492,6 +492,18 @@ namespace trusted.pki {
             return cert;
         }
 
+        /**
+         * Return all read only properties (except extensions) by one native call.
+         * Use it instead of several getters to list many certificates
+         *
+         * @returns {native.PKI.ICertificateInfo}
+         *
+         * @memberOf Certificate
+         */
+        public toJSON(): native.PKI.ICertificateInfo {
+            return this.handle.getInfo();
+        }
+
         /**
          * Signs certificate using the given private key
          *
@@ -34,7 +34,8 @@ namespace trusted.pki {
         }
 
         /**
-         * Encrypt data
+         * Encrypt data. The source file is memory mapped and must not be
+         * truncated until the call returns
          *
          * @param {string} filenameSource This file will encrypted
          * @param {string} filenameEnc File path for save encrypted data
@@ -47,7 +48,8 @@ namespace trusted.pki {
         }
 
         /**
-         * Decrypt data
+         * Decrypt data. The encrypted file is memory mapped and must not be
+         * truncated until the call returns
          *
          * @param {string} filenameEnc This file will decrypt
          * @param {string} filenameDec File path for save decrypted data
@@ -59,6 +61,101 @@ namespace trusted.pki {
             this.handle.decrypt(filenameEnc, filenameDec, format);
         }
 
+        /**
+         * Encrypt data on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {(string | Buffer)} data Data or path of file to encrypt
+         * @param {DataFormat} [format=DataFormat.DER]
+         * @param {AsyncCallback<Buffer>} [done]
+         * @returns {Promise<Buffer>} If done is not set
+         *
+         * @memberOf Cipher
+         */
+        public encryptAsync(data: string | Buffer, format?: DataFormat, done?: AsyncCallback<Buffer>): Promise<Buffer> {
+            return callAsync<Buffer>((cb) => this.handle.encryptAsync(data, format, cb), done);
+        }
+
+        /**
+         * Decrypt data on the native thread pool. Until the job is completed
+         * other methods of the object throw "busy" error
+         *
+         * @param {(string | Buffer)} data Encrypted data or path of file
+         * @param {DataFormat} [format] Detected if not set
+         * @param {AsyncCallback<Buffer>} [done]
+         * @returns {Promise<Buffer>} If done is not set
+         *
+         * @memberOf Cipher
+         */
+        public decryptAsync(data: string | Buffer, format?: DataFormat, done?: AsyncCallback<Buffer>): Promise<Buffer> {
+            return callAsync<Buffer>((cb) => this.handle.decryptAsync(data, format, cb), done);
+        }
+
+        /**
+         * Create Transform stream which encrypts data written to it (symmetric method)
+         *
+         * @param {object} [options] Options of stream.Transform (highWaterMark)
+         * @returns {CipherStream}
+         *
+         * @memberOf Cipher
+         */
+        public createEncryptStream(options?: object): CipherStream {
+            return new CipherStream(this.handle.createStream(true), options);
+        }
+
+        /**
+         * Create Transform stream which decrypts data written to it (symmetric method)
+         *
+         * @param {object} [options] Options of stream.Transform (highWaterMark)
+         * @returns {CipherStream}
+         *
+         * @memberOf Cipher
+         */
+        public createDecryptStream(options?: object): CipherStream {
+            return new CipherStream(this.handle.createStream(false), options);
+        }
+
+        /**
+         * Decrypt plaintext bytes [offset, offset + length) of segmented AEAD data.
+         * Only segments of the range are read and decrypted
+         *
+         * @param {(string | Buffer)} data Encrypted data or path of file
+         * @param {number} offset
+         * @param {number} length Range is cut by the end of data
+         * @returns {Buffer}
+         *
+         * @memberOf Cipher
+         */
+        public decryptRange(data: string | Buffer, offset: number, length: number): Buffer {
+            return this.handle.decryptRange(data, offset, length);
+        }
+
+        /**
+         * Create session for many small messages with the current key (symmetric method).
+         * Session keeps the key, so password and iv are not used
+         *
+         * @returns {CipherSession}
+         *
+         * @memberOf Cipher
+         */
+        public createSession(): CipherSession {
+            return new CipherSession(this.handle.createSession());
+        }
+
+        /**
+         * Set password KDF of AEAD data: "pbkdf2" (default) or "scrypt".
+         * Its cost is written to the header. New salt is generated and shared
+         * by data encrypted after, so the key is derived once (see KeyCache)
+         *
+         * @param {string} name
+         * @param {number} [cost] PBKDF2 iterations (100000) or log2(N) of scrypt (15)
+         *
+         * @memberOf Cipher
+         */
+        public setKdf(name: string, cost?: number): void {
+            this.handle.setKdf(name, cost);
+        }
+
         /**
          * Add recipients certificates
          *
@@ -116,6 +213,66 @@ namespace trusted.pki {
             this.handle.setKey(key);
         }
 
+        /**
+         * AEAD algorithm of symmetric method: "auto", "aes-256-gcm", "chacha20-poly1305".
+         * "auto" selects AES-GCM if the CPU has AES instructions, else ChaCha20-Poly1305.
+         * Data is written with versioned header (nonce, KDF parameters) and tag.
+         * Empty string returns to the legacy format. Set it before the key
+         *
+         * @type {string}
+         * @memberOf Cipher
+         */
+        get aead(): string {
+            return this.handle.getAead();
+        }
+
+        set aead(name: string) {
+            this.handle.setAead(name);
+        }
+
+        /**
+         * Segment size of AEAD data in bytes. Segments are encrypted by several
+         * threads and any range of data can be decrypted. 0 - data is one segment
+         *
+         * @type {number}
+         * @memberOf Cipher
+         */
+        set segmentSize(size: number) {
+            this.handle.setSegmentSize(size);
+        }
+
+        /**
+         * Threads of segmented encryption and decryption, 0 - count of hardware threads.
+         * Helper threads are taken from idle threads of the native thread pool
+         *
+         * @type {number}
+         * @memberOf Cipher
+         */
+        set threads(threads: number) {
+            this.handle.setThreads(threads);
+        }
+
+        /**
+         * Size of I/O buffers of encryption and streams in bytes (default 8192)
+         *
+         * @type {number}
+         * @memberOf Cipher
+         */
+        set bufferSize(size: number) {
+            this.handle.setBufferSize(size);
+        }
+
+        /**
+         * Password KDF of AEAD data
+         *
+         * @readonly
+         * @type {string}
+         * @memberOf Cipher
+         */
+        get kdf(): string {
+            return this.handle.getKdf();
+        }
+
         get rsalt(): Buffer {
             return this.handle.getSalt();
         }
@@ -0,0 +1,52 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.pki {
+
+    /**
+     * Symmetric encryption of many small messages with one key.
+     * The cipher context is keyed once, every message only sets its IV
+     * (nonce), which is written before the ciphertext. AEAD messages also
+     * carry the tag. Use Cipher.createSession()
+     *
+     * @export
+     * @class CipherSession
+     * @extends {BaseObject<native.PKI.CipherSession>}
+     */
+    export class CipherSession extends BaseObject<native.PKI.CipherSession> {
+        /**
+         * Creates an instance of CipherSession.
+         * @param {native.PKI.CipherSession} handle
+         *
+         * @memberOf CipherSession
+         */
+        constructor(handle: native.PKI.CipherSession) {
+            super();
+            this.handle = handle;
+        }
+
+        /**
+         * Encrypt one message
+         *
+         * @param {Buffer} message
+         * @returns {Buffer} IV (nonce), ciphertext and tag of AEAD
+         *
+         * @memberOf CipherSession
+         */
+        public encrypt(message: Buffer): Buffer {
+            return this.handle.encrypt(message);
+        }
+
+        /**
+         * Decrypt message of encrypt(). Throws if the tag (padding) is wrong
+         *
+         * @param {Buffer} message
+         * @returns {Buffer}
+         *
+         * @memberOf CipherSession
+         */
+        public decrypt(message: Buffer): Buffer {
+            return this.handle.decrypt(message);
+        }
+    }
+}
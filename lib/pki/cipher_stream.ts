@@ -0,0 +1,62 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.pki {
+    const stream = require("stream");
+
+    /**
+     * Transform stream of symmetric encryption (decryption).
+     * Chunks are processed on the native thread pool one by one, so the
+     * stream follows highWaterMark backpressure of its writer and reader.
+     * Output is the same as of Cipher.encrypt ("Salted__" header for password).
+     *
+     * @example
+     * req.pipe(cipher.createEncryptStream()).pipe(fs.createWriteStream("upload.enc"));
+     *
+     * @export
+     * @class CipherStream
+     */
+    export class CipherStream extends stream.Transform {
+        public handle: native.PKI.CipherStream;
+
+        /**
+         * Creates an instance of CipherStream. Use Cipher.createEncryptStream()
+         * or Cipher.createDecryptStream()
+         *
+         * @param {native.PKI.CipherStream} handle
+         * @param {object} [options] Options of stream.Transform (highWaterMark)
+         *
+         * @memberOf CipherStream
+         */
+        constructor(handle: native.PKI.CipherStream, options?: object) {
+            super(options);
+            this.handle = handle;
+        }
+
+        public _transform(chunk: Buffer, encoding: string, callback: (err?: Error) => void): void {
+            try {
+                this.handle.updateAsync(chunk, (err: Error, res: Buffer) => {
+                    if (!err && res.length) {
+                        this.push(res);
+                    }
+                    callback(err);
+                });
+            } catch (err) {
+                callback(err);
+            }
+        }
+
+        public _flush(callback: (err?: Error) => void): void {
+            try {
+                const res: Buffer = this.handle.final();
+                if (res.length) {
+                    this.push(res);
+                }
+            } catch (err) {
+                callback(err);
+                return;
+            }
+            callback();
+        }
+    }
+}
@@ -307,5 +307,17 @@ namespace trusted.pki {
             crl.handle = this.handle.duplicate();
             return crl;
         }
+
+        /**
+         * Return all read only properties (except encoded data) by one native call.
+         * Use it instead of several getters to list many CRLs
+         *
+         * @returns {native.PKI.ICrlInfo}
+         *
+         * @memberOf Crl
+         */
+        public toJSON(): native.PKI.ICrlInfo {
+            return this.handle.getInfo();
+        }
     }
 }
@@ -71,6 +71,24 @@ namespace trusted.pki {
             return Key.wrap<native.PKI.Key, Key>(this.handle.generate(algorithm, pkeyopts));
         }
 
+        /**
+         * Generate key on the native thread pool.
+         * Key is taken from KeyPool if the profile is reserved
+         *
+         * @param {string} algorithm
+         * @param {string[]} [pkeyopts]
+         * @param {AsyncCallback<Key>} [done]
+         * @returns {Promise<Key>} If done is not set
+         * @memberof Key
+         */
+        public generateAsync(algorithm: string, pkeyopts?: string[], done?: AsyncCallback<Key>): Promise<Key> {
+            return callAsync<Key>((cb) => {
+                this.handle.generateAsync(algorithm, pkeyopts, (err: Error, key: native.PKI.Key) => {
+                    cb(err, err ? undefined : Key.wrap<native.PKI.Key, Key>(key));
+                });
+            }, done);
+        }
+
         /**
          * Load private key from file
          *
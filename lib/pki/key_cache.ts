@@ -0,0 +1,50 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.pki {
+    /**
+     * Cache of keys derived from passwords by Cipher (PBKDF2, scrypt).
+     * Data encrypted by one Cipher shares the salt, so the key of a batch
+     * is derived once. Keys are cleansed when they leave the cache
+     *
+     * @export
+     * @class KeyCache
+     * @extends {BaseObject<native.PKI.KeyCache>}
+     */
+    export class KeyCache extends BaseObject<native.PKI.KeyCache> {
+        /**
+         * Set count of cached keys. Least recently used keys are evicted
+         *
+         * @static
+         * @param {number} capacity 0 - keys are not cached
+         * @memberof KeyCache
+         */
+        public static setCapacity(capacity: number): void {
+            const cache = new native.PKI.KeyCache();
+            cache.setCapacity(capacity);
+        }
+
+        /**
+         * Remove and cleanse all keys
+         *
+         * @static
+         * @memberof KeyCache
+         */
+        public static clear(): void {
+            const cache = new native.PKI.KeyCache();
+            cache.clear();
+        }
+
+        /**
+         * Return hit/miss counters of the cache
+         *
+         * @static
+         * @returns {native.PKI.IKeyCacheStats}
+         * @memberof KeyCache
+         */
+        public static getStats(): native.PKI.IKeyCacheStats {
+            const cache = new native.PKI.KeyCache();
+            return cache.getStats();
+        }
+    }
+}
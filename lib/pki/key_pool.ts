@@ -0,0 +1,54 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.pki {
+    /**
+     * Pool of pre-generated keys. Keys of reserved profiles
+     * (algorithm and pkeyopts) are generated on the native thread pool
+     *
+     * @export
+     * @class KeyPool
+     * @extends {BaseObject<native.PKI.KeyPool>}
+     */
+    export class KeyPool extends BaseObject<native.PKI.KeyPool> {
+        /**
+         * Keep count keys of the profile ready. Count 0 removes the profile
+         *
+         * @static
+         * @param {string} algorithm
+         * @param {string[]} pkeyopts
+         * @param {number} count
+         * @memberof KeyPool
+         */
+        public static reserve(algorithm: string, pkeyopts: string[], count: number): void {
+            const pool = new native.PKI.KeyPool();
+            pool.reserve(algorithm, pkeyopts, count);
+        }
+
+        /**
+         * Take key from the pool. If there is no ready key it is generated
+         *
+         * @static
+         * @param {string} algorithm
+         * @param {string[]} [pkeyopts]
+         * @returns {Key}
+         * @memberof KeyPool
+         */
+        public static take(algorithm: string, pkeyopts?: string[]): Key {
+            const pool = new native.PKI.KeyPool();
+            return Key.wrap<native.PKI.Key, Key>(pool.take(algorithm, pkeyopts));
+        }
+
+        /**
+         * Return hit/miss counters of the pool
+         *
+         * @static
+         * @returns {native.PKI.IKeyPoolStats}
+         * @memberof KeyPool
+         */
+        public static getStats(): native.PKI.IKeyPoolStats {
+            const pool = new native.PKI.KeyPool();
+            return pool.getStats();
+        }
+    }
+}
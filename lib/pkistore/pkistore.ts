@@ -165,6 +165,17 @@ namespace trusted.pkistore {
         set publicKeyAlgorithm(publicKeyAlgorithm: string) {
             this.handle.setPublicKeyAlgorithm(publicKeyAlgorithm);
         }
+
+        /**
+         * Return all fields of item by one native call
+         *
+         * @returns {native.PKISTORE.IPkiItem}
+         *
+         * @memberOf PkiItem
+         */
+        public toJSON(): native.PKISTORE.IPkiItem {
+            return this.handle.getInfo();
+        }
     }
 
     export class PkiStore extends BaseObject<native.PKISTORE.PkiStore> {
@@ -13,13 +13,30 @@ namespace trusted.pkistore {
      */
     export class Provider_System extends BaseObject<native.PKISTORE.Provider_System> {
         /**
-         * Creates an instance of Provider_System.
+         * Scan folder on the native thread pool (Low priority)
          *
+         * @static
          * @param {string} folder Path
+         * @param {AsyncCallback<Provider_System>} [done]
+         * @returns {Promise<Provider_System>} undefined if done is set
+         *
+         * @memberOf Provider_System
+         */
+        public static loadAsync(folder: string, done?: AsyncCallback<Provider_System>): Promise<Provider_System> {
+            const provider: Provider_System = new Provider_System();
+            return callAsync<Provider_System>((cb) => {
+                provider.handle.loadAsync(folder, (err: Error) => cb(err, err ? undefined : provider));
+            }, done);
+        }
+
+        /**
+         * Creates an instance of Provider_System.
+         *
+         * @param {string} [folder] Path. Without folder provider is empty until loadAsync() is done
          *
          * @memberOf Provider_System
          */
-        constructor(folder: string) {
+        constructor(folder?: string) {
             super();
             this.handle = new native.PKISTORE.Provider_System(folder);
         }
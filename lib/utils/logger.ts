@@ -18,13 +18,14 @@ namespace trusted.utils {
          * @static
          * @param {string} filename
          * @param {LoggerLevel} [level=DEFAULT_LOGGER_LEVEL]
+         * @param {boolean} [async=false] Write records from the background thread
          * @returns {Logger}
          *
          * @memberOf Logger
          */
-        public static start(filename: string, level: LoggerLevel = DEFAULT_LOGGER_LEVEL): Logger {
+        public static start(filename: string, level: LoggerLevel = DEFAULT_LOGGER_LEVEL, async: boolean = false): Logger {
             const logger = new Logger();
-            logger.handle.start(filename, level);
+            logger.handle.start(filename, level, async);
             return logger;
         }
 
@@ -43,12 +44,24 @@ namespace trusted.utils {
          *
          * @param {string} filename
          * @param {LoggerLevel} [level=DEFAULT_LOGGER_LEVEL]
+         * @param {boolean} [async=false] Write records from the background thread
          * @returns {void}
          *
          * @memberOf Logger
          */
-        public start(filename: string, level: LoggerLevel = DEFAULT_LOGGER_LEVEL): void {
-             return this.handle.start(filename, level);
+        public start(filename: string, level: LoggerLevel = DEFAULT_LOGGER_LEVEL, async: boolean = false): void {
+             return this.handle.start(filename, level, async);
+        }
+
+        /**
+         * Count of records dropped by the asynchronous logger because its queue was full
+         *
+         * @readonly
+         * @type {number}
+         * @memberOf Logger
+         */
+        get dropped(): number {
+            return this.handle.getDropped();
         }
 
         /**
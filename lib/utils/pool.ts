@@ -0,0 +1,70 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.utils {
+    /**
+     * Statistics of the native allocator of wrapper objects
+     *
+     * @export
+     * @class ObjectPool
+     * @extends {BaseObject<native.UTILS.ObjectPool>}
+     */
+    export class ObjectPool extends BaseObject<native.UTILS.ObjectPool> {
+        /**
+         * Return allocator counters
+         *
+         * @static
+         * @returns {native.UTILS.IObjectPoolStats}
+         * @memberof ObjectPool
+         */
+        public static getStats(): native.UTILS.IObjectPoolStats {
+            const pool = new native.UTILS.ObjectPool();
+            return pool.getStats();
+        }
+
+        /**
+         * Return counters of OpenSSL allocations.
+         * Allocation rate is the difference of allocatedBytes between two calls
+         *
+         * @static
+         * @returns {native.UTILS.IOpenSSLMemoryStats}
+         * @memberof ObjectPool
+         */
+        public static getOpenSSLStats(): native.UTILS.IOpenSSLMemoryStats {
+            const pool = new native.UTILS.ObjectPool();
+            return pool.getOpenSSLStats();
+        }
+
+        /**
+         * Creates an instance of ObjectPool.
+         *
+         * @memberof ObjectPool
+         */
+        constructor() {
+            super();
+            this.handle = new native.UTILS.ObjectPool();
+        }
+
+        /**
+         * Allocator counters
+         *
+         * @readonly
+         * @type {native.UTILS.IObjectPoolStats}
+         * @memberof ObjectPool
+         */
+        get stats(): native.UTILS.IObjectPoolStats {
+            return this.handle.getStats();
+        }
+
+        /**
+         * Counters of OpenSSL allocations
+         *
+         * @readonly
+         * @type {native.UTILS.IOpenSSLMemoryStats}
+         * @memberof ObjectPool
+         */
+        get openssl(): native.UTILS.IOpenSSLMemoryStats {
+            return this.handle.getOpenSSLStats();
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.utils {
+    /**
+     * Priority of the native thread pool queue
+     *
+     * @export
+     * @enum {number}
+     */
+    export enum ThreadPriority {
+        /** Interactive operations */
+        HIGH = 0,
+        NORMAL = 1,
+        /** Bulk and background jobs (Cipher, store scan, key pool) */
+        LOW = 2,
+    }
+
+    /**
+     * Job queued to the native thread pool
+     *
+     * @export
+     * @interface IThreadPoolJob
+     * @template T
+     */
+    export interface IThreadPoolJob<T> {
+        /** Job id for ThreadPool.cancel(), 0 if nothing is queued */
+        id: number;
+        result: T;
+    }
+
+    /**
+     * Native thread pool of async methods (sign, verify, encrypt, key generation, store scan).
+     * Queue of lower priority runs only when queues of higher priorities are empty.
+     * Async method throws if its queue is full.
+     *
+     * @export
+     * @class ThreadPool
+     * @extends {BaseObject<native.UTILS.ThreadPool>}
+     */
+    export class ThreadPool extends BaseObject<native.UTILS.ThreadPool> {
+        /**
+         * Return pool counters. pending and limits are indexed by ThreadPriority
+         *
+         * @static
+         * @returns {native.UTILS.IThreadPoolStats}
+         * @memberof ThreadPool
+         */
+        public static getStats(): native.UTILS.IThreadPoolStats {
+            const pool = new native.UTILS.ThreadPool();
+            return pool.getStats();
+        }
+
+        /**
+         * Set count of threads. Pool is shared by all JS threads of the process
+         *
+         * @static
+         * @param {number} size 0 - count of hardware threads
+         * @memberof ThreadPool
+         */
+        public static resize(size: number): void {
+            const pool = new native.UTILS.ThreadPool();
+            pool.resize(size);
+        }
+
+        /**
+         * Limit count of pending jobs of the priority
+         *
+         * @static
+         * @param {ThreadPriority} priority
+         * @param {number} limit 0 - unlimited
+         * @memberof ThreadPool
+         */
+        public static setLimit(priority: ThreadPriority, limit: number): void {
+            const pool = new native.UTILS.ThreadPool();
+            pool.setLimit(priority, limit);
+        }
+
+        /**
+         * Call async method with the priority and return id of its job
+         *
+         * @example
+         * const job = ThreadPool.schedule(() => cipher.encryptAsync(file), ThreadPriority.LOW);
+         * ThreadPool.cancel(job.id);
+         * job.result.catch((err) => console.log(err.message)); // Operation cancelled
+         *
+         * @static
+         * @template T
+         * @param {() => T} fn Calls async method
+         * @param {ThreadPriority} [priority] default is own priority of the method
+         * @returns {IThreadPoolJob<T>}
+         * @memberof ThreadPool
+         */
+        public static schedule<T>(fn: () => T, priority?: ThreadPriority): IThreadPoolJob<T> {
+            const pool = new native.UTILS.ThreadPool();
+            const last = pool.getLastJob();
+
+            if (priority !== undefined) {
+                pool.setPriority(priority);
+            }
+
+            let result: T;
+            try {
+                result = fn();
+            } finally {
+                if (priority !== undefined) {
+                    pool.setPriority(-1);
+                }
+            }
+
+            const id = pool.getLastJob();
+            return { id: id === last ? 0 : id, result };
+        }
+
+        /**
+         * Cancel job queued from this JS thread. Not started job is completed
+         * with "Operation cancelled" error, running one stops on its next check
+         *
+         * @static
+         * @param {number} id
+         * @returns {boolean} false if the job is already completed
+         * @memberof ThreadPool
+         */
+        public static cancel(id: number): boolean {
+            const pool = new native.UTILS.ThreadPool();
+            return pool.cancel(id);
+        }
+    }
+}
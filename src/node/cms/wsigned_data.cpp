@@ -9,6 +9,28 @@
 
 const char* WSignedData::className = "SignedData";
 
+/*
+* Async jobs run on the pool under lock_. Methods of the JS thread do not
+* wait for them, they throw while a job of the object is queued or running.
+*/
+#define SIGNED_DATA_CHECK_BUSY() \
+	if (__obj->jobs_.load() > 0){ \
+		Nan::ThrowError("SignedData is busy: async operation is in progress"); \
+		return; \
+	}
+
+/*
+* Size of encoded CMS structure. Content kept in Buffer or mapped file
+* is not heap memory of the object, so it is not counted.
+*/
+size_t WSignedData::externalSize(Handle<SignedData> data){
+	if (data.isEmpty() || data->isEmpty()){
+		return 0;
+	}
+	int len = i2d_CMS_ContentInfo(data->internal(), NULL);
+	return len > 0 ? (size_t)len : 0;
+}
+
 void WSignedData::Init(v8::Handle<v8::Object> exports){
 	LOGGER_FN();
 
@@ -37,6 +59,9 @@ void WSignedData::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "addCertificate", AddCertificate);
 	Nan::SetPrototypeMethod(tpl, "verify", Verify);
 	Nan::SetPrototypeMethod(tpl, "sign", Sign);
+	Nan::SetPrototypeMethod(tpl, "loadAsync", LoadAsync);
+	Nan::SetPrototypeMethod(tpl, "verifyAsync", VerifyAsync);
+	Nan::SetPrototypeMethod(tpl, "signAsync", SignAsync);
 
 	// Store the constructor in the target bindings.
 	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
@@ -72,7 +97,8 @@ NAN_METHOD(WSignedData::Load){
 		char *filename = *v8Filename;
 
 		Handle<Bio> in = NULL;
-		in = new Bio(BIO_TYPE_FILE, filename, "rb");
+		/* Mapped: the file must not be truncated until load returns (SIGBUS) */
+		in = new Bio(BIO_TYPE_MMAP, filename);
 
 		LOGGER_ARG("format");
 		DataFormat::DATA_FORMAT format = (info[1]->IsUndefined() || !info[1]->IsNumber()) ?
@@ -80,8 +106,10 @@ NAN_METHOD(WSignedData::Load){
 			DataFormat::get(info[1]->ToNumber()->Int32Value());
 
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		_this->read(in, format);
+		WRAP_EXTERNAL_MEMORY(SignedData);
 
 		info.GetReturnValue().Set(info.This());
 		return;
@@ -98,18 +126,16 @@ NAN_METHOD(WSignedData::Import) {
 
 	try {
 		LOGGER_ARG("data");
-		char* buf = node::Buffer::Data(info[0]->ToObject());
-		size_t buflen = node::Buffer::Length(info[0]);
-		std::string buffer(buf, buflen);
+		Handle<Bio> in = getBufferBio(info[0]);
 
 		LOGGER_ARG("format");
 		int format = info[1]->ToNumber()->Int32Value();
 
 		UNWRAP_DATA(SignedData);
-
-		Handle<Bio> in = new Bio(BIO_TYPE_MEM, buffer);
+		SIGNED_DATA_CHECK_BUSY();
 
 		_this->read(in, DataFormat::get(format));
+		WRAP_EXTERNAL_MEMORY(SignedData);
 
 		info.GetReturnValue().Set(info.This());
 		return;
@@ -133,6 +159,7 @@ NAN_METHOD(WSignedData::Save) {
 		int format = info[1]->ToNumber()->Int32Value();
 
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		Handle<Bio> out = new Bio(BIO_TYPE_FILE, filename, "wb");
 		_this->write(out, DataFormat::get(format));
@@ -155,14 +182,13 @@ NAN_METHOD(WSignedData::Export) {
 		int format = info[0]->ToNumber()->Int32Value();
 
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
 		_this->write(out, DataFormat::get(format));
 
-		Handle<std::string> buf = out->read();
-
 		info.GetReturnValue().Set(
-			stringToBuffer(buf)
+			bioToBuffer(out)
 			);
 		return;
 	}
@@ -174,6 +200,7 @@ NAN_METHOD(WSignedData::GetSigners) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		Handle<SignerCollection> signers = _this->signers();
 
@@ -190,6 +217,7 @@ NAN_METHOD(WSignedData::GetCertificates) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		Handle<CertificateCollection> certs = _this->certificates();
 
@@ -206,6 +234,7 @@ NAN_METHOD(WSignedData::IsDetached) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		v8::Local<v8::Boolean> v8Detached = Nan::New<v8::Boolean>(_this->isDetached());
 
@@ -225,6 +254,7 @@ NAN_METHOD(WSignedData::CreateSigner) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		LOGGER_ARG("certificate");
 		WCertificate *wCert = Wrapper::Unwrap<WCertificate>(info[0]->ToObject());
@@ -250,6 +280,7 @@ NAN_METHOD(WSignedData::AddCertificate) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		LOGGER_ARG("certificate");
 		WCertificate *wCert = Wrapper::Unwrap<WCertificate>(info[0]->ToObject());
@@ -266,11 +297,12 @@ NAN_METHOD(WSignedData::GetContent) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		Handle<std::string> buf = _this->getContent()->read();
 		_this->getContent()->reset();
 
-		info.GetReturnValue().Set(stringToBuffer(buf));
+		info.GetReturnValue().Set(stringToBuffer(std::move(buf)));
 		return;
 	}
 	TRY_END();
@@ -284,6 +316,7 @@ NAN_METHOD(WSignedData::SetContent) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		Handle<Bio> buffer;
 
@@ -291,7 +324,8 @@ NAN_METHOD(WSignedData::SetContent) {
 			LOGGER_INFO("Set content from file");
 			v8::String::Utf8Value v8Filename(info[0]->ToString());
 
-			BIO *pBuffer = BIO_new_file(*v8Filename, "rb");
+			/* Mapped until the content is replaced, truncating the file raises SIGBUS */
+			BIO *pBuffer = BIO_new_mmap(*v8Filename);
 			if (!pBuffer){
 				Nan::ThrowError("File not found");
 				return;
@@ -302,10 +336,7 @@ NAN_METHOD(WSignedData::SetContent) {
 		}
 		else{
 			LOGGER_INFO("Set content from buffer");
-			v8::Local<v8::Object> v8Buffer = info[0]->ToObject();
-
-			BIO *pBuffer = BIO_new_mem_buf(node::Buffer::Data(v8Buffer), node::Buffer::Length(v8Buffer));
-			buffer = new Bio(pBuffer);
+			buffer = getBufferBio(info[0]);
 		}
 
 		_this->setContent(buffer);
@@ -320,6 +351,7 @@ NAN_METHOD(WSignedData::FreeContent) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		_this->freeContent();
 
@@ -337,6 +369,7 @@ NAN_METHOD(WSignedData::Verify) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		WCertificateCollection *wcerts = WCertificateCollection::Unwrap<WCertificateCollection>(info[0]->ToObject());
 
@@ -354,8 +387,225 @@ NAN_METHOD(WSignedData::Sign) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 		
 		_this->sign();
+		WRAP_EXTERNAL_MEMORY(SignedData);
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* Workers keep the JS object of SignedData (and of other arguments) in
+* persistent storage, so wrapped data is not released while they run.
+*/
+
+/* External memory may be reported on the JS thread only */
+static void updateSignedDataMemory(PoolWorker *worker, Handle<SignedData> sd){
+	v8::Local<v8::Object> obj = worker->GetFromPersistent("signedData").As<v8::Object>();
+	WSignedData *wSd = (WSignedData *)Nan::GetInternalFieldPointer(obj, 0);
+	wSd->setExternalMemory(WSignedData::externalSize(sd));
+}
+
+/*
+* Base of the jobs of one SignedData. The job is counted in
+* WSignedData::jobs_ from queueing to its end, run() is called under
+* WSignedData::lock_.
+*/
+class SignedDataWorker : public PoolWorker {
+public:
+	SignedDataWorker(Nan::Callback *callback, const char *resourceName, WSignedData *wsd)
+		: PoolWorker(callback, resourceName), sd_(wsd->data_), lock_(&wsd->lock_), jobs_(&wsd->jobs_), released_(false){
+		jobs_->fetch_add(1);
+	};
+
+	~SignedDataWorker(){
+		release();
+	}
+
+	void Process(){
+		LOGGER_FN();
+
+		try{
+			std::lock_guard<std::mutex> lock(*this->lock_);
+			run();
+		}
+		catch (...){
+			release();
+			throw;
+		}
+		release();
+	}
+
+	/* Job cancelled before the start does not run Process */
+	void HandleErrorCallback(){
+		release();
+		PoolWorker::HandleErrorCallback();
+	}
+
+protected:
+	virtual void run() = 0;
+
+	void release(){
+		if (!this->released_){
+			this->released_ = true;
+			this->jobs_->fetch_sub(1);
+		}
+	}
+
+	Handle<SignedData> sd_;
+
+private:
+	std::mutex *lock_;
+	std::atomic<int> *jobs_;
+	bool released_;
+};
+
+class SignedDataLoadWorker : public SignedDataWorker {
+public:
+	SignedDataLoadWorker(Nan::Callback *callback, WSignedData *wsd, const char *filename, int format)
+		: SignedDataWorker(callback, "trusted:SignedData.load", wsd), filename_(filename), format_(format){};
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		updateSignedDataMemory(this, this->sd_);
+		PoolWorker::HandleOKCallback();
+	}
+
+protected:
+	void run(){
+		Handle<Bio> in = new Bio(BIO_TYPE_MMAP, this->filename_.c_str());
+
+		DataFormat::DATA_FORMAT format = this->format_ < 0 ?
+			getCmsFileType(in) :
+			DataFormat::get(this->format_);
+
+		this->sd_->read(in, format);
+	}
+
+	std::string filename_;
+	int format_;
+};
+
+class SignedDataVerifyWorker : public SignedDataWorker {
+public:
+	SignedDataVerifyWorker(Nan::Callback *callback, WSignedData *wsd, Handle<CertificateCollection> certs)
+		: SignedDataWorker(callback, "trusted:SignedData.verify", wsd), certs_(certs), res_(false){};
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		v8::Local<v8::Value> argv[] = {
+			Nan::Null(),
+			Nan::New<v8::Boolean>(this->res_)
+		};
+
+		callback->Call(2, argv, async_resource);
+	}
+
+protected:
+	void run(){
+		this->res_ = this->sd_->verify(this->certs_);
+		this->sd_->getContent()->reset();
+	}
+
+	Handle<CertificateCollection> certs_;
+	bool res_;
+};
+
+class SignedDataSignWorker : public SignedDataWorker {
+public:
+	SignedDataSignWorker(Nan::Callback *callback, WSignedData *wsd)
+		: SignedDataWorker(callback, "trusted:SignedData.sign", wsd){};
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		updateSignedDataMemory(this, this->sd_);
+		PoolWorker::HandleOKCallback();
+	}
+
+protected:
+	void run(){
+		this->sd_->sign();
+	}
+};
+
+/*
+* filename: String
+* format: DataFormat
+* done: Function
+*/
+NAN_METHOD(WSignedData::LoadAsync) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(SignedData);
+
+		LOGGER_ARG("filename");
+		v8::String::Utf8Value v8Filename(info[0]->ToString());
+
+		LOGGER_ARG("format");
+		int format = (info[1]->IsUndefined() || !info[1]->IsNumber()) ?
+			-1 :
+			info[1]->ToNumber()->Int32Value();
+
+		LOGGER_ARG("done");
+		Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+
+		SignedDataLoadWorker *worker = new SignedDataLoadWorker(callback, __obj, *v8Filename, format);
+		worker->SaveToPersistent("signedData", info.This());
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)PoolWorker::Queue(worker)));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* certs: CertificateCollection
+* done: Function
+*/
+NAN_METHOD(WSignedData::VerifyAsync) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(SignedData);
+
+		LOGGER_ARG("certs");
+		WCertificateCollection *wcerts = WCertificateCollection::Unwrap<WCertificateCollection>(info[0]->ToObject());
+
+		LOGGER_ARG("done");
+		Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+
+		SignedDataVerifyWorker *worker = new SignedDataVerifyWorker(callback, __obj, wcerts->data_);
+		worker->SaveToPersistent("signedData", info.This());
+		worker->SaveToPersistent("certs", info[0]->ToObject());
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)PoolWorker::Queue(worker)));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* done: Function
+*/
+NAN_METHOD(WSignedData::SignAsync) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(SignedData);
+
+		LOGGER_ARG("done");
+		Nan::Callback *callback = new Nan::Callback(info[0].As<v8::Function>());
+
+		SignedDataSignWorker *worker = new SignedDataSignWorker(callback, __obj);
+		worker->SaveToPersistent("signedData", info.This());
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)PoolWorker::Queue(worker)));
 		return;
 	}
 	TRY_END();
@@ -366,6 +616,7 @@ NAN_METHOD(WSignedData::GetFlags) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		info.GetReturnValue().Set(Nan::New<v8::Number>(_this->getFlags()));
 		return;
@@ -381,6 +632,7 @@ NAN_METHOD(WSignedData::SetFlags) {
 
 	try {
 		UNWRAP_DATA(SignedData);
+		SIGNED_DATA_CHECK_BUSY();
 
 		int flags = info[0]->ToNumber()->Uint32Value();
 		_this->setFlags(flags);
@@ -3,20 +3,26 @@
 
 #include <wrapper/cms/common.h>
 
+#include <atomic>
+#include <mutex>
+
 #include <nan.h>
 #include "../utils/wrap.h"
 #include "../helper.h"
+#include "../utils/worker.h"
 
 WRAP_CLASS(SignedData)
 {
 public:
-	WSignedData(){};
+	WSignedData() : jobs_(0){};
 	~WSignedData(){};
 
 	static const char* className;
 
 	WRAP_NEW_INSTANCE(SignedData);
 
+	static size_t externalSize(Handle<SignedData> data);
+
 	static void Init(v8::Handle<v8::Object>);
 	static NAN_METHOD(New);
 
@@ -39,6 +45,16 @@ public:
 	static NAN_METHOD(IsDetached);
 	static NAN_METHOD(Verify);
 	static NAN_METHOD(Sign);
+
+	// Methods running on the native thread pool
+	static NAN_METHOD(LoadAsync);
+	static NAN_METHOD(VerifyAsync);
+	static NAN_METHOD(SignAsync);
+
+	/* CMS and its content BIO are shared by the jobs, they are serialized */
+	std::mutex lock_;
+	/* Queued and running async jobs, other methods throw while it is not 0 */
+	std::atomic<int> jobs_;
 };
 
 #endif //!CMS_W_SIGNED_DATA_H_INCLUDED
\ No newline at end of file
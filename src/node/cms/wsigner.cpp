@@ -66,23 +66,18 @@ NAN_METHOD(WSigner::VerifyContent) {
 			LOGGER_INFO("Set content from file");
 			v8::String::Utf8Value v8Filename(info[0]->ToString());
 
-			BIO *pBuffer = BIO_new_file(*v8Filename, "rb");
+			/* Mapped file, it must not be truncated while it is hashed (SIGBUS) */
+			BIO *pBuffer = BIO_new_mmap(*v8Filename);
 			if (!pBuffer){
 				Nan::ThrowError("File not found");
 				return;
 			}
 
-			Handle<std::string> in = (new Bio(pBuffer))->read();
-			BIO *mem = BIO_new(BIO_s_mem());
-			BIO_write(mem, in->c_str(), in->length());
-			buffer = new Bio(mem);
+			buffer = new Bio(pBuffer);
 		}
 		else{
 			LOGGER_INFO("Set content from buffer");
-			v8::Local<v8::Object> v8Buffer = info[0]->ToObject();
-
-			BIO *pBuffer = BIO_new_mem_buf(node::Buffer::Data(v8Buffer), node::Buffer::Length(v8Buffer));
-			buffer = new Bio(pBuffer);
+			buffer = getBufferBio(info[0]);
 		}
 
 		res = _this->verify(buffer);
@@ -1,5 +1,9 @@
 #include "stdafx.h"
 
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "helper.h"
 
 /**
@@ -38,12 +42,63 @@ char *copyBufferToUtf8String(const v8::Local<v8::String> str) {
 	return result;
 }
 
+/* The Buffer owns the Handle, so the string lives while the Buffer does */
+static void freeStringBuffer(char *data, void *hint)
+{
+	delete (Handle<std::string> *)hint;
+}
+
 v8::Local<v8::Object> stringToBuffer(Handle<std::string> v){
-    v8::Local<v8::Object> v8Buf = Nan::NewBuffer(v->length()).ToLocalChecked();
-    char* pbuf = node::Buffer::Data(v8Buf);
-    memcpy(pbuf, v->c_str(), v->length());                
+	/* Storage of a string with other owners can be changed by them, it is copied */
+	if (v->length() < EXTERNAL_BUFFER_MIN || v.getRCObject().isShared()){
+		return Nan::CopyBuffer(v->c_str(), v->length()).ToLocalChecked();
+	}
+
+	return Nan::NewBuffer(&(*v)[0], v->length(), freeStringBuffer, new Handle<std::string>(std::move(v))).ToLocalChecked();
+}
+
+/* One-byte string data kept by V8 without copying into its heap */
+class ExternalStringResource : public Nan::ExternalOneByteStringResource {
+public:
+	ExternalStringResource(Handle<std::string> v) : data_(v){};
+
+	const char *data() const { return this->data_->c_str(); };
+	size_t length() const { return this->data_->length(); };
+
+protected:
+	Handle<std::string> data_;
+};
+
+static bool isAscii(const std::string &v){
+	for (size_t i = 0; i < v.length(); i++){
+		if ((unsigned char)v[i] & 0x80){
+			return false;
+		}
+	}
+	return true;
+}
+
+v8::Local<v8::String> stringToV8String(Handle<std::string> v){
+	/* One-byte strings are Latin-1, so only ASCII subset of UTF-8 can be shared */
+	if (v->length() >= EXTERNAL_STRING_MIN && isAscii(*v)){
+		return Nan::New<v8::String>(new ExternalStringResource(v)).ToLocalChecked();
+	}
+
+	return Nan::New<v8::String>(v->c_str(), (int)v->length()).ToLocalChecked();
+}
+
+v8::Local<v8::String> stringToHex(Handle<std::string> v){
+	static const char digits[] = "0123456789abcdef";
+
+	std::string res;
+	res.reserve(v->length() * 2);
+	for (size_t i = 0; i < v->length(); i++){
+		unsigned char c = (unsigned char)(*v)[i];
+		res += digits[c >> 4];
+		res += digits[c & 0x0f];
+	}
 
-	return v8Buf;
+	return Nan::New<v8::String>(res).ToLocalChecked();
 }
 
 Handle<std::string> getString(v8::Local<v8::String> v8String){
@@ -70,6 +125,194 @@ Handle<std::string> getBuffer(v8::Local<v8::Value> v8Value)
 	return buffer;
 }
 
+/*
+* Persistent handles of BufferBio can be reset on their JS thread only.
+* Handles released on other threads are passed to the event loop by
+* uv_async_t. The queue is freed when its JS thread is stopped and the
+* last BufferBio of the thread is released.
+*/
+class BufferReleaseQueue{
+public:
+	BufferReleaseQueue(uv_loop_t *loop)
+		: loop_(loop), thread_(std::this_thread::get_id()), live_(0), closed_(false)
+	{
+		uv_async_init(loop, &this->async_, BufferReleaseQueue::onRelease);
+		this->async_.data = this;
+		uv_unref((uv_handle_t *)&this->async_);
+	}
+
+	/* Called on the JS thread for the new BufferBio */
+	void retain(){
+		std::lock_guard<std::mutex> lock(this->lock_);
+		this->live_++;
+	}
+
+	void release(Nan::Persistent<v8::Object> *buffer){
+		bool free;
+		{
+			std::lock_guard<std::mutex> lock(this->lock_);
+			if (!this->closed_ && std::this_thread::get_id() != this->thread_){
+				this->buffers_.push_back(buffer);
+				uv_async_send(&this->async_);
+				return;
+			}
+
+			/* Handles of the stopped JS thread are not reset, its isolate is disposed */
+			if (!this->closed_){
+				buffer->Reset();
+			}
+			delete buffer;
+			free = --this->live_ == 0 && !this->async_.data;
+		}
+		if (free){
+			delete this;
+		}
+	}
+
+	/* Called when the JS thread stops */
+	void close(){
+		std::deque<Nan::Persistent<v8::Object> *> buffers;
+		{
+			std::lock_guard<std::mutex> lock(this->lock_);
+			this->closed_ = true;
+			buffers.swap(this->buffers_);
+			this->live_ -= buffers.size();
+		}
+		resetAll(buffers);
+
+		uv_close((uv_handle_t *)&this->async_, BufferReleaseQueue::onClose);
+		uv_run(this->loop_, UV_RUN_NOWAIT);
+	}
+
+protected:
+	static void resetAll(std::deque<Nan::Persistent<v8::Object> *> &buffers){
+		for (size_t i = 0; i < buffers.size(); i++){
+			buffers[i]->Reset();
+			delete buffers[i];
+		}
+	}
+
+	static void onClose(uv_handle_t *handle){
+		BufferReleaseQueue *queue = (BufferReleaseQueue *)handle->data;
+
+		std::unique_lock<std::mutex> lock(queue->lock_);
+		handle->data = NULL;
+		if (!queue->live_){
+			lock.unlock();
+			delete queue;
+		}
+	}
+
+	static void onRelease(uv_async_t *handle
+#if UV_VERSION_MAJOR == 0
+		, int
+#endif
+		){
+		BufferReleaseQueue *queue = (BufferReleaseQueue *)handle->data;
+
+		std::deque<Nan::Persistent<v8::Object> *> buffers;
+		{
+			std::lock_guard<std::mutex> lock(queue->lock_);
+			buffers.swap(queue->buffers_);
+			queue->live_ -= buffers.size();
+		}
+		resetAll(buffers);
+	}
+
+protected:
+	uv_loop_t *loop_;
+	uv_async_t async_;
+	std::thread::id thread_;
+	std::mutex lock_;
+	std::deque<Nan::Persistent<v8::Object> *> buffers_;
+	/* BufferBio of the queue which are not released yet */
+	size_t live_;
+	bool closed_;
+};
+
+static thread_local BufferReleaseQueue *bufferReleaseQueue = NULL;
+
+#if NODE_MAJOR_VERSION >= 10
+static void closeBufferReleaseQueue(void *arg){
+	((BufferReleaseQueue *)arg)->close();
+	bufferReleaseQueue = NULL;
+}
+#endif
+
+/* Created on the first use from the JS thread */
+static BufferReleaseQueue *getBufferReleaseQueue(){
+	if (!bufferReleaseQueue){
+		bufferReleaseQueue = new BufferReleaseQueue(Nan::GetCurrentEventLoop());
+#if NODE_MAJOR_VERSION >= 10
+		node::AddEnvironmentCleanupHook(v8::Isolate::GetCurrent(), closeBufferReleaseQueue, bufferReleaseQueue);
+#endif
+	}
+	return bufferReleaseQueue;
+}
+
+BufferBio::BufferBio(v8::Local<v8::Object> v8Buffer)
+	: Bio(node::Buffer::Data(v8Buffer), node::Buffer::Length(v8Buffer)),
+	buffer_(new Nan::Persistent<v8::Object>(v8Buffer)), queue_(getBufferReleaseQueue())
+{
+	LOGGER_FN();
+
+	this->queue_->retain();
+}
+
+BufferBio::~BufferBio()
+{
+	LOGGER_FN();
+
+	this->queue_->release(this->buffer_);
+}
+
+bool getStringArray(v8::Local<v8::Value> v8Value, std::vector<std::string> &res)
+{
+	LOGGER_FN();
+
+	if (v8Value->IsUndefined()){
+		return true;
+	}
+	if (!v8Value->IsArray()){
+		return false;
+	}
+
+	v8::Local<v8::Array> v8Array = v8::Local<v8::Array>::Cast(v8Value);
+	for (unsigned int i = 0; i < v8Array->Length(); i++) {
+		if (Nan::Has(v8Array, i).FromJust()) {
+			v8::String::Utf8Value v8Item(Nan::Get(v8Array, i).ToLocalChecked()->ToString());
+			res.push_back(std::string(*v8Item));
+		}
+	}
+
+	return true;
+}
+
+Handle<Bio> getBufferBio(v8::Local<v8::Value> v8Value)
+{
+	LOGGER_FN();
+
+	return new BufferBio(v8Value->ToObject());
+}
+
+static void freeOpenSSLBuffer(char *data, void *hint)
+{
+	OPENSSL_free(data);
+}
+
+v8::Local<v8::Object> bioToBuffer(Handle<Bio> bio)
+{
+	LOGGER_FN();
+
+	size_t length = 0;
+	char *data = bio->detachBuffer(length);
+	if (!data){
+		return Nan::NewBuffer(0).ToLocalChecked();
+	}
+
+	return Nan::NewBuffer(data, length, freeOpenSSLBuffer, NULL).ToLocalChecked();
+}
+
 Handle<std::string> getErrorText(Handle<Exception> e)
 {
 	LOGGER_FN();
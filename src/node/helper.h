@@ -21,12 +21,61 @@ void scheduleAllocException();
 * success. On failure, schedules an exception and returns NULL.
 */
 char *copyBufferToUtf8String(const v8::Local<v8::String> str);
+
+/*
+* Strings shorter than these limits are copied, as V8 copies them
+* faster than it registers external data
+*/
+#define EXTERNAL_BUFFER_MIN 1024
+#define EXTERNAL_STRING_MIN 64
+
+/*
+* Big strings are moved to the Buffer without copy if the Handle is the only
+* owner (pass it with std::move), shared strings are copied
+*/
 v8::Local<v8::Object> stringToBuffer(Handle<std::string> v);
+/* Big ASCII strings are shared with V8 as external strings */
+v8::Local<v8::String> stringToV8String(Handle<std::string> v);
+/* Lower case hex of binary string (thumbprints, hashes) */
+v8::Local<v8::String> stringToHex(Handle<std::string> v);
 //std::string getFileName(const v8::Local<v8::String> str);
 
 Handle<std::string> getString(v8::Local<v8::String> v8String);
 Handle<std::string> getBuffer(v8::Local<v8::Value> v8Value);
 
+/**
+* Convert Array of strings into vector. Undefined gives empty vector.
+* Returns false if the value is not Array.
+*/
+bool getStringArray(v8::Local<v8::Value> v8Value, std::vector<std::string> &res);
+
+class BufferReleaseQueue;
+
+/**
+* Read-only Bio over the memory of a Node Buffer without copy.
+* The Buffer is kept alive while the Bio exists, so the Bio may be stored
+* (e.g. as SignedData content). The last reference may be released on a
+* pool thread, then the persistent handle is reset on the JS thread of
+* the Buffer.
+*/
+class BufferBio : public Bio {
+public:
+	BufferBio(v8::Local<v8::Object> v8Buffer);
+	~BufferBio();
+
+protected:
+	Nan::Persistent<v8::Object> *buffer_;
+	BufferReleaseQueue *queue_;
+};
+
+Handle<Bio> getBufferBio(v8::Local<v8::Value> v8Value);
+
+/**
+* Move written data of memory Bio into a new Node Buffer without copy.
+* The Buffer frees the data by OPENSSL_free when it is collected.
+*/
+v8::Local<v8::Object> bioToBuffer(Handle<Bio> bio);
+
 Handle<std::string> getErrorText(Handle<Exception> e);
 DataFormat::DATA_FORMAT getCmsFileType(Handle<Bio> in);
 
@@ -57,4 +106,11 @@ DataFormat::DATA_FORMAT getCmsFileType(Handle<Bio> in);
 #define UNWRAP() \
 	UNWRAP_DATA(typeof(this->childData));
 
+/* Set property of plain object built by getInfo() methods */
+#define INFO_SET(obj, name, value) \
+	Nan::Set(obj, Nan::New(name).ToLocalChecked(), value)
+
+#define INFO_SET_STRING(obj, name, value) \
+	INFO_SET(obj, name, stringToV8String(value))
+
 #endif //NW_HELPER_H_INCLUDED
@@ -14,8 +14,12 @@
 #include "utils/wlog.h"
 #include "utils/wjwt.h"
 #include "utils/wcsp.h"
+#include "utils/wpool.h"
+#include "utils/wthread_pool.h"
 
 #include "pki/wkey.h"
+#include "pki/wkey_pool.h"
+#include "pki/wkey_cache.h"
 #include "pki/wcert.h"
 #include "pki/wpkcs12.h"
 #include "pki/wcerts.h"
@@ -31,6 +35,8 @@
 #include "pki/wcert_request_info.h"
 #include "pki/wcert_request.h"
 #include "pki/wcipher.h"
+#include "pki/wcipher_stream.h"
+#include "pki/wcipher_session.h"
 #include "pki/wchain.h"
 #include "pki/wrevocation.h"
 #include "store/wpkistore.h"
@@ -66,6 +72,8 @@ void init(v8::Handle<v8::Object> target) {
 
 	// LOGGER_TRACE("OpenSSL init");
 
+	// Init is called for every JS thread which loads the module,
+	// OpenSSL is initialized by the first call only.
 	OpenSSL::run();
 
 	v8::Local<v8::Object> OpenSSL = Nan::New<v8::Object>();
@@ -79,6 +87,8 @@ void init(v8::Handle<v8::Object> target) {
 	WJwt::Init(Utils);
 	WLogger::Init(Utils);
 	WCsp::Init(Utils);
+	WObjectPool::Init(Utils);
+	WThreadPool::Init(Utils);
 
 	v8::Local<v8::Object> Pki = Nan::New<v8::Object>();
 
@@ -95,9 +105,13 @@ void init(v8::Handle<v8::Object> target) {
 	WExtension::Init(Pki);
 	WExtensionCollection::Init(Pki);
 	WKey::Init(Pki);
+	WKeyPool::Init(Pki);
+	WKeyCache::Init(Pki);
 	WCertificationRequestInfo::Init(Pki);
 	WCertificationRequest::Init(Pki);
 	WCipher::Init(Pki);
+	WCipherStream::Init(Pki);
+	WCipherSession::Init(Pki);
 	WChain::Init(Pki);
 	WPkcs12::Init(Pki);
 	WRevocation::Init(Pki);
@@ -128,4 +142,9 @@ void init(v8::Handle<v8::Object> target) {
 	WCashJson::Init(PkiStore);
 }
 
-NODE_MODULE(trusted, init)
+// Module may be loaded by several worker_threads
+#if defined(NAN_MODULE_WORKER_ENABLED)
+NAN_MODULE_WORKER_ENABLED(trusted, init)
+#else
+NODE_MODULE(trusted, init)
+#endif
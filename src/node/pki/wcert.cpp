@@ -8,6 +8,15 @@
 
 const char* WCertificate::className = "Certificate";
 
+/* Decoded X509 takes about the same as its DER encoding */
+size_t WCertificate::externalSize(Handle<Certificate> data){
+	if (data.isEmpty() || data->isEmpty()){
+		return 0;
+	}
+	int len = i2d_X509(data->internal(), NULL);
+	return len > 0 ? (size_t)len : 0;
+}
+
 void WCertificate::Init(v8::Handle<v8::Object> exports) {
 	METHOD_BEGIN();
 
@@ -39,6 +48,7 @@ void WCertificate::Init(v8::Handle<v8::Object> exports) {
 	Nan::SetPrototypeMethod(tpl, "getExtensions", GetExtensions);
 	Nan::SetPrototypeMethod(tpl, "isSelfSigned", IsSelfSigned);
 	Nan::SetPrototypeMethod(tpl, "isCA", IsCA);
+	Nan::SetPrototypeMethod(tpl, "getInfo", GetInfo);
 
 	Nan::SetPrototypeMethod(tpl, "setSubjectName", SetSubjectName);
 	Nan::SetPrototypeMethod(tpl, "setIssuerName", SetIssuerName);
@@ -109,6 +119,7 @@ NAN_METHOD(WCertificate::Load) {
 		UNWRAP_DATA(Certificate);
 
 		_this->read(in, format);
+		WRAP_EXTERNAL_MEMORY(Certificate);
 
 		info.GetReturnValue().Set(info.This());
 		return;
@@ -125,18 +136,15 @@ NAN_METHOD(WCertificate::Import) {
 
 	try {
 		LOGGER_ARG("data");
-		char* buf = node::Buffer::Data(info[0]->ToObject());
-		size_t buflen = node::Buffer::Length(info[0]);
-		std::string buffer(buf, buflen);
+		Handle<Bio> in = getBufferBio(info[0]);
 
 		LOGGER_ARG("format");
 		int format = info[1]->ToNumber()->Int32Value();
 
 		UNWRAP_DATA(Certificate);
 
-		Handle<Bio> in = new Bio(BIO_TYPE_MEM, buffer);
-
 		_this->read(in, DataFormat::get(format));
+		WRAP_EXTERNAL_MEMORY(Certificate);
 
 		info.GetReturnValue().Set(info.This());
 		return;
@@ -186,10 +194,8 @@ NAN_METHOD(WCertificate::Export) {
 		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
 		_this->write(out, DataFormat::get(format));
 
-		Handle<std::string> buf = out->read();
-
 		info.GetReturnValue().Set(
-			stringToBuffer(buf)
+			bioToBuffer(out)
 			);
 		return;
 	}
@@ -204,7 +210,7 @@ NAN_METHOD(WCertificate::GetSubjectFriendlyName) {
 
 		Handle<std::string> fname = _this->getSubjectFriendlyName();
 
-		v8::Local<v8::String> v8FName = Nan::New<v8::String>(fname->c_str()).ToLocalChecked();
+		v8::Local<v8::String> v8FName = stringToV8String(fname);
 
 		info.GetReturnValue().Set(v8FName);
 		return;
@@ -220,7 +226,7 @@ NAN_METHOD(WCertificate::GetIssuerFriendlyName) {
 
 		Handle<std::string> fname = _this->getIssuerFriendlyName();
 
-		v8::Local<v8::String> v8FName = Nan::New<v8::String>(fname->c_str()).ToLocalChecked();
+		v8::Local<v8::String> v8FName = stringToV8String(fname);
 
 		info.GetReturnValue().Set(v8FName);
 		return;
@@ -236,7 +242,7 @@ NAN_METHOD(WCertificate::GetSubjectName) {
 
 		Handle<std::string> name = _this->getSubjectName();
 
-		v8::Local<v8::String> v8Name = Nan::New<v8::String>(name->c_str()).ToLocalChecked();
+		v8::Local<v8::String> v8Name = stringToV8String(name);
 
 		info.GetReturnValue().Set(v8Name);
 		return;
@@ -252,7 +258,7 @@ NAN_METHOD(WCertificate::GetIssuerName) {
 
 		Handle<std::string> name = _this->getIssuerName();
 
-		v8::Local<v8::String> v8Name = Nan::New<v8::String>(name->c_str()).ToLocalChecked();
+		v8::Local<v8::String> v8Name = stringToV8String(name);
 
 		info.GetReturnValue().Set(v8Name);
 		return;
@@ -583,6 +589,53 @@ NAN_METHOD(WCertificate::IsCA) {
 	TRY_END();
 }
 
+static v8::Local<v8::Array> stringsToArray(const std::vector<std::string> &v){
+	v8::Local<v8::Array> res = Nan::New<v8::Array>(v.size());
+
+	for (size_t i = 0; i < v.size(); i++){
+		Nan::Set(res, i, Nan::New<v8::String>(v[i]).ToLocalChecked());
+	}
+
+	return res;
+}
+
+/*
+* Return all read only properties by one call
+*/
+NAN_METHOD(WCertificate::GetInfo) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(Certificate);
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+
+		INFO_SET(res, "version", Nan::New<v8::Number>(_this->getVersion()));
+		INFO_SET_STRING(res, "subjectFriendlyName", _this->getSubjectFriendlyName());
+		INFO_SET_STRING(res, "issuerFriendlyName", _this->getIssuerFriendlyName());
+		INFO_SET_STRING(res, "subjectName", _this->getSubjectName());
+		INFO_SET_STRING(res, "issuerName", _this->getIssuerName());
+		INFO_SET_STRING(res, "notBefore", _this->getNotBefore());
+		INFO_SET_STRING(res, "notAfter", _this->getNotAfter());
+		INFO_SET_STRING(res, "serialNumber", _this->getSerialNumber());
+		INFO_SET(res, "thumbprint", stringToHex(_this->getThumbprint()));
+		INFO_SET(res, "type", Nan::New<v8::Number>(_this->getType()));
+		INFO_SET(res, "keyUsage", Nan::New<v8::Number>(_this->getKeyUsage()));
+		INFO_SET_STRING(res, "signatureAlgorithm", _this->getSignatureAlgorithm());
+		INFO_SET_STRING(res, "signatureDigestAlgorithm", _this->getSignatureDigestAlgorithm());
+		INFO_SET_STRING(res, "publicKeyAlgorithm", _this->getPublicKeyAlgorithm());
+		INFO_SET_STRING(res, "organizationName", _this->getOrganizationName());
+		INFO_SET(res, "OCSPUrls", stringsToArray(_this->getOCSPUrls()));
+		INFO_SET(res, "CAIssuersUrls", stringsToArray(_this->getCAIssuersUrls()));
+		INFO_SET(res, "isSelfSigned", Nan::New<v8::Boolean>(_this->isSelfSigned()));
+		INFO_SET(res, "isCA", Nan::New<v8::Boolean>(_this->isCA()));
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCertificate::SetSubjectName){
 	METHOD_BEGIN();
 
@@ -755,6 +808,7 @@ NAN_METHOD(WCertificate::Sign){
 		}
 
 		_this->sign(wKey->data_, digest);
+		WRAP_EXTERNAL_MEMORY(Certificate);
 
 		return;
 	}
@@ -17,6 +17,8 @@ public:
 
 	WRAP_NEW_INSTANCE(Certificate);
 
+	static size_t externalSize(Handle<Certificate> data);
+
 	static void Init(v8::Handle<v8::Object>);
 	static NAN_METHOD(New);
 	
@@ -41,6 +43,7 @@ public:
 	static NAN_METHOD(GetExtensions);
 	static NAN_METHOD(IsSelfSigned);
 	static NAN_METHOD(IsCA);
+	static NAN_METHOD(GetInfo);
 
 	static NAN_METHOD(SetSubjectName);
 	static NAN_METHOD(SetIssuerName);
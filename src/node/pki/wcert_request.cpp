@@ -297,9 +297,10 @@ NAN_METHOD(WCertificationRequest::GetPEMString) {
 	try {
 		UNWRAP_DATA(CertificationRequest);
 
-		Handle<std::string> encCSR = _this->getPEMString();
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		_this->write(out, DataFormat::BASE64);
 
-		info.GetReturnValue().Set(stringToBuffer(encCSR));
+		info.GetReturnValue().Set(bioToBuffer(out));
 		return;
 	}
 	TRY_END();
@@ -3,11 +3,29 @@
 #include <node_buffer.h>
 
 #include "wcipher.h"
+#include "wcipher_stream.h"
+#include "wcipher_session.h"
 #include "wcerts.h"
 #include "wcert.h"
 #include "wkey.h"
 #include "../cms/wcmsRecipientInfos.h"
 
+/*
+* Input files are memory mapped (BIO_TYPE_MMAP). A file truncated by
+* another process during encrypt/decrypt crashes the process with SIGBUS.
+*/
+
+/*
+* Async jobs run on the pool under lock_. Methods of the JS thread do not
+* wait for them: they throw while a job of the object is queued or running,
+* so the event loop is not blocked and parameters are not changed under it.
+*/
+#define CIPHER_CHECK_BUSY() \
+	if (__obj->jobs_.load() > 0){ \
+		Nan::ThrowError("Cipher is busy: async operation is in progress"); \
+		return; \
+	}
+
 void WCipher::Init(v8::Handle<v8::Object> exports){
 	METHOD_BEGIN();
 
@@ -23,6 +41,11 @@ void WCipher::Init(v8::Handle<v8::Object> exports){
 
 	Nan::SetPrototypeMethod(tpl, "encrypt", Encrypt);
 	Nan::SetPrototypeMethod(tpl, "decrypt", Decrypt);
+	Nan::SetPrototypeMethod(tpl, "encryptAsync", EncryptAsync);
+	Nan::SetPrototypeMethod(tpl, "decryptAsync", DecryptAsync);
+	Nan::SetPrototypeMethod(tpl, "createStream", CreateStream);
+	Nan::SetPrototypeMethod(tpl, "decryptRange", DecryptRange);
+	Nan::SetPrototypeMethod(tpl, "createSession", CreateSession);
 
 	Nan::SetPrototypeMethod(tpl, "addRecipientsCerts", AddRecipientsCerts);
 	Nan::SetPrototypeMethod(tpl, "setPrivKey", SetPrivKey);
@@ -34,10 +57,17 @@ void WCipher::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "setPass", SetPass);
 	Nan::SetPrototypeMethod(tpl, "setIV", SetIV);
 	Nan::SetPrototypeMethod(tpl, "setKey", SetKey);
+	Nan::SetPrototypeMethod(tpl, "setAead", SetAead);
+	Nan::SetPrototypeMethod(tpl, "setSegmentSize", SetSegmentSize);
+	Nan::SetPrototypeMethod(tpl, "setThreads", SetThreads);
+	Nan::SetPrototypeMethod(tpl, "setBufferSize", SetBufferSize);
+	Nan::SetPrototypeMethod(tpl, "setKdf", SetKdf);
 
 	Nan::SetPrototypeMethod(tpl, "getSalt", GetSalt);
 	Nan::SetPrototypeMethod(tpl, "getIV", GetIV);
 	Nan::SetPrototypeMethod(tpl, "getKey", GetKey);
+	Nan::SetPrototypeMethod(tpl, "getAead", GetAead);
+	Nan::SetPrototypeMethod(tpl, "getKdf", GetKdf);
 
 	Nan::SetPrototypeMethod(tpl, "getAlgorithm", GetAlgorithm);
 	Nan::SetPrototypeMethod(tpl, "getMode", GetMode);
@@ -72,6 +102,7 @@ NAN_METHOD(WCipher::SetCryptoMethod) {
 		int method = info[0]->ToNumber()->Int32Value();
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setCryptoMethod(CryptoMethod::get(method));
 
@@ -96,14 +127,15 @@ NAN_METHOD(WCipher::Encrypt) {
 		LOGGER_ARG("format");
 		int format = info[2]->ToNumber()->Int32Value();
 
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
 		Handle<Bio> inSource = NULL;
 		Handle<Bio> outEnc = NULL;
 
-		inSource = new Bio(BIO_TYPE_FILE, filenameSource, "rb");
+		inSource = new Bio(BIO_TYPE_MMAP, filenameSource);
 		outEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "wb");
 
-		UNWRAP_DATA(Cipher);
-
 		_this->encrypt(inSource, outEnc, DataFormat::get(format));
 
 		info.GetReturnValue().Set(info.This());
@@ -124,10 +156,13 @@ NAN_METHOD(WCipher::Decrypt) {
 		v8::String::Utf8Value v8FilenameDec(info[1]->ToString());
 		char *filenameDec = *v8FilenameDec;
 
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
 		Handle<Bio> inEnc = NULL;
 		Handle<Bio> outDec = NULL;
 
-		inEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "rb");
+		inEnc = new Bio(BIO_TYPE_MMAP, filenameEnc);
 		outDec = new Bio(BIO_TYPE_FILE, filenameDec, "wb");
 
 		LOGGER_ARG("format");
@@ -135,11 +170,263 @@ NAN_METHOD(WCipher::Decrypt) {
 			getCmsFileType(inEnc) :
 			DataFormat::get(info[1]->ToNumber()->Int32Value());
 
+		try{
+			_this->decrypt(inEnc, outDec, format);
+		}
+		catch (...){
+			/* AEAD plaintext is written before the tag check, output of the failed decryption is removed */
+			outDec.empty();
+			remove(filenameDec);
+			throw;
+		}
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* Encrypts or decrypts Buffer or file into memory. Buffer input is read
+* in place, result is moved into the Buffer passed to the callback.
+* The job is counted in WCipher::jobs_ from queueing to its end; key and
+* certificates set to the Cipher are kept by its handles until then.
+*/
+class CipherWorker : public PoolWorker {
+public:
+	CipherWorker(Nan::Callback *callback, WCipher *wcipher, bool encrypt, int format)
+		: PoolWorker(callback, encrypt ? "trusted:Cipher.encrypt" : "trusted:Cipher.decrypt", ThreadPool::Low),
+		cipher_(wcipher->data_), lock_(&wcipher->lock_), jobs_(&wcipher->jobs_), released_(false),
+		encrypt_(encrypt), format_(format){
+		jobs_->fetch_add(1);
+	};
+
+	~CipherWorker(){
+		release();
+	}
+
+	/* Buffer is referenced by the Bio, it is read on the pool thread */
+	void setInput(Handle<Bio> in){
+		this->in_ = in;
+	}
+
+	void setInput(const char *filename){
+		this->filename_ = filename;
+	}
+
+	void Process(){
+		LOGGER_FN();
+
+		try{
+			run();
+		}
+		catch (...){
+			release();
+			throw;
+		}
+		release();
+	}
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		v8::Local<v8::Value> argv[] = {
+			Nan::Null(),
+			bioToBuffer(this->out_)
+		};
+
+		callback->Call(2, argv, async_resource);
+	}
+
+	/* Job cancelled before the start does not run Process */
+	void HandleErrorCallback(){
+		release();
+		PoolWorker::HandleErrorCallback();
+	}
+
+protected:
+	void run(){
+		Handle<Bio> in = this->in_;
+		if (in.isEmpty()){
+			in = new Bio(BIO_TYPE_MMAP, this->filename_.c_str());
+		}
+
+		this->out_ = new Bio(BIO_TYPE_MEM, "");
+
+		std::lock_guard<std::mutex> lock(*this->lock_);
+		if (this->encrypt_){
+			this->cipher_->encrypt(in, this->out_, DataFormat::get(this->format_));
+		}
+		else{
+			DataFormat::DATA_FORMAT format = this->format_ < 0 ?
+				getCmsFileType(in) :
+				DataFormat::get(this->format_);
+
+			this->cipher_->decrypt(in, this->out_, format);
+		}
+	}
+
+	void release(){
+		if (!this->released_){
+			this->released_ = true;
+			this->jobs_->fetch_sub(1);
+		}
+	}
+
+	Handle<Cipher> cipher_;
+	std::mutex *lock_;
+	std::atomic<int> *jobs_;
+	bool released_;
+	bool encrypt_;
+	int format_;
+	Handle<Bio> in_;
+	std::string filename_;
+	Handle<Bio> out_;
+};
+
+/*
+* Queue worker for data: String (file name) | Buffer. Return job id
+*/
+static unsigned long long queueCipherWorker(const Nan::FunctionCallbackInfo<v8::Value> &info, bool encrypt){
+	LOGGER_ARG("format");
+	int format = (info[1]->IsUndefined() || !info[1]->IsNumber()) ?
+		-1 :
+		info[1]->ToNumber()->Int32Value();
+
+	if (encrypt && format < 0){
+		format = DataFormat::DER;
+	}
+
+	LOGGER_ARG("done");
+	Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+
+	WCipher *wcipher = WCipher::Unwrap<WCipher>(info.This());
+	CipherWorker *worker = new CipherWorker(callback, wcipher, encrypt, format);
+	worker->SaveToPersistent("cipher", info.This());
+
+	LOGGER_ARG("data");
+	if (info[0]->IsString()){
+		v8::String::Utf8Value v8Filename(info[0]->ToString());
+		worker->setInput(*v8Filename);
+	}
+	else{
+		try{
+			worker->setInput(getBufferBio(info[0]));
+		}
+		catch (...){
+			delete worker;
+			throw;
+		}
+		worker->SaveToPersistent("data", info[0]);
+	}
+
+	return PoolWorker::Queue(worker);
+}
+
+/*
+* data: String | Buffer
+* format: DataFormat
+* done: Function
+*/
+NAN_METHOD(WCipher::EncryptAsync) {
+	METHOD_BEGIN();
+
+	try {
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)queueCipherWorker(info, true)));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* data: String | Buffer
+* format: DataFormat
+* done: Function
+*/
+NAN_METHOD(WCipher::DecryptAsync) {
+	METHOD_BEGIN();
+
+	try {
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)queueCipherWorker(info, false)));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* encrypt: Boolean
+*/
+NAN_METHOD(WCipher::CreateStream) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("encrypt");
+		bool encrypt = info[0]->BooleanValue();
+
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
-		_this->decrypt(inEnc, outDec, format);
+		Handle<CipherStream> stream = _this->createStream(encrypt);
 
-		info.GetReturnValue().Set(info.This());
+		info.GetReturnValue().Set(WCipherStream::NewInstance(stream));
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::CreateSession) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		Handle<CipherSession> session = _this->createSession();
+
+		info.GetReturnValue().Set(WCipherSession::NewInstance(session));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* data: String (file name) | Buffer
+* offset: Number
+* length: Number
+*/
+NAN_METHOD(WCipher::DecryptRange) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("data");
+		Handle<Bio> inEnc = NULL;
+		if (info[0]->IsString()){
+			v8::String::Utf8Value v8Filename(info[0]->ToString());
+			inEnc = new Bio(BIO_TYPE_MMAP, *v8Filename);
+		}
+		else{
+			inEnc = getBufferBio(info[0]);
+		}
+
+		LOGGER_ARG("offset");
+		double offset = info[1]->ToNumber()->Value();
+
+		LOGGER_ARG("length");
+		double length = info[2]->ToNumber()->Value();
+
+		if (offset < 0 || length < 0){
+			Nan::ThrowRangeError("Offset and length must be non-negative");
+			return;
+		}
+
+		Handle<Bio> outDec = new Bio(BIO_TYPE_MEM, "");
+
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		_this->decryptRange(inEnc, outDec, (unsigned long long)offset, (unsigned long long)length);
+
+		info.GetReturnValue().Set(bioToBuffer(outDec));
 		return;
 	}
 	TRY_END();
@@ -153,6 +440,7 @@ NAN_METHOD(WCipher::AddRecipientsCerts) {
 		WCertificateCollection * wCerts = WCertificateCollection::Unwrap<WCertificateCollection>(info[0]->ToObject());
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->addRecipientsCerts(wCerts->data_);
 
@@ -170,6 +458,7 @@ NAN_METHOD(WCipher::SetRecipientCert) {
 		WCertificate * wCert = WCertificate::Unwrap<WCertificate>(info[0]->ToObject());
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setRecipientCert(wCert->data_);
 
@@ -192,9 +481,10 @@ NAN_METHOD(WCipher::GetRecipientInfos) {
 
 		Handle<Bio> inEnc = NULL;
 
-		inEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "rb");
+		inEnc = new Bio(BIO_TYPE_MMAP, filenameEnc);
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<CmsRecipientInfoCollection> ris = _this->getRecipientInfos(inEnc, DataFormat::get(format));
 		v8::Local<v8::Object> v8Ris = WCmsRecipientInfoCollection::NewInstance(ris);
@@ -212,6 +502,7 @@ NAN_METHOD(WCipher::SetPrivKey) {
 		WKey * wKey = WKey::Unwrap<WKey>(info[0]->ToObject());
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setPrivKey(wKey->data_);
 
@@ -230,6 +521,7 @@ NAN_METHOD(WCipher::SetPass) {
 		char *pass = *v8Pass;
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setPass(new std::string(pass));
 
@@ -248,6 +540,7 @@ NAN_METHOD(WCipher::SetDigest) {
 		char *md = *v8MD;
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setDigest(new std::string(md));
 
@@ -266,6 +559,7 @@ NAN_METHOD(WCipher::SetIV) {
 		char *iv = *v8IV;
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setIV(new std::string(iv));
 
@@ -284,6 +578,7 @@ NAN_METHOD(WCipher::SetKey) {
 		char *key = *v8Key;
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setKey(new std::string(key));
 
@@ -302,6 +597,7 @@ NAN_METHOD(WCipher::SetSalt) {
 		char *salt = *v8Salt;
 
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		_this->setSalt(new std::string(salt));
 
@@ -316,6 +612,7 @@ NAN_METHOD(WCipher::GetSalt) {
 
 	try {
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<std::string> salt = _this->getSalt();
 
@@ -330,6 +627,7 @@ NAN_METHOD(WCipher::GetIV) {
 
 	try {
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<std::string> iv = _this->getIV();
 
@@ -344,6 +642,7 @@ NAN_METHOD(WCipher::GetKey) {
 
 	try {
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<std::string> key = _this->getKey();
 
@@ -358,6 +657,7 @@ NAN_METHOD(WCipher::GetAlgorithm) {
 
 	try {
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<std::string> calg = _this->getAlgorithm();
 		v8::Local<v8::String> v8Alg = Nan::New<v8::String>(calg->c_str()).ToLocalChecked();
@@ -368,11 +668,155 @@ NAN_METHOD(WCipher::GetAlgorithm) {
 	TRY_END();
 }
 
+NAN_METHOD(WCipher::SetAead) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("name");
+		v8::String::Utf8Value v8Name(info[0]->ToString());
+		char *name = *v8Name;
+
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		_this->setAead(new std::string(name));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::SetSegmentSize) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("size");
+		int size = info[0]->ToNumber()->Int32Value();
+		if (size < 0){
+			Nan::ThrowRangeError("Segment size must be non-negative");
+			return;
+		}
+
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		_this->setSegmentSize((unsigned int)size);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::SetThreads) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("threads");
+		int threads = info[0]->ToNumber()->Int32Value();
+		if (threads < 0){
+			Nan::ThrowRangeError("Count of threads must be non-negative");
+			return;
+		}
+
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		_this->setThreads((size_t)threads);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::SetBufferSize) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("size");
+		int size = info[0]->ToNumber()->Int32Value();
+
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		_this->setBufferSize(size);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* name: String
+* cost: Number. 0 - default
+*/
+NAN_METHOD(WCipher::SetKdf) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("name");
+		v8::String::Utf8Value v8Name(info[0]->ToString());
+		char *name = *v8Name;
+
+		LOGGER_ARG("cost");
+		int cost = info[1]->IsNumber() ? info[1]->ToNumber()->Int32Value() : 0;
+		if (cost < 0){
+			Nan::ThrowRangeError("Cost must be non-negative");
+			return;
+		}
+
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		_this->setKdf(new std::string(name), (unsigned int)cost);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::GetKdf) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		Handle<std::string> name = _this->getKdf();
+		v8::Local<v8::String> v8Name = Nan::New<v8::String>(name->c_str()).ToLocalChecked();
+
+		info.GetReturnValue().Set(v8Name);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::GetAead) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
+
+		Handle<std::string> name = _this->getAead();
+		v8::Local<v8::String> v8Name = Nan::New<v8::String>(name->c_str()).ToLocalChecked();
+
+		info.GetReturnValue().Set(v8Name);
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCipher::GetMode) {
 	METHOD_BEGIN();
 
 	try {
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<std::string> mode = _this->getMode();
 		v8::Local<v8::String> v8Mode = Nan::New<v8::String>(mode->c_str()).ToLocalChecked();
@@ -388,6 +832,7 @@ NAN_METHOD(WCipher::GetDigestAlgorithm) {
 
 	try {
 		UNWRAP_DATA(Cipher);
+		CIPHER_CHECK_BUSY();
 
 		Handle<std::string> dgst = _this->getDigestAlgorithm();
 		v8::Local<v8::String> v8Dgst = Nan::New<v8::String>(dgst->c_str()).ToLocalChecked();
@@ -3,12 +3,16 @@
 
 #include <wrapper/pki/cipher.h>
 
+#include <atomic>
+#include <mutex>
+
 #include <nan.h>
 #include "../helper.h"
+#include "../utils/worker.h"
 
 class WCipher : public node::ObjectWrap{
 public:
-	WCipher(){};
+	WCipher() : jobs_(0){};
 	~WCipher(){};
 
 	static void Init(v8::Handle<v8::Object>);
@@ -18,6 +22,11 @@ public:
 	
 	static NAN_METHOD(Encrypt);
 	static NAN_METHOD(Decrypt);
+	static NAN_METHOD(EncryptAsync);
+	static NAN_METHOD(DecryptAsync);
+	static NAN_METHOD(CreateStream);
+	static NAN_METHOD(DecryptRange);
+	static NAN_METHOD(CreateSession);
 
 	static NAN_METHOD(AddRecipientsCerts);
 	static NAN_METHOD(SetPrivKey);
@@ -29,10 +38,17 @@ public:
 	static NAN_METHOD(SetPass);
 	static NAN_METHOD(SetIV);
 	static NAN_METHOD(SetKey);
+	static NAN_METHOD(SetAead);
+	static NAN_METHOD(SetSegmentSize);
+	static NAN_METHOD(SetThreads);
+	static NAN_METHOD(SetBufferSize);
+	static NAN_METHOD(SetKdf);
 
 	static NAN_METHOD(GetSalt);
 	static NAN_METHOD(GetIV);
 	static NAN_METHOD(GetKey);
+	static NAN_METHOD(GetAead);
+	static NAN_METHOD(GetKdf);
 
 	static NAN_METHOD(GetAlgorithm);
 	static NAN_METHOD(GetMode);
@@ -40,8 +56,13 @@ public:
 
 	Handle<Cipher> data_;
 
+	/* Cipher keeps state of the current operation, async jobs are serialized */
+	std::mutex lock_;
+	/* Queued and running async jobs, other methods throw while it is not 0 */
+	std::atomic<int> jobs_;
+
 	static inline Nan::Persistent<v8::Function> & constructor() {
-		static Nan::Persistent<v8::Function> my_constructor;
+		static thread_local Nan::Persistent<v8::Function> my_constructor;
 		return my_constructor;
 	}
 };
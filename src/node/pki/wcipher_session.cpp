@@ -0,0 +1,100 @@
+#include "../stdafx.h"
+
+#include <node_buffer.h>
+
+#include "wcipher_session.h"
+
+void WCipherSession::Init(v8::Handle<v8::Object> exports){
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("CipherSession").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "encrypt", Encrypt);
+	Nan::SetPrototypeMethod(tpl, "decrypt", Decrypt);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+/*
+* Created by Cipher.createSession()
+*/
+NAN_METHOD(WCipherSession::New){
+	METHOD_BEGIN();
+
+	try{
+		WCipherSession *obj = new WCipherSession();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* message: Buffer
+*/
+NAN_METHOD(WCipherSession::Encrypt){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("message");
+		if (!node::Buffer::HasInstance(info[0])){
+			Nan::ThrowTypeError("Message must be a Buffer");
+			return;
+		}
+
+		UNWRAP_DATA(CipherSession);
+
+		size_t inl = node::Buffer::Length(info[0]);
+		PooledBuffer out(_this->encryptedLength(inl));
+		size_t outl;
+		{
+			std::lock_guard<std::mutex> lock(__obj->lock_);
+			outl = _this->encrypt((const unsigned char *)node::Buffer::Data(info[0]), inl, out.data());
+		}
+
+		info.GetReturnValue().Set(Nan::CopyBuffer((const char *)out.data(), (uint32_t)outl).ToLocalChecked());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* message: Buffer
+*/
+NAN_METHOD(WCipherSession::Decrypt){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("message");
+		if (!node::Buffer::HasInstance(info[0])){
+			Nan::ThrowTypeError("Message must be a Buffer");
+			return;
+		}
+
+		UNWRAP_DATA(CipherSession);
+
+		size_t inl = node::Buffer::Length(info[0]);
+		PooledBuffer out(inl);
+		size_t outl;
+		{
+			std::lock_guard<std::mutex> lock(__obj->lock_);
+			outl = _this->decrypt((const unsigned char *)node::Buffer::Data(info[0]), inl, out.data());
+		}
+
+		info.GetReturnValue().Set(Nan::CopyBuffer((const char *)out.data(), (uint32_t)outl).ToLocalChecked());
+		return;
+	}
+	TRY_END();
+}
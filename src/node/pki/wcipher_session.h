@@ -0,0 +1,29 @@
+#ifndef CMS_PKI_WCIPHER_SESSION_H_INCLUDED
+#define CMS_PKI_WCIPHER_SESSION_H_INCLUDED
+
+#include <wrapper/pki/cipher.h>
+
+#include <mutex>
+
+#include <nan.h>
+#include "../utils/wrap.h"
+#include "../helper.h"
+
+WRAP_CLASS(CipherSession){
+public:
+	WCipherSession(){};
+	~WCipherSession(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(Encrypt);
+	static NAN_METHOD(Decrypt);
+
+	WRAP_NEW_INSTANCE(CipherSession);
+
+	/* Session contexts are not shared between threads */
+	std::mutex lock_;
+};
+
+#endif //CMS_PKI_WCIPHER_SESSION_H_INCLUDED
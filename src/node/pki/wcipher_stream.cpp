@@ -0,0 +1,159 @@
+#include "../stdafx.h"
+
+#include <node_buffer.h>
+
+#include "wcipher_stream.h"
+#include "../utils/worker.h"
+
+void WCipherStream::Init(v8::Handle<v8::Object> exports){
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("CipherStream").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "update", Update);
+	Nan::SetPrototypeMethod(tpl, "updateAsync", UpdateAsync);
+	Nan::SetPrototypeMethod(tpl, "final", Final);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+/*
+* Created by Cipher.createStream()
+*/
+NAN_METHOD(WCipherStream::New){
+	METHOD_BEGIN();
+
+	try{
+		WCipherStream *obj = new WCipherStream();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* chunk: Buffer
+*/
+NAN_METHOD(WCipherStream::Update){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("chunk");
+		if (!node::Buffer::HasInstance(info[0])){
+			Nan::ThrowTypeError("Chunk must be a Buffer");
+			return;
+		}
+
+		UNWRAP_DATA(CipherStream);
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		{
+			std::lock_guard<std::mutex> lock(__obj->lock_);
+			_this->update((const unsigned char *)node::Buffer::Data(info[0]), node::Buffer::Length(info[0]), out);
+		}
+
+		info.GetReturnValue().Set(bioToBuffer(out));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* Processes the chunk on the pool thread. Buffer is referenced
+* by persistent storage of the worker, so it is read in place.
+*/
+class CipherStreamUpdateWorker : public PoolWorker {
+public:
+	CipherStreamUpdateWorker(Nan::Callback *callback, WCipherStream *wstream, const char *data, size_t length)
+		: PoolWorker(callback, "trusted:CipherStream.update"),
+		stream_(wstream->data_), lock_(&wstream->lock_), data_(data), length_(length){};
+
+	void Process(){
+		LOGGER_FN();
+
+		this->out_ = new Bio(BIO_TYPE_MEM, "");
+
+		std::lock_guard<std::mutex> lock(*this->lock_);
+		this->stream_->update((const unsigned char *)this->data_, this->length_, this->out_);
+	}
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		v8::Local<v8::Value> argv[] = {
+			Nan::Null(),
+			bioToBuffer(this->out_)
+		};
+
+		callback->Call(2, argv, async_resource);
+	}
+
+protected:
+	Handle<CipherStream> stream_;
+	std::mutex *lock_;
+	const char *data_;
+	size_t length_;
+	Handle<Bio> out_;
+};
+
+/*
+* chunk: Buffer
+* done: Function
+*/
+NAN_METHOD(WCipherStream::UpdateAsync){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("chunk");
+		if (!node::Buffer::HasInstance(info[0])){
+			Nan::ThrowTypeError("Chunk must be a Buffer");
+			return;
+		}
+
+		LOGGER_ARG("done");
+		Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+
+		WCipherStream *wstream = WCipherStream::Unwrap<WCipherStream>(info.This());
+		CipherStreamUpdateWorker *worker = new CipherStreamUpdateWorker(callback, wstream,
+			node::Buffer::Data(info[0]), node::Buffer::Length(info[0]));
+		worker->SaveToPersistent("stream", info.This());
+		worker->SaveToPersistent("chunk", info[0]);
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)PoolWorker::Queue(worker)));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* Return the last block. Padding is checked on decryption
+*/
+NAN_METHOD(WCipherStream::Final){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CipherStream);
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		{
+			std::lock_guard<std::mutex> lock(__obj->lock_);
+			_this->final(out);
+		}
+
+		info.GetReturnValue().Set(bioToBuffer(out));
+		return;
+	}
+	TRY_END();
+}
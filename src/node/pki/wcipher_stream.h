@@ -0,0 +1,30 @@
+#ifndef CMS_PKI_WCIPHER_STREAM_H_INCLUDED
+#define CMS_PKI_WCIPHER_STREAM_H_INCLUDED
+
+#include <wrapper/pki/cipher.h>
+
+#include <mutex>
+
+#include <nan.h>
+#include "../utils/wrap.h"
+#include "../helper.h"
+
+WRAP_CLASS(CipherStream){
+public:
+	WCipherStream(){};
+	~WCipherStream(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(Update);
+	static NAN_METHOD(UpdateAsync);
+	static NAN_METHOD(Final);
+
+	WRAP_NEW_INSTANCE(CipherStream);
+
+	/* Chunks of one stream are processed one by one */
+	std::mutex lock_;
+};
+
+#endif //CMS_PKI_WCIPHER_STREAM_H_INCLUDED
@@ -3,6 +3,26 @@
 #include "wcrl.h"
 #include "wrevokeds.h"
 
+/* Rough heap cost of one decoded revoked entry (serial, date, extensions) */
+#define WCRL_REVOKED_SIZE 128
+
+/* Big CRLs hold many decoded entries, so count them beside the encoding */
+size_t WCRL::externalSize(Handle<CRL> data){
+	if (data.isEmpty() || data->isEmpty()){
+		return 0;
+	}
+	size_t res = 0;
+	int len = i2d_X509_CRL(data->internal(), NULL);
+	if (len > 0){
+		res += len;
+	}
+	int revoked = sk_X509_REVOKED_num(X509_CRL_get_REVOKED(data->internal()));
+	if (revoked > 0){
+		res += revoked * WCRL_REVOKED_SIZE;
+	}
+	return res;
+}
+
 void WCRL::Init(v8::Handle<v8::Object> exports){
 	v8::Local<v8::String> className = Nan::New("CRL").ToLocalChecked();
 
@@ -34,6 +54,7 @@ void WCRL::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "getSignatureDigestAlgorithm", GetSignatureDigestAlgorithm);
 	Nan::SetPrototypeMethod(tpl, "getAuthorityKeyid", GetAuthorityKeyid);
 	Nan::SetPrototypeMethod(tpl, "getCrlNumber", GetCrlNumber);
+	Nan::SetPrototypeMethod(tpl, "getInfo", GetInfo);
 
 	Nan::SetPrototypeMethod(tpl, "getRevoked", GetRevoked);
 
@@ -80,7 +101,7 @@ NAN_METHOD(WCRL::GetIssuerName)
 			return;
 		}
 
-		v8::Local<v8::String> v8Name = Nan::New<v8::String>(name->c_str()).ToLocalChecked();
+		v8::Local<v8::String> v8Name = stringToV8String(name);
 
 		info.GetReturnValue().Set(v8Name);
 		return;
@@ -96,7 +117,7 @@ NAN_METHOD(WCRL::GetIssuerFriendlyName) {
 
 		Handle<std::string> fname = _this->issuerFriendlyName();
 
-		v8::Local<v8::String> v8FName = Nan::New<v8::String>(fname->c_str()).ToLocalChecked();
+		v8::Local<v8::String> v8FName = stringToV8String(fname);
 
 		info.GetReturnValue().Set(v8FName);
 		return;
@@ -189,6 +210,7 @@ NAN_METHOD(WCRL::Load)
 
 		try{
 			_this->read(_in, DataFormat::get(format));
+			WRAP_EXTERNAL_MEMORY(CRL);
 		}
 		catch (Handle<Exception> &e){
 			Nan::ThrowError(e->what());
@@ -209,19 +231,13 @@ NAN_METHOD(WCRL::Import)
 			info.GetReturnValue().SetUndefined();
 		}
 
-		//get data from buffer
-		char* buf = node::Buffer::Data(info[0]);
-		size_t buflen = node::Buffer::Length(info[0]);
-		std::string buffer(buf, buflen);
-
 		UNWRAP_DATA(CRL);
 
-		Handle<Bio> in = NULL;
-
 		try{
-			Handle<Bio> in = new Bio(BIO_TYPE_MEM, buffer);
+			Handle<Bio> in = getBufferBio(info[0]);
 
 			_this->read(in, DataFormat::DER);
+			WRAP_EXTERNAL_MEMORY(CRL);
 		}
 		catch (Handle<Exception> &e){
 			Nan::ThrowError(e->what());
@@ -269,10 +285,8 @@ NAN_METHOD(WCRL::Export)
 		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
 		_this->write(out, DataFormat::DER);
 
-		Handle<std::string> buf = out->read();
-
 		info.GetReturnValue().Set(
-			stringToBuffer(buf)
+			bioToBuffer(out)
 		);
 		return;
 	}
@@ -378,9 +392,11 @@ NAN_METHOD(WCRL::GetEncoded) {
 	try {
 		UNWRAP_DATA(CRL);
 
-		Handle<std::string> encCrl = _this->getEncoded();
+		/* DER is written to memory which is handed to the Buffer */
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		_this->write(out, DataFormat::DER);
 
-		info.GetReturnValue().Set(stringToBuffer(encCrl));
+		info.GetReturnValue().Set(bioToBuffer(out));
 		return;
 	}
 	TRY_END();
@@ -460,6 +476,34 @@ NAN_METHOD(WCRL::GetCrlNumber) {
 	TRY_END();
 }
 
+/*
+* Return all read only properties (except encoded data) by one call
+*/
+NAN_METHOD(WCRL::GetInfo) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(CRL);
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+
+		INFO_SET(res, "version", Nan::New<v8::Number>(_this->getVersion()));
+		INFO_SET_STRING(res, "issuerName", _this->issuerName());
+		INFO_SET_STRING(res, "issuerFriendlyName", _this->issuerFriendlyName());
+		INFO_SET_STRING(res, "lastUpdate", _this->getThisUpdate());
+		INFO_SET_STRING(res, "nextUpdate", _this->getNextUpdate());
+		INFO_SET(res, "thumbprint", stringToHex(_this->getThumbprint()));
+		INFO_SET_STRING(res, "signatureAlgorithm", _this->getSignatureAlgorithm());
+		INFO_SET_STRING(res, "signatureDigestAlgorithm", _this->getSignatureDigestAlgorithm());
+		INFO_SET_STRING(res, "authorityKeyid", _this->getAuthorityKeyid());
+		INFO_SET_STRING(res, "crlNumber", _this->getCrlNumber());
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCRL::GetRevoked) {
 	METHOD_BEGIN();
 
@@ -12,6 +12,8 @@ public:
 	WCRL(){};
 	~WCRL(){};
 
+	static size_t externalSize(Handle<CRL> data);
+
 	static void Init(v8::Handle<v8::Object>);
 	static NAN_METHOD(New);
 
@@ -37,6 +39,7 @@ public:
 	static NAN_METHOD(GetSignatureDigestAlgorithm);
 	static NAN_METHOD(GetAuthorityKeyid);
 	static NAN_METHOD(GetCrlNumber);
+	static NAN_METHOD(GetInfo);
 
 	static NAN_METHOD(GetRevoked);
 
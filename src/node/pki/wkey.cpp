@@ -3,6 +3,7 @@
 #include <node_buffer.h>
 
 #include "wkey.h"
+#include "wkey_pool.h"
 
 void WKey::Init(v8::Handle<v8::Object> exports){
 	METHOD_BEGIN();
@@ -16,6 +17,7 @@ void WKey::Init(v8::Handle<v8::Object> exports){
 	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
 
 	Nan::SetPrototypeMethod(tpl, "generate", Generate);
+	Nan::SetPrototypeMethod(tpl, "generateAsync", GenerateAsync);
 	Nan::SetPrototypeMethod(tpl, "compare", Compare);
 	Nan::SetPrototypeMethod(tpl, "duplicate", Duplicate);
 
@@ -54,20 +56,12 @@ NAN_METHOD(WKey::Generate){
 		v8::String::Utf8Value v8Algorithm(info[0]->ToString());
 		char *algorithm = *v8Algorithm;
 
-		if (!info[1]->IsUndefined() && !info[1]->IsArray())
+		std::vector<std::string> vpkeyopts;
+		if (!getStringArray(info[1], vpkeyopts))
 		{
-			Nan::ThrowTypeError("Argument must be array");
+			Nan::ThrowTypeError("Argument must be array");
 			info.GetReturnValue().SetUndefined();
-		}
-
-		std::vector<std::string> vpkeyopts;
-		v8::Local<v8::Array> pkeyopts = v8::Local<v8::Array>::Cast(info[1]);
-
-		for (unsigned int i = 0; i < pkeyopts->Length(); i++) {
-			if (Nan::Has(pkeyopts, i).FromJust()) {
-				v8::String::Utf8Value v8Value(Nan::Get(pkeyopts, i).ToLocalChecked()->ToString());
-				vpkeyopts.push_back(std::string(*v8Value));
-			}
+			return;
 		}
 
 		UNWRAP_DATA(Key);
@@ -81,6 +75,71 @@ NAN_METHOD(WKey::Generate){
 	TRY_END();
 }
 
+/*
+* Takes key from KeyPool or generates it on the pool thread
+*/
+class KeyGenerateWorker : public PoolWorker {
+public:
+	KeyGenerateWorker(Nan::Callback *callback, Handle<std::string> algorithm, const std::vector<std::string> &pkeyopts)
+		: PoolWorker(callback, "trusted:Key.generate"), algorithm_(algorithm), pkeyopts_(pkeyopts){};
+
+	void Process(){
+		LOGGER_FN();
+
+		this->key_ = WKeyPool::pool()->take(this->algorithm_, this->pkeyopts_);
+	}
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		v8::Local<v8::Value> argv[] = {
+			Nan::Null(),
+			WKey::NewInstance(this->key_)
+		};
+
+		callback->Call(2, argv, async_resource);
+	}
+
+protected:
+	Handle<std::string> algorithm_;
+	std::vector<std::string> pkeyopts_;
+	Handle<Key> key_;
+};
+
+/*
+* algorithm: String
+* pkeyopts: String[]
+* done: Function
+*/
+NAN_METHOD(WKey::GenerateAsync){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("algorithm");
+		v8::String::Utf8Value v8Algorithm(info[0]->ToString());
+
+		LOGGER_ARG("pkeyopts");
+		std::vector<std::string> vpkeyopts;
+		if (!getStringArray(info[1], vpkeyopts))
+		{
+			Nan::ThrowTypeError("Argument must be array");
+			return;
+		}
+
+		LOGGER_ARG("done");
+		Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+
+		/* Pool is created here, on the JS thread */
+		WKeyPool::pool();
+
+		unsigned long long id = PoolWorker::Queue(new KeyGenerateWorker(callback, new std::string(*v8Algorithm), vpkeyopts));
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)id));
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WKey::Compare) {
 	METHOD_BEGIN();
 
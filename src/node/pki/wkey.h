@@ -16,6 +16,7 @@ public:
 	static NAN_METHOD(New);
 
 	static NAN_METHOD(Generate);
+	static NAN_METHOD(GenerateAsync);
 	static NAN_METHOD(Compare);
 	static NAN_METHOD(Duplicate);
 
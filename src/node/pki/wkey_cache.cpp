@@ -0,0 +1,86 @@
+#include "../stdafx.h"
+
+#include "wkey_cache.h"
+
+void WKeyCache::Init(v8::Handle<v8::Object> exports){
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("KeyCache").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "setCapacity", SetCapacity);
+	Nan::SetPrototypeMethod(tpl, "clear", Clear);
+	Nan::SetPrototypeMethod(tpl, "getStats", GetStats);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+NAN_METHOD(WKeyCache::New){
+	METHOD_BEGIN();
+
+	try{
+		WKeyCache *obj = new WKeyCache();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* capacity: Number. 0 - keys are not cached
+*/
+NAN_METHOD(WKeyCache::SetCapacity){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("capacity");
+		int capacity = info[0]->IsNumber() ? info[0]->ToNumber()->Int32Value() : -1;
+		if (capacity < 0){
+			Nan::ThrowTypeError("Capacity must be a not negative number");
+			return;
+		}
+
+		KeyCache::setCapacity((size_t)capacity);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WKeyCache::Clear){
+	METHOD_BEGIN();
+
+	try{
+		KeyCache::clear();
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WKeyCache::GetStats){
+	METHOD_BEGIN();
+
+	try{
+		KeyCache::Stats stats = KeyCache::stats();
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+		Nan::Set(res, Nan::New("hits").ToLocalChecked(), Nan::New<v8::Number>((double)stats.hits));
+		Nan::Set(res, Nan::New("misses").ToLocalChecked(), Nan::New<v8::Number>((double)stats.misses));
+		Nan::Set(res, Nan::New("size").ToLocalChecked(), Nan::New<v8::Number>((double)stats.size));
+		Nan::Set(res, Nan::New("capacity").ToLocalChecked(), Nan::New<v8::Number>((double)stats.capacity));
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
@@ -0,0 +1,26 @@
+#ifndef WKEY_CACHE_H_INCLUDED
+#define WKEY_CACHE_H_INCLUDED
+
+#include <wrapper/pki/key_cache.h>
+
+#include <nan.h>
+#include "../utils/wrap.h"
+#include "../helper.h"
+
+/*
+* Access to the module cache of password derived keys
+*/
+WRAP_CLASS(KeyCache){
+public:
+	WKeyCache(){};
+	~WKeyCache(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(SetCapacity);
+	static NAN_METHOD(Clear);
+	static NAN_METHOD(GetStats);
+};
+
+#endif //WKEY_CACHE_H_INCLUDED
@@ -0,0 +1,123 @@
+#include "../stdafx.h"
+
+#include "wkey.h"
+#include "wkey_pool.h"
+
+void WKeyPool::Init(v8::Handle<v8::Object> exports){
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("KeyPool").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "reserve", Reserve);
+	Nan::SetPrototypeMethod(tpl, "take", Take);
+	Nan::SetPrototypeMethod(tpl, "getStats", GetStats);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+KeyPool *WKeyPool::pool(){
+	static KeyPool *pool = new KeyPool(PoolWorker::threads());
+	return pool;
+}
+
+NAN_METHOD(WKeyPool::New){
+	METHOD_BEGIN();
+
+	try{
+		WKeyPool *obj = new WKeyPool();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* algorithm: String
+* pkeyopts: String[]
+* count: Number
+*/
+NAN_METHOD(WKeyPool::Reserve){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("algorithm");
+		v8::String::Utf8Value v8Algorithm(info[0]->ToString());
+
+		LOGGER_ARG("pkeyopts");
+		std::vector<std::string> pkeyopts;
+		if (!getStringArray(info[1], pkeyopts)){
+			Nan::ThrowTypeError("Argument must be array");
+			return;
+		}
+
+		LOGGER_ARG("count");
+		int count = info[2]->ToNumber()->Int32Value();
+		if (count < 0){
+			Nan::ThrowRangeError("Count must not be negative");
+			return;
+		}
+
+		WKeyPool::pool()->reserve(new std::string(*v8Algorithm), pkeyopts, (size_t)count);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* algorithm: String
+* pkeyopts: String[]
+*/
+NAN_METHOD(WKeyPool::Take){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("algorithm");
+		v8::String::Utf8Value v8Algorithm(info[0]->ToString());
+
+		LOGGER_ARG("pkeyopts");
+		std::vector<std::string> pkeyopts;
+		if (!getStringArray(info[1], pkeyopts)){
+			Nan::ThrowTypeError("Argument must be array");
+			return;
+		}
+
+		Handle<Key> key = WKeyPool::pool()->take(new std::string(*v8Algorithm), pkeyopts);
+
+		info.GetReturnValue().Set(WKey::NewInstance(key));
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WKeyPool::GetStats){
+	METHOD_BEGIN();
+
+	try{
+		KeyPool::Stats stats = WKeyPool::pool()->stats();
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+		Nan::Set(res, Nan::New("hits").ToLocalChecked(), Nan::New<v8::Number>((double)stats.hits));
+		Nan::Set(res, Nan::New("misses").ToLocalChecked(), Nan::New<v8::Number>((double)stats.misses));
+		Nan::Set(res, Nan::New("generated").ToLocalChecked(), Nan::New<v8::Number>((double)stats.generated));
+		Nan::Set(res, Nan::New("failures").ToLocalChecked(), Nan::New<v8::Number>((double)stats.failures));
+		Nan::Set(res, Nan::New("ready").ToLocalChecked(), Nan::New<v8::Number>((double)stats.ready));
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
@@ -0,0 +1,31 @@
+#ifndef WKEY_POOL_H_INCLUDED
+#define WKEY_POOL_H_INCLUDED
+
+#include <wrapper/pki/key_pool.h>
+
+#include <nan.h>
+#include "../utils/wrap.h"
+#include "../utils/worker.h"
+#include "../helper.h"
+
+/*
+* Access to the module key pool. The pool is filled on the threads
+* of PoolWorker.
+*/
+WRAP_CLASS(KeyPool){
+public:
+	WKeyPool(){};
+	~WKeyPool(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(Reserve);
+	static NAN_METHOD(Take);
+	static NAN_METHOD(GetStats);
+
+	/* Created on the first use from the JS thread */
+	static KeyPool *pool();
+};
+
+#endif //WKEY_POOL_H_INCLUDED
@@ -42,6 +42,20 @@ void WPkiStore::Init(v8::Handle<v8::Object> exports){
 	exports->Set(className, tpl->GetFunction());
 }
 
+/* Rough heap cost of one cached PkiItem (its strings and collection entry) */
+#define WPKISTORE_ITEM_SIZE 512
+
+size_t WPkiStore::externalSize(Handle<PkiStore> data){
+	if (data.isEmpty()){
+		return 0;
+	}
+	Handle<PkiItemCollection> items = data->getItems();
+	if (items.isEmpty()){
+		return 0;
+	}
+	return items->length() * WPKISTORE_ITEM_SIZE;
+}
+
 NAN_METHOD(WPkiStore::New){
 	METHOD_BEGIN();
 
@@ -54,6 +68,7 @@ NAN_METHOD(WPkiStore::New){
 		obj->data_ = new PkiStore(new std::string(json));
 
 		obj->Wrap(info.This());
+		obj->setExternalMemory(WPkiStore::externalSize(obj->data_));
 
 		info.GetReturnValue().Set(info.This());
 		return;
@@ -71,6 +86,7 @@ NAN_METHOD(WPkiStore::AddProvider){
 		UNWRAP_DATA(PkiStore);
 
 		_this->addProvider(wProv->data_);
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 						
 		info.GetReturnValue().Set(info.This());
 		return;
@@ -108,6 +124,7 @@ NAN_METHOD(WPkiStore::AddCert){
 		UNWRAP_DATA(PkiStore);	
 
 		Handle<std::string> uri = _this->addPkiObject(wProv->data_, new std::string(category), wCert->data_, hvalue, type);
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 
 		v8::Local<v8::String> v8Uri = Nan::New<v8::String>(uri->c_str()).ToLocalChecked();
 
@@ -135,6 +152,7 @@ NAN_METHOD(WPkiStore::AddCrl){
 		UNWRAP_DATA(PkiStore);
 
 		Handle<std::string> uri = _this->addPkiObject(wProv->data_, new std::string(category), wCrl->data_);
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 
 		v8::Local<v8::String> v8Uri = Nan::New<v8::String>(uri->c_str()).ToLocalChecked();
 
@@ -162,6 +180,7 @@ NAN_METHOD(WPkiStore::AddCsr){
 		UNWRAP_DATA(PkiStore);
 	
 		Handle<std::string> uri = _this->addPkiObject(wProv->data_, new std::string(category), wCsr->data_);
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 
 		v8::Local<v8::String> v8Uri = Nan::New<v8::String>(uri->c_str()).ToLocalChecked();
 
@@ -189,6 +208,7 @@ NAN_METHOD(WPkiStore::AddKey){
 		UNWRAP_DATA(PkiStore);	
 
 		Handle<std::string> uri = _this->addPkiObject(wProv->data_, wKey->data_, new std::string(password));
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 
 		v8::Local<v8::String> v8Uri = Nan::New<v8::String>(uri->c_str()).ToLocalChecked();
 
@@ -216,6 +236,7 @@ NAN_METHOD(WPkiStore::DeleteCert){
 		UNWRAP_DATA(PkiStore);
 
 		_this->deletePkiObject(wProv->data_, new std::string(category), wCert->data_);
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 
 		return;
 	}
@@ -240,6 +261,7 @@ NAN_METHOD(WPkiStore::DeleteCrl){
 		UNWRAP_DATA(PkiStore);
 
 		_this->deletePkiObject(wProv->data_, new std::string(category), wCrl->data_);
+		WRAP_EXTERNAL_MEMORY(PkiStore);
 
 		return;
 	}
@@ -247,134 +269,138 @@ NAN_METHOD(WPkiStore::DeleteCrl){
 	TRY_END();
 }
 
-NAN_METHOD(WPkiStore::Find){
-	METHOD_BEGIN();
+/*
+* Plain object of PkiItem. Fields depend on the item type
+*/
+static v8::Local<v8::Object> pkiItemToObject(Handle<PkiItem> item){
+	v8::Isolate* isolate = v8::Isolate::GetCurrent();
 
-	try{
-		LOGGER_ARG("filter");
-		WFilter * wFilter = WFilter::Unwrap<WFilter>(info[0]->ToObject());
+	v8::Local<v8::Object> res = v8::Object::New(isolate);
 
-		UNWRAP_DATA(PkiStore);
+	res->Set(v8::String::NewFromUtf8(isolate, "type"),
+		v8::String::NewFromUtf8(isolate, item->type->c_str()));
 
-		Handle<PkiItemCollection> res = _this->find(wFilter->data_);
+	res->Set(v8::String::NewFromUtf8(isolate, "format"),
+		v8::String::NewFromUtf8(isolate, item->format->c_str()));
 
-		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+	res->Set(v8::String::NewFromUtf8(isolate, "provider"),
+		v8::String::NewFromUtf8(isolate, item->provider->c_str()));
 
-		v8::Local<v8::Array> array8 = v8::Array::New(isolate, res->length());
+	res->Set(v8::String::NewFromUtf8(isolate, "category"),
+		v8::String::NewFromUtf8(isolate, item->category->c_str()));
 
-		for (int i = 0; i < res->length(); i++){
-			v8::Local<v8::Object> tempObj = v8::Object::New(isolate);
-			Handle<PkiItem> item = res->items(i);
+	res->Set(v8::String::NewFromUtf8(isolate, "uri"),
+		v8::String::NewFromUtf8(isolate, item->uri->c_str()));
 
-			tempObj->Set(v8::String::NewFromUtf8(isolate, "type"),
-				v8::String::NewFromUtf8(isolate, item->type->c_str()));
+	res->Set(v8::String::NewFromUtf8(isolate, "hash"),
+		v8::String::NewFromUtf8(isolate, item->hash->c_str()));
 
-			tempObj->Set(v8::String::NewFromUtf8(isolate, "format"),
-				v8::String::NewFromUtf8(isolate, item->format->c_str()));
+	if (strcmp(item->type->c_str(), "CERTIFICATE") == 0){
+		res->Set(v8::String::NewFromUtf8(isolate, "subjectName"),
+			v8::String::NewFromUtf8(isolate, item->certSubjectName->c_str()));
 
-			tempObj->Set(v8::String::NewFromUtf8(isolate, "provider"),
-				v8::String::NewFromUtf8(isolate, item->provider->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "subjectFriendlyName"),
+			v8::String::NewFromUtf8(isolate, item->certSubjectFriendlyName->c_str()));
 
-			tempObj->Set(v8::String::NewFromUtf8(isolate, "category"),
-				v8::String::NewFromUtf8(isolate, item->category->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "issuerName"),
+			v8::String::NewFromUtf8(isolate, item->certIssuerName->c_str()));
 
-			tempObj->Set(v8::String::NewFromUtf8(isolate, "uri"),
-				v8::String::NewFromUtf8(isolate, item->uri->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "issuerFriendlyName"),
+			v8::String::NewFromUtf8(isolate, item->certIssuerFriendlyName->c_str()));
 
-			tempObj->Set(v8::String::NewFromUtf8(isolate, "hash"),
-				v8::String::NewFromUtf8(isolate, item->hash->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "notBefore"),
+			v8::String::NewFromUtf8(isolate, item->certNotBefore->c_str()));
 
-			if (strcmp(item->type->c_str(), "CERTIFICATE") == 0){
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "subjectName"),
-					v8::String::NewFromUtf8(isolate, item->certSubjectName->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "notAfter"),
+			v8::String::NewFromUtf8(isolate, item->certNotAfter->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "subjectFriendlyName"),
-					v8::String::NewFromUtf8(isolate, item->certSubjectFriendlyName->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "serial"),
+			v8::String::NewFromUtf8(isolate, item->certSerial->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "issuerName"),
-					v8::String::NewFromUtf8(isolate, item->certIssuerName->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "key"),
+			v8::String::NewFromUtf8(isolate, item->certKey->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "issuerFriendlyName"),
-					v8::String::NewFromUtf8(isolate, item->certIssuerFriendlyName->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "organizationName"),
+			v8::String::NewFromUtf8(isolate, item->certOrganizationName->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "notBefore"),
-					v8::String::NewFromUtf8(isolate, item->certNotBefore->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "signatureAlgorithm"),
+			v8::String::NewFromUtf8(isolate, item->certSignatureAlgorithm->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "notAfter"),
-					v8::String::NewFromUtf8(isolate, item->certNotAfter->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "signatureDigestAlgorithm"),
+			v8::String::NewFromUtf8(isolate, item->certSignatureDigestAlgorithm->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "serial"),
-					v8::String::NewFromUtf8(isolate, item->certSerial->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "publicKeyAlgorithm"),
+			v8::String::NewFromUtf8(isolate, item->certPublicKeyAlgorithm->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "key"),
-					v8::String::NewFromUtf8(isolate, item->certKey->c_str()));
+		return res;
+	}
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "organizationName"),
-					v8::String::NewFromUtf8(isolate, item->certOrganizationName->c_str()));
+	if (strcmp(item->type->c_str(), "CRL") == 0){
+		res->Set(v8::String::NewFromUtf8(isolate, "issuerName"),
+			v8::String::NewFromUtf8(isolate, item->crlIssuerName->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "signatureAlgorithm"),
-					v8::String::NewFromUtf8(isolate, item->certSignatureAlgorithm->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "issuerFriendlyName"),
+			v8::String::NewFromUtf8(isolate, item->crlIssuerFriendlyName->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "signatureDigestAlgorithm"),
-					v8::String::NewFromUtf8(isolate, item->certSignatureDigestAlgorithm->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "lastUpdate"),
+			v8::String::NewFromUtf8(isolate, item->crlLastUpdate->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "publicKeyAlgorithm"),
-					v8::String::NewFromUtf8(isolate, item->certPublicKeyAlgorithm->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "nextUpdate"),
+			v8::String::NewFromUtf8(isolate, item->crlNextUpdate->c_str()));
 
-				array8->Set(i, tempObj);
-				continue;
-			}
+		res->Set(v8::String::NewFromUtf8(isolate, "signatureAlgorithm"),
+			v8::String::NewFromUtf8(isolate, item->crlSignatureAlgorithm->c_str()));
 
-			if (strcmp(item->type->c_str(), "CRL") == 0){
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "issuerName"),
-					v8::String::NewFromUtf8(isolate, item->crlIssuerName->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "signatureDigestAlgorithm"),
+			v8::String::NewFromUtf8(isolate, item->crlSignatureDigestAlgorithm->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "issuerFriendlyName"),
-					v8::String::NewFromUtf8(isolate, item->crlIssuerFriendlyName->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "authorityKeyid"),
+			v8::String::NewFromUtf8(isolate, item->crlAuthorityKeyid->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "lastUpdate"),
-					v8::String::NewFromUtf8(isolate, item->crlLastUpdate->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "crlNumber"),
+			v8::String::NewFromUtf8(isolate, item->crlCrlNumber->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "nextUpdate"),
-					v8::String::NewFromUtf8(isolate, item->crlNextUpdate->c_str()));
+		return res;
+	}
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "signatureAlgorithm"),
-					v8::String::NewFromUtf8(isolate, item->crlSignatureAlgorithm->c_str()));
+	if (strcmp(item->type->c_str(), "REQUEST") == 0){
+		res->Set(v8::String::NewFromUtf8(isolate, "subjectName"),
+			v8::String::NewFromUtf8(isolate, item->csrSubjectName->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "signatureDigestAlgorithm"),
-					v8::String::NewFromUtf8(isolate, item->crlSignatureDigestAlgorithm->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "subjectFriendlyName"),
+			v8::String::NewFromUtf8(isolate, item->csrSubjectFriendlyName->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "authorityKeyid"),
-					v8::String::NewFromUtf8(isolate, item->crlAuthorityKeyid->c_str()));
+		res->Set(v8::String::NewFromUtf8(isolate, "key"),
+			v8::String::NewFromUtf8(isolate, item->csrKey->c_str()));
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "crlNumber"),
-					v8::String::NewFromUtf8(isolate, item->crlCrlNumber->c_str()));
+		return res;
+	}
 
-				array8->Set(i, tempObj);
-				continue;
-			}
+	if (strcmp(item->type->c_str(), "KEY") == 0){
+		res->Set(v8::String::NewFromUtf8(isolate, "encrypted"),
+			v8::Boolean::New(isolate, item->keyEncrypted));
+	}
 
-			if (strcmp(item->type->c_str(), "REQUEST") == 0){
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "subjectName"),
-					v8::String::NewFromUtf8(isolate, item->csrSubjectName->c_str()));
+	return res;
+}
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "subjectFriendlyName"),
-					v8::String::NewFromUtf8(isolate, item->csrSubjectFriendlyName->c_str()));
+NAN_METHOD(WPkiStore::Find){
+	METHOD_BEGIN();
 
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "key"),
-					v8::String::NewFromUtf8(isolate, item->csrKey->c_str()));
+	try{
+		LOGGER_ARG("filter");
+		WFilter * wFilter = WFilter::Unwrap<WFilter>(info[0]->ToObject());
 
-				array8->Set(i, tempObj);
-				continue;
-			}	
+		UNWRAP_DATA(PkiStore);
 
-			if (strcmp(item->type->c_str(), "KEY") == 0){
-				tempObj->Set(v8::String::NewFromUtf8(isolate, "encrypted"),
-					v8::Boolean::New(isolate, item->keyEncrypted));
+		Handle<PkiItemCollection> res = _this->find(wFilter->data_);
 
-				array8->Set(i, tempObj);
-				continue;
-			}
+		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+
+		v8::Local<v8::Array> array8 = v8::Array::New(isolate, res->length());
+
+		for (int i = 0; i < res->length(); i++){
+			array8->Set(i, pkiItemToObject(res->items(i)));
 		}
 
 		info.GetReturnValue().Set(array8);
@@ -728,6 +754,8 @@ void WPkiItem::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "setAuthorityKeyid", SetAuthorityKeyid);
 	Nan::SetPrototypeMethod(tpl, "setCrlNumber", SetCrlNumber);
 
+	Nan::SetPrototypeMethod(tpl, "getInfo", GetInfo);
+
 	// Store the constructor in the target bindings.
 	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
 
@@ -1116,3 +1144,15 @@ NAN_METHOD(WPkiItem::SetPublicKeyAlgorithm) {
 	}
 	TRY_END();
 }
+
+NAN_METHOD(WPkiItem::GetInfo) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(PkiItem);
+
+		info.GetReturnValue().Set(pkiItemToObject(_this));
+		return;
+	}
+	TRY_END();
+}
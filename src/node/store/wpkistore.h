@@ -12,6 +12,8 @@ public:
 	WPkiStore(){};
 	~WPkiStore(){};
 
+	static size_t externalSize(Handle<PkiStore> data);
+
 	static void Init(v8::Handle<v8::Object>);
 	static NAN_METHOD(New);
 	
@@ -90,6 +92,8 @@ public:
 	static NAN_METHOD(SetPublicKeyAlgorithm);
 	static NAN_METHOD(SetAuthorityKeyid);
 	static NAN_METHOD(SetCrlNumber);
+
+	static NAN_METHOD(GetInfo);
 };
 
 #endif //WPKISTORE_H_INCLUDED
@@ -3,6 +3,8 @@
 #include "wsystem.h"
 #include "wpkistore.h"
 
+#include "../utils/worker.h"
+
 void WProvider_System::Init(v8::Handle<v8::Object> exports){
 	METHOD_BEGIN();
 
@@ -14,6 +16,7 @@ void WProvider_System::Init(v8::Handle<v8::Object> exports){
 	tpl->SetClassName(className);
 	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
 
+	Nan::SetPrototypeMethod(tpl, "loadAsync", LoadAsync);
 	Nan::SetPrototypeMethod(tpl, "objectToPkiItem", ObjectToPkiItem);
 
 	// Store the constructor in the target bindings.
@@ -22,44 +25,49 @@ void WProvider_System::Init(v8::Handle<v8::Object> exports){
 	exports->Set(className, tpl->GetFunction());
 }
 
-NAN_METHOD(WProvider_System::New){
-	METHOD_BEGIN();
-
-	try{
-		LOGGER_ARG("folder");
+/* Folder name in the encoding of the file system */
+static Handle<std::string> getFolder(v8::Local<v8::Value> value){
 #if defined(OPENSSL_SYS_WINDOWS)
-		LPCWSTR wCont = (LPCWSTR)* v8::String::Value(info[0]->ToString());
+	LPCWSTR wCont = (LPCWSTR)* v8::String::Value(value->ToString());
 
-		int string_len = WideCharToMultiByte(CP_ACP, 0, wCont, -1, NULL, 0, NULL, NULL);
-		if (!string_len) {
-			Nan::ThrowError("Error WideCharToMultiByte");
-		}
+	int string_len = WideCharToMultiByte(CP_ACP, 0, wCont, -1, NULL, 0, NULL, NULL);
+	if (!string_len) {
+		THROW_EXCEPTION(0, WProvider_System, NULL, "Error WideCharToMultiByte");
+	}
 
-		char* converted = new char[string_len];
-		if (!converted) {
-			Nan::ThrowError("Error LocalAlloc");
-		}
+	char* converted = new char[string_len];
 
-		string_len = WideCharToMultiByte(CP_ACP, 0, wCont, -1, converted, string_len, NULL, NULL);
-		if (!string_len)
-		{
-			delete[] converted;
-			Nan::ThrowError("Error WideCharToMultiByte");
-		}
+	string_len = WideCharToMultiByte(CP_ACP, 0, wCont, -1, converted, string_len, NULL, NULL);
+	if (!string_len)
+	{
+		delete[] converted;
+		THROW_EXCEPTION(0, WProvider_System, NULL, "Error WideCharToMultiByte");
+	}
 
-		std::string result = converted;
+	Handle<std::string> result = new std::string(converted);
 
-		delete[] converted;
+	delete[] converted;
 
-		const char * folder = result.c_str();
+	return result;
 #else
-		v8::String::Utf8Value v8Folder(info[0]->ToString());
-		char *folder = *v8Folder;
+	v8::String::Utf8Value v8Folder(value->ToString());
+	return new std::string(*v8Folder);
 #endif // OPENSSL_SYS_WINDOWS
+}
+
+/*
+* folder: String. Without folder the provider is empty until loadAsync() is done
+*/
+NAN_METHOD(WProvider_System::New){
+	METHOD_BEGIN();
 
+	try{
 		WProvider_System *obj = new WProvider_System();
-		Handle<std::string> str = new std::string(folder);
-		obj->data_ = new Provider_System(str);
+
+		LOGGER_ARG("folder");
+		if (!info[0]->IsUndefined()){
+			obj->data_ = new Provider_System(getFolder(info[0]));
+		}
 
 		obj->Wrap(info.This());
 
@@ -69,11 +77,66 @@ NAN_METHOD(WProvider_System::New){
 	TRY_END();
 }
 
+/*
+* Scans folder on the pool thread. Scan is a bulk job, it is queued with Low priority
+*/
+class ProviderSystemLoadWorker : public PoolWorker {
+public:
+	ProviderSystemLoadWorker(Nan::Callback *callback, Handle<std::string> folder)
+		: PoolWorker(callback, "trusted:Provider_System.load", ThreadPool::Low), folder_(folder){};
+
+	void Process(){
+		LOGGER_FN();
+
+		this->provider_ = new Provider_System(this->folder_);
+	}
+
+	void HandleOKCallback(){
+		Nan::HandleScope scope;
+
+		v8::Local<v8::Object> obj = GetFromPersistent("provider").As<v8::Object>();
+		WProvider_System *wProvider = (WProvider_System *)Nan::GetInternalFieldPointer(obj, 0);
+		wProvider->data_ = this->provider_;
+
+		PoolWorker::HandleOKCallback();
+	}
+
+protected:
+	Handle<std::string> folder_;
+	Handle<Provider_System> provider_;
+};
+
+/*
+* folder: String
+* done: Function
+*/
+NAN_METHOD(WProvider_System::LoadAsync){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("folder");
+		Handle<std::string> folder = getFolder(info[0]);
+
+		LOGGER_ARG("done");
+		Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+
+		ProviderSystemLoadWorker *worker = new ProviderSystemLoadWorker(callback, folder);
+		worker->SaveToPersistent("provider", info.This());
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)PoolWorker::Queue(worker)));
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WProvider_System::ObjectToPkiItem){
 	METHOD_BEGIN();
 
 	try{
 		UNWRAP_DATA(Provider_System);
+		if (_this.isEmpty()){
+			THROW_EXCEPTION(0, WProvider_System, NULL, "Provider is not loaded");
+		}
 
 		LOGGER_ARG("path");
 		v8::String::Utf8Value v8Path(info[0]->ToString());
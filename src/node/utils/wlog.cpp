@@ -17,6 +17,7 @@ void WLogger::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "start", Start);
 	Nan::SetPrototypeMethod(tpl, "stop", Stop);
 	Nan::SetPrototypeMethod(tpl, "clear", Clear);
+	Nan::SetPrototypeMethod(tpl, "getDropped", GetDropped);
 
 	// Store the constructor in the target bindings.
 	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
@@ -78,7 +79,10 @@ NAN_METHOD(WLogger::Start) {
 		LOGGER_ARG("level");
 		int level = info[1]->ToNumber()->Int32Value();
 
-		_this->start((const char *)filename, level);
+		LOGGER_ARG("async");
+		bool async = info[2]->IsBoolean() ? info[2]->BooleanValue() : false;
+
+		_this->start((const char *)filename, level, async);
 
 		info.GetReturnValue().Set(info.This());
 	}
@@ -108,3 +112,14 @@ NAN_METHOD(WLogger::Clear)
 	}
 	TRY_END();
 }
+
+NAN_METHOD(WLogger::GetDropped)
+{
+	try {
+		UNWRAP_DATA(Logger);
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)_this->dropped()));
+		return;
+	}
+	TRY_END();
+}
@@ -18,6 +18,7 @@ public:
 	static NAN_METHOD(Start);
 	static NAN_METHOD(Stop);
 	static NAN_METHOD(Clear);
+	static NAN_METHOD(GetDropped);
 };
 
 #endif //!UTILS_WLOG_H_INCLUDED
@@ -0,0 +1,264 @@
+#include "../stdafx.h"
+
+#include <stdlib.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <atomic>
+
+#include "worker.h"
+
+#define POOL_SIZE_ENV "TRUSTED_THREADPOOL_SIZE"
+
+static ThreadPool *newThreadPool(){
+	size_t size = 0;
+	const char *env = getenv(POOL_SIZE_ENV);
+	if (env){
+		int value = atoi(env);
+		if (value > 0){
+			size = (size_t)value;
+		}
+	}
+	ThreadPool *pool = new ThreadPool(size);
+	/* Segments of AEAD data are processed by the same threads */
+	ThreadPool::setShared(pool);
+	return pool;
+}
+
+/* One pool for the process, shared by the module instances of all JS threads */
+static ThreadPool *getThreadPool(){
+	static ThreadPool *pool = newThreadPool();
+	return pool;
+}
+
+/*
+* Finished workers are passed back to the event loop of their JS thread
+* by uv_async_t. The handle is referenced only while workers are pending,
+* so it does not keep the loop alive.
+*/
+class PoolWorkerQueue{
+public:
+	PoolWorkerQueue(uv_loop_t *loop)
+		: loop_(loop), pending_(0), closed_(false)
+	{
+		uv_async_init(loop, &this->async_, PoolWorkerQueue::onComplete);
+		this->async_.data = this;
+		uv_unref((uv_handle_t *)&this->async_);
+	}
+
+	unsigned long long push(PoolWorker *worker){
+		if (this->pending_++ == 0){
+			uv_ref((uv_handle_t *)&this->async_);
+		}
+
+		try{
+			worker->id_ = getThreadPool()->push([this, worker](){
+				worker->Execute();
+				this->complete(worker);
+			}, worker->priority_, worker->cancel_);
+		}
+		catch (...){
+			if (--this->pending_ == 0){
+				uv_unref((uv_handle_t *)&this->async_);
+			}
+			throw;
+		}
+
+		this->jobs_[worker->id_] = worker;
+		return worker->id_;
+	}
+
+	/*
+	* Not started worker is removed from the pool and completed with error
+	* on the next loop iteration, running one gets the cancel flag
+	*/
+	bool cancel(unsigned long long id){
+		std::map<unsigned long long, PoolWorker *>::iterator it = this->jobs_.find(id);
+		if (it == this->jobs_.end()){
+			return false;
+		}
+
+		PoolWorker *worker = it->second;
+		worker->cancel_->store(true);
+		if (getThreadPool()->remove(id)){
+			worker->SetCancelled();
+			this->complete(worker);
+		}
+		return true;
+	}
+
+	/*
+	* Called when the JS thread stops. Workers which are still running
+	* can not call back into the stopped isolate, they are not completed.
+	*/
+	void close(){
+		{
+			std::lock_guard<std::mutex> lock(this->lock_);
+			this->closed_ = true;
+			this->pending_ -= this->done_.size();
+			this->done_.clear();
+		}
+		this->jobs_.clear();
+		uv_close((uv_handle_t *)&this->async_, PoolWorkerQueue::onClose);
+		uv_run(this->loop_, UV_RUN_NOWAIT);
+	}
+
+protected:
+	/* Called on the pool thread or on the JS thread by cancel() */
+	void complete(PoolWorker *worker){
+		bool release;
+		{
+			std::lock_guard<std::mutex> lock(this->lock_);
+			if (!this->closed_){
+				this->done_.push_back(worker);
+				uv_async_send(&this->async_);
+				return;
+			}
+			/* The last worker of the closed queue frees it */
+			release = --this->pending_ == 0 && !this->async_.data;
+		}
+		if (release){
+			delete this;
+		}
+	}
+
+	static void onClose(uv_handle_t *handle){
+		PoolWorkerQueue *queue = (PoolWorkerQueue *)handle->data;
+
+		std::unique_lock<std::mutex> lock(queue->lock_);
+		handle->data = NULL;
+		if (!queue->pending_){
+			lock.unlock();
+			delete queue;
+		}
+	}
+
+	static void onComplete(uv_async_t *handle
+#if UV_VERSION_MAJOR == 0
+		, int
+#endif
+		){
+		PoolWorkerQueue *queue = (PoolWorkerQueue *)handle->data;
+
+		std::deque<PoolWorker *> done;
+		{
+			std::lock_guard<std::mutex> lock(queue->lock_);
+			done.swap(queue->done_);
+			queue->pending_ -= done.size();
+		}
+
+		for (size_t i = 0; i < done.size(); i++){
+			Nan::HandleScope scope;
+			queue->jobs_.erase(done[i]->id_);
+			done[i]->WorkComplete();
+			done[i]->Destroy();
+		}
+
+		if (!queue->pending_){
+			uv_unref((uv_handle_t *)&queue->async_);
+		}
+	}
+
+protected:
+	uv_loop_t *loop_;
+	uv_async_t async_;
+	std::mutex lock_;
+	std::deque<PoolWorker *> done_;
+	std::atomic<size_t> pending_;
+	bool closed_;
+	/* Queued workers by job id, used on the JS thread only */
+	std::map<unsigned long long, PoolWorker *> jobs_;
+};
+
+static thread_local PoolWorkerQueue *poolWorkerQueue = NULL;
+static thread_local int poolWorkerPriority = -1;
+static thread_local unsigned long long poolWorkerLastJob = 0;
+
+#if NODE_MAJOR_VERSION >= 10
+static void closePoolWorkerQueue(void *arg){
+	((PoolWorkerQueue *)arg)->close();
+	poolWorkerQueue = NULL;
+}
+#endif
+
+/* Created on the first use from the JS thread */
+static PoolWorkerQueue *getPoolWorkerQueue(){
+	if (!poolWorkerQueue){
+		poolWorkerQueue = new PoolWorkerQueue(Nan::GetCurrentEventLoop());
+#if NODE_MAJOR_VERSION >= 10
+		node::AddEnvironmentCleanupHook(v8::Isolate::GetCurrent(), closePoolWorkerQueue, poolWorkerQueue);
+#endif
+	}
+	return poolWorkerQueue;
+}
+
+void PoolWorker::Execute(){
+	if (this->cancel_->load()){
+		this->SetCancelled();
+		return;
+	}
+
+	try{
+		this->Process();
+	}
+	catch (Handle<Exception> &e){
+		this->SetErrorMessage(getErrorText(e)->c_str());
+	}
+	catch (...){
+		this->SetErrorMessage("Unknown error");
+	}
+
+	/* Errors of the interrupted Bio loop are reported as cancellation */
+	if (this->ErrorMessage() && this->cancel_->load()){
+		this->SetCancelled();
+	}
+}
+
+void PoolWorker::SetCancelled(){
+	this->SetErrorMessage("Operation cancelled");
+}
+
+unsigned long long PoolWorker::Queue(PoolWorker *worker){
+	LOGGER_FN();
+
+	if (poolWorkerPriority >= 0){
+		worker->priority_ = (ThreadPool::Priority)poolWorkerPriority;
+	}
+
+	try{
+		poolWorkerLastJob = getPoolWorkerQueue()->push(worker);
+	}
+	catch (...){
+		delete worker;
+		throw;
+	}
+
+	return poolWorkerLastJob;
+}
+
+bool PoolWorker::Cancel(unsigned long long id){
+	LOGGER_FN();
+
+	return poolWorkerQueue ? poolWorkerQueue->cancel(id) : false;
+}
+
+void PoolWorker::setPriority(int priority){
+	LOGGER_FN();
+
+	if (priority > ThreadPool::Low){
+		THROW_EXCEPTION(0, PoolWorker, NULL, "Unknown priority %d", priority);
+	}
+	poolWorkerPriority = priority < 0 ? -1 : priority;
+}
+
+unsigned long long PoolWorker::lastJob(){
+	return poolWorkerLastJob;
+}
+
+size_t PoolWorker::poolSize(){
+	return getThreadPool()->size();
+}
+
+ThreadPool *PoolWorker::threads(){
+	return getThreadPool();
+}
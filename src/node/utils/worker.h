@@ -0,0 +1,63 @@
+#ifndef UTILS_WORKER_H_INCLUDED
+#define UTILS_WORKER_H_INCLUDED
+
+#include <nan.h>
+#include "../helper.h"
+
+#include <wrapper/common/thread_pool.h>
+
+/**
+* AsyncWorker which runs on the native ThreadPool of the module instead of
+* the libuv pool, so long crypto operations do not block fs and dns work.
+* Pool size is taken from TRUSTED_THREADPOOL_SIZE environment variable
+* (default is count of hardware threads).
+*
+* Process() is called on the pool thread and reports errors by
+* Handle<Exception>. HandleOKCallback() and HandleErrorCallback() are
+* called on the JS thread.
+*
+* Workers are queued with their own priority (Normal for interactive
+* operations, Low for bulk ones), the JS thread may override it by
+* setPriority(). Cancelled worker which is not started is completed with
+* "Operation cancelled" error; running one stops on the next check of
+* ThreadPool::checkCancelled().
+*/
+class PoolWorker : public Nan::AsyncWorker {
+public:
+	PoolWorker(Nan::Callback *callback, const char *resourceName = "trusted:PoolWorker", ThreadPool::Priority priority = ThreadPool::Normal)
+		: Nan::AsyncWorker(callback, resourceName), priority_(priority), cancel_(ThreadPool::newCancelFlag()), id_(0){};
+
+	virtual void Process() = 0;
+
+	void Execute();
+
+	/*
+	* Schedule the worker. It is deleted after the callback is called.
+	* If the queue is full the worker is deleted and the exception is thrown
+	*/
+	static unsigned long long Queue(PoolWorker *worker);
+
+	/* Cancel the job queued from the current JS thread. Return false if it is completed */
+	static bool Cancel(unsigned long long id);
+	/* Priority of the next jobs of the current JS thread, -1 resets it to the job default */
+	static void setPriority(int priority);
+	/* Id of the last job queued from the current JS thread */
+	static unsigned long long lastJob();
+
+	static size_t poolSize();
+
+	/* Threads of the pool, for background tasks without JS callback */
+	static ThreadPool *threads();
+
+protected:
+	void SetCancelled();
+
+protected:
+	ThreadPool::Priority priority_;
+	ThreadPool::CancelFlag cancel_;
+	unsigned long long id_;
+
+	friend class PoolWorkerQueue;
+};
+
+#endif //!UTILS_WORKER_H_INCLUDED
@@ -0,0 +1,80 @@
+#include "../stdafx.h"
+
+#include "wpool.h"
+
+void WObjectPool::Init(v8::Handle<v8::Object> exports){
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("ObjectPool").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	// Prototype method bindings
+	Nan::SetPrototypeMethod(tpl, "getStats", GetStats);
+	Nan::SetPrototypeMethod(tpl, "getOpenSSLStats", GetOpenSSLStats);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+NAN_METHOD(WObjectPool::New) {
+	METHOD_BEGIN();
+
+	try{
+		WObjectPool *obj = new WObjectPool();
+		obj->data_ = new ObjectPool();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WObjectPool::GetStats)
+{
+	METHOD_BEGIN();
+
+	try {
+		ObjectPool::Stats stats = ObjectPool::stats();
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+		Nan::Set(res, Nan::New("allocations").ToLocalChecked(), Nan::New<v8::Number>((double)stats.allocations));
+		Nan::Set(res, Nan::New("releases").ToLocalChecked(), Nan::New<v8::Number>((double)stats.releases));
+		Nan::Set(res, Nan::New("live").ToLocalChecked(), Nan::New<v8::Number>((double)stats.live));
+		Nan::Set(res, Nan::New("slabs").ToLocalChecked(), Nan::New<v8::Number>((double)stats.slabs));
+		Nan::Set(res, Nan::New("slabBytes").ToLocalChecked(), Nan::New<v8::Number>((double)stats.slabBytes));
+		Nan::Set(res, Nan::New("large").ToLocalChecked(), Nan::New<v8::Number>((double)stats.large));
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WObjectPool::GetOpenSSLStats)
+{
+	METHOD_BEGIN();
+
+	try {
+		OpenSSL::MemoryStats stats = OpenSSL::memoryStats();
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+		Nan::Set(res, Nan::New("installed").ToLocalChecked(), Nan::New<v8::Boolean>(stats.installed));
+		Nan::Set(res, Nan::New("allocations").ToLocalChecked(), Nan::New<v8::Number>((double)stats.allocations));
+		Nan::Set(res, Nan::New("releases").ToLocalChecked(), Nan::New<v8::Number>((double)stats.releases));
+		Nan::Set(res, Nan::New("liveBytes").ToLocalChecked(), Nan::New<v8::Number>((double)stats.liveBytes));
+		Nan::Set(res, Nan::New("allocatedBytes").ToLocalChecked(), Nan::New<v8::Number>((double)stats.allocatedBytes));
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
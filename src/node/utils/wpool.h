@@ -0,0 +1,23 @@
+#ifndef UTILS_WPOOL_H_INCLUDED
+#define UTILS_WPOOL_H_INCLUDED
+
+#include <nan.h>
+#include "wrap.h"
+#include "../helper.h"
+
+#include <wrapper/common/pool.h>
+#include <wrapper/common/openssl.h>
+
+WRAP_CLASS(ObjectPool) {
+public:
+	WObjectPool(){};
+	~WObjectPool(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(GetStats);
+	static NAN_METHOD(GetOpenSSLStats);
+};
+
+#endif //!UTILS_WPOOL_H_INCLUDED
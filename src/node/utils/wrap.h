@@ -1,6 +1,7 @@
 #ifndef UTIL_WRAPPER_INCLUDED
 #define  UTIL_WRAPPER_INCLUDED
 
+#include <limits.h>
 #include <nan.h>
 #include <wrapper/common/common.h>
 #include "../helper.h"
@@ -12,10 +13,37 @@ protected:
 public:
 	Handle<T> data_;
 
+	Wrapper() : externalMemory_(0){};
+	~Wrapper(){
+		this->setExternalMemory(0);
+	};
+
 	static void Init(v8::Handle<v8::Object>){ LOGGER_FN(); };
 
+	/*
+	* Approximate size of native data. Wrappers of big OpenSSL objects
+	* hide it by their own static externalSize().
+	*/
+	static size_t externalSize(Handle<T> data){ return 0; };
+
+	/* Report native memory to V8, so GC pressure follows it */
+	void setExternalMemory(size_t size){
+		if (size > INT_MAX){
+			size = INT_MAX;
+		}
+		int diff = (int)size - this->externalMemory_;
+		if (diff){
+			Nan::AdjustExternalMemory(diff);
+			this->externalMemory_ = (int)size;
+		}
+	}
+
+	/*
+	* Every JS thread (main or worker_threads) runs its own isolate,
+	* so the constructor is kept per thread.
+	*/
 	static inline Nan::Persistent<v8::Function> & constructor() {
-		static Nan::Persistent<v8::Function> my_constructor;
+		static thread_local Nan::Persistent<v8::Function> my_constructor;
 		return my_constructor;
 	}
 
@@ -28,14 +56,22 @@ public:
 		LOGGER_INFO("Set internal data for JS Object");
 		CT* wObject = (CT*)Nan::GetInternalFieldPointer(v8Object, 0);
 		wObject->data_ = data;
+		wObject->setExternalMemory(CT::externalSize(data));
 
 		return v8Object;
 	}
+
+protected:
+	int externalMemory_;
 };
 
+/* Update external memory of unwrapped object after its data is changed */
+#define WRAP_EXTERNAL_MEMORY(type) \
+	__obj->setExternalMemory(W##type::externalSize(_this));
+
 #define WRAP_constructor()																\
 	static inline Nan::Persistent<v8::Function> & constructor() {						\
-		static Nan::Persistent<v8::Function> my_constructor;							\
+		static thread_local Nan::Persistent<v8::Function> my_constructor;				\
 		return my_constructor;															\
 	}																					
 
@@ -0,0 +1,167 @@
+#include "../stdafx.h"
+
+#include "wthread_pool.h"
+#include "worker.h"
+
+void WThreadPool::Init(v8::Handle<v8::Object> exports){
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("ThreadPool").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	// Prototype method bindings
+	Nan::SetPrototypeMethod(tpl, "getStats", GetStats);
+	Nan::SetPrototypeMethod(tpl, "resize", Resize);
+	Nan::SetPrototypeMethod(tpl, "setLimit", SetLimit);
+	Nan::SetPrototypeMethod(tpl, "setPriority", SetPriority);
+	Nan::SetPrototypeMethod(tpl, "getLastJob", GetLastJob);
+	Nan::SetPrototypeMethod(tpl, "cancel", Cancel);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+/*
+* Wraps the pool of PoolWorker, it is shared by all instances
+*/
+NAN_METHOD(WThreadPool::New) {
+	METHOD_BEGIN();
+
+	try{
+		WThreadPool *obj = new WThreadPool();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+static v8::Local<v8::Array> sizesToArray(const size_t *values){
+	v8::Local<v8::Array> res = Nan::New<v8::Array>(THREAD_POOL_PRIORITIES);
+	for (size_t i = 0; i < THREAD_POOL_PRIORITIES; i++){
+		Nan::Set(res, (uint32_t)i, Nan::New<v8::Number>((double)values[i]));
+	}
+	return res;
+}
+
+NAN_METHOD(WThreadPool::GetStats)
+{
+	METHOD_BEGIN();
+
+	try {
+		ThreadPool::Stats stats = PoolWorker::threads()->stats();
+
+		v8::Local<v8::Object> res = Nan::New<v8::Object>();
+		Nan::Set(res, Nan::New("size").ToLocalChecked(), Nan::New<v8::Number>((double)stats.size));
+		Nan::Set(res, Nan::New("running").ToLocalChecked(), Nan::New<v8::Number>((double)stats.running));
+		Nan::Set(res, Nan::New("pending").ToLocalChecked(), sizesToArray(stats.pending));
+		Nan::Set(res, Nan::New("limits").ToLocalChecked(), sizesToArray(stats.limits));
+		Nan::Set(res, Nan::New("completed").ToLocalChecked(), Nan::New<v8::Number>((double)stats.completed));
+		Nan::Set(res, Nan::New("rejected").ToLocalChecked(), Nan::New<v8::Number>((double)stats.rejected));
+		Nan::Set(res, Nan::New("removed").ToLocalChecked(), Nan::New<v8::Number>((double)stats.removed));
+
+		info.GetReturnValue().Set(res);
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* size: Number. 0 - count of hardware threads
+*/
+NAN_METHOD(WThreadPool::Resize)
+{
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("size");
+		int size = info[0]->IsNumber() ? info[0]->ToNumber()->Int32Value() : -1;
+		if (size < 0){
+			Nan::ThrowTypeError("Size must be a not negative number");
+			return;
+		}
+
+		PoolWorker::threads()->resize((size_t)size);
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* priority: ThreadPriority
+* limit: Number. 0 - unlimited
+*/
+NAN_METHOD(WThreadPool::SetLimit)
+{
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("priority");
+		int priority = info[0]->ToNumber()->Int32Value();
+
+		LOGGER_ARG("limit");
+		int limit = info[1]->IsNumber() ? info[1]->ToNumber()->Int32Value() : -1;
+		if (limit < 0){
+			Nan::ThrowTypeError("Limit must be a not negative number");
+			return;
+		}
+
+		PoolWorker::threads()->setLimit((ThreadPool::Priority)priority, (size_t)limit);
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* priority: ThreadPriority. -1 - own priority of the job
+*/
+NAN_METHOD(WThreadPool::SetPriority)
+{
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("priority");
+		int priority = info[0]->IsNumber() ? info[0]->ToNumber()->Int32Value() : -1;
+
+		PoolWorker::setPriority(priority);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WThreadPool::GetLastJob)
+{
+	METHOD_BEGIN();
+
+	try {
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)PoolWorker::lastJob()));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+* id: Number. Job id returned by async method
+*/
+NAN_METHOD(WThreadPool::Cancel)
+{
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("id");
+		unsigned long long id = (unsigned long long)info[0]->ToNumber()->Value();
+
+		info.GetReturnValue().Set(Nan::New<v8::Boolean>(PoolWorker::Cancel(id)));
+		return;
+	}
+	TRY_END();
+}
@@ -0,0 +1,26 @@
+#ifndef UTILS_WTHREAD_POOL_H_INCLUDED
+#define UTILS_WTHREAD_POOL_H_INCLUDED
+
+#include <nan.h>
+#include "wrap.h"
+#include "../helper.h"
+
+#include <wrapper/common/thread_pool.h>
+
+WRAP_CLASS(ThreadPool) {
+public:
+	WThreadPool(){};
+	~WThreadPool(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(GetStats);
+	static NAN_METHOD(Resize);
+	static NAN_METHOD(SetLimit);
+	static NAN_METHOD(SetPriority);
+	static NAN_METHOD(GetLastJob);
+	static NAN_METHOD(Cancel);
+};
+
+#endif //!UTILS_WTHREAD_POOL_H_INCLUDED
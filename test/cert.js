@@ -1,6 +1,7 @@
 "use strict";
 
 var assert = require("assert");
+var fs = require("fs");
 var trusted = require("../index.js");
 
 var DEFAULT_RESOURCES_PATH = "test/resources";
@@ -68,6 +69,20 @@ describe("Certificate", function() {
         assert.equal(typeof (cert.isCA), "boolean", "Error check CA");
     });
 
+    it("toJSON", function() {
+        var info = cert.toJSON();
+
+        assert.equal(info.version, cert.version, "Bad version value");
+        assert.equal(info.subjectName, cert.subjectName, "Bad subjectName value");
+        assert.equal(info.issuerName, cert.issuerName, "Bad issuerName value");
+        assert.equal(info.serialNumber, cert.serialNumber, "Bad serialNumber value");
+        assert.equal(info.thumbprint, cert.thumbprint, "Bad thumbprint value");
+        assert.equal(new Date(info.notAfter).getTime(), cert.notAfter.getTime(), "Bad notAfter value");
+        assert.equal(info.OCSPUrls.length, 1, "Bad OCSP urls length");
+        assert.equal(info.isCA, cert.isCA, "Bad isCA value");
+        assert.equal(JSON.parse(JSON.stringify(cert)).thumbprint, cert.thumbprint, "Bad JSON value");
+    });
+
     it("ru", function() {
         var ruCert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/test-ru.crt");
 
@@ -100,6 +115,23 @@ describe("Certificate", function() {
         assert.equal(buf.toString().indexOf("-----BEGIN CERTIFICATE-----") === -1, true);
     });
 
+    it("import/export Buffer", function() {
+        var der = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.crt");
+        var cert1 = trusted.pki.Certificate.import(der, trusted.DataFormat.DER);
+        var cert2 = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/test.crt", trusted.DataFormat.DER);
+
+        der[0] = 0;
+        assert.equal(cert1.thumbprint, cert2.thumbprint, "Imported certificate depends on the Buffer");
+
+        var buf1 = cert1.export(trusted.DataFormat.DER);
+        var buf2 = cert1.export(trusted.DataFormat.DER);
+        assert.equal(Buffer.isBuffer(buf1), true);
+        assert.equal(buf1.equals(cert2.export(trusted.DataFormat.DER)), true, "Exported DER differs");
+
+        buf1[0] ^= 1;
+        assert.equal(buf1[0] !== buf2[0], true, "Exported Buffers share memory");
+    });
+
     it("duplicate", function() {
         var cert1, cert2;
 
@@ -41,6 +41,370 @@ describe("CipherSYMMETRIC", function() {
 
         assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
     });
+
+    it("encrypt/decrypt buffer async", function() {
+        var data = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+
+        return cipher.encryptAsync(data)
+            .then(function(enc) {
+                assert.equal(Buffer.isBuffer(enc), true);
+                assert.equal(enc.length > 0, true);
+                return cipher.decryptAsync(enc, trusted.DataFormat.DER);
+            })
+            .then(function(dec) {
+                assert.equal(dec.toString() === data.toString(), true, "Resource and decrypt buffer diff");
+            });
+    });
+
+    it("decrypt file async", function(done) {
+        cipher.decryptAsync(DEFAULT_OUT_PATH + "/encSym.txt", trusted.DataFormat.DER, function(err, dec) {
+            assert.equal(err, null, err && err.message);
+
+            var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+            assert.equal(res.toString() === dec.toString(), true, "Resource and decrypt file diff");
+            done();
+        });
+    });
+
+    it("encrypt stream", function(done) {
+        var enc = cipher.createEncryptStream({ highWaterMark: 16 });
+        var out = fs.createWriteStream(DEFAULT_OUT_PATH + "/encSymStream.txt");
+
+        fs.createReadStream(DEFAULT_RESOURCES_PATH + "/test.txt", { highWaterMark: 7 })
+            .pipe(enc)
+            .pipe(out)
+            .on("error", done)
+            .on("finish", function() {
+                cipher.decrypt(DEFAULT_OUT_PATH + "/encSymStream.txt", DEFAULT_OUT_PATH + "/decSymStream.txt");
+
+                var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+                var dec = fs.readFileSync(DEFAULT_OUT_PATH + "/decSymStream.txt");
+                assert.equal(res.toString() === dec.toString(), true, "Resource and decrypt stream diff");
+                done();
+            });
+    });
+
+    it("decrypt stream", function(done) {
+        var chunks = [];
+        var dec = cipher.createDecryptStream();
+
+        dec.on("data", function(chunk) {
+            chunks.push(chunk);
+        }).on("error", done).on("end", function() {
+            var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+            assert.equal(res.toString() === Buffer.concat(chunks).toString(), true, "Resource and decrypt stream diff");
+            done();
+        });
+
+        /* Header "Salted__" and salt come by several chunks */
+        fs.createReadStream(DEFAULT_OUT_PATH + "/encSym.txt", { highWaterMark: 5 }).pipe(dec);
+    });
+
+    it("decrypt stream bad data", function(done) {
+        var dec = cipher.createDecryptStream();
+
+        dec.on("error", function(err) {
+            assert.equal(err instanceof Error, true);
+            done();
+        }).resume();
+
+        dec.end(new Buffer("Not salted data"));
+    });
+});
+
+describe("CipherAEAD", function() {
+    var cipher;
+    var data;
+
+    before(function() {
+        data = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+
+        cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.aead = "auto";
+    });
+
+    it("auto", function() {
+        assert.equal(["aes-256-gcm", "chacha20-poly1305"].indexOf(cipher.aead) !== -1, true, cipher.aead);
+    });
+
+    it("encrypt/decrypt password", function() {
+        cipher.password = "4321";
+        cipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encAead.txt");
+        cipher.decrypt(DEFAULT_OUT_PATH + "/encAead.txt", DEFAULT_OUT_PATH + "/decAead.txt");
+
+        var enc = fs.readFileSync(DEFAULT_OUT_PATH + "/encAead.txt");
+        assert.equal(enc.slice(0, 4).toString(), "TCAE", "Bad magic");
+
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decAead.txt");
+        assert.equal(data.toString() === out.toString(), true, "Resource and decrypt file diff");
+    });
+
+    it("encrypt/decrypt key", function() {
+        var keyCipher = new trusted.pki.Cipher();
+        keyCipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        keyCipher.aead = "aes-256-gcm";
+        keyCipher.key = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+        assert.equal(keyCipher.mode, "gcm");
+
+        return keyCipher.encryptAsync(data)
+            .then(function(enc) {
+                assert.equal(enc.length, data.length + 36, "Bad length of header and tag");
+                return keyCipher.decryptAsync(enc);
+            })
+            .then(function(dec) {
+                assert.equal(dec.toString() === data.toString(), true, "Resource and decrypt buffer diff");
+            });
+    });
+
+    it("segmented encrypt/decrypt", function() {
+        var segCipher = new trusted.pki.Cipher();
+        segCipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        segCipher.aead = "auto";
+        segCipher.password = "4321";
+        segCipher.segmentSize = 4;
+        segCipher.threads = 3;
+
+        segCipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encAeadSeg.txt");
+        segCipher.decrypt(DEFAULT_OUT_PATH + "/encAeadSeg.txt", DEFAULT_OUT_PATH + "/decAeadSeg.txt");
+
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decAeadSeg.txt");
+        assert.equal(data.toString() === out.toString(), true, "Resource and decrypt file diff");
+
+        var range = segCipher.decryptRange(DEFAULT_OUT_PATH + "/encAeadSeg.txt", 5, 9);
+        assert.equal(range.toString() === data.slice(5, 14).toString(), true, "Bad range");
+
+        var tail = segCipher.decryptRange(fs.readFileSync(DEFAULT_OUT_PATH + "/encAeadSeg.txt"), data.length - 3, 100);
+        assert.equal(tail.toString() === data.slice(data.length - 3).toString(), true, "Bad range of the end");
+    });
+
+    it("segmented truncated data", function() {
+        var enc = fs.readFileSync(DEFAULT_OUT_PATH + "/encAeadSeg.txt");
+        var segCipher = new trusted.pki.Cipher();
+        segCipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        segCipher.password = "4321";
+        segCipher.aead = "auto";
+
+        return segCipher.decryptAsync(enc.slice(0, enc.length - 20))
+            .then(function() {
+                assert.fail("Truncated data is decrypted");
+            }, function(err) {
+                assert.equal(err instanceof Error, true);
+            });
+    });
+
+    it("maximum segment size", function() {
+        var maxSize = 16 * 1024 * 1024;
+        var segCipher = new trusted.pki.Cipher();
+        segCipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        segCipher.aead = "auto";
+        segCipher.password = "4321";
+        segCipher.segmentSize = maxSize;
+
+        segCipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encAeadSegMax.txt");
+        segCipher.decrypt(DEFAULT_OUT_PATH + "/encAeadSegMax.txt", DEFAULT_OUT_PATH + "/decAeadSegMax.txt");
+
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decAeadSegMax.txt");
+        assert.equal(data.toString() === out.toString(), true, "Resource and decrypt file diff");
+
+        assert.throws(function() {
+            segCipher.segmentSize = maxSize + 1;
+        });
+
+        /* Small file which header declares the maximum segment size */
+        var enc = fs.readFileSync(DEFAULT_OUT_PATH + "/encAeadSeg.txt");
+        enc.writeUInt32BE(maxSize, 41);
+        segCipher.threads = 0;
+
+        return segCipher.decryptAsync(enc)
+            .then(function() {
+                assert.fail("Data with changed segment size is decrypted");
+            }, function(err) {
+                assert.equal(err.message.indexOf("bad decrypt") !== -1, true, err.message);
+            });
+    });
+
+    it("busy during async job", function() {
+        var job = cipher.encryptAsync(data);
+
+        assert.throws(function() {
+            cipher.password = "1234";
+        }, /busy/);
+
+        return job
+            .then(function(enc) {
+                cipher.password = "4321";
+                return cipher.decryptAsync(enc);
+            })
+            .then(function(dec) {
+                assert.equal(dec.toString() === data.toString(), true, "Resource and decrypt buffer diff");
+            });
+    });
+
+    it("tampered file", function() {
+        var decFile = DEFAULT_OUT_PATH + "/decAeadTampered.txt";
+        var segCipher = new trusted.pki.Cipher();
+        segCipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        segCipher.aead = "auto";
+        segCipher.password = "4321";
+
+        [0, 4].forEach(function(segmentSize) {
+            segCipher.segmentSize = segmentSize;
+            segCipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encAeadTampered.txt");
+
+            var enc = fs.readFileSync(DEFAULT_OUT_PATH + "/encAeadTampered.txt");
+            enc[enc.length - 20] ^= 1;
+            fs.writeFileSync(DEFAULT_OUT_PATH + "/encAeadTampered.txt", enc);
+
+            /* Plaintext written before the tag check is not left on disk */
+            assert.throws(function() {
+                segCipher.decrypt(DEFAULT_OUT_PATH + "/encAeadTampered.txt", decFile);
+            }, /bad decrypt/);
+            assert.equal(fs.existsSync(decFile), false, "Output of tampered data is left, segment size " + segmentSize);
+        });
+    });
+
+    it("tampered data", function() {
+        return cipher.encryptAsync(data)
+            .then(function(enc) {
+                enc[enc.length - 20] ^= 1;
+                return cipher.decryptAsync(enc);
+            })
+            .then(function() {
+                assert.fail("Tampered data is decrypted");
+            }, function(err) {
+                assert.equal(err.message.indexOf("bad decrypt") !== -1, true, err.message);
+            });
+    });
+});
+
+describe("CipherKDF", function() {
+    var data;
+
+    function createCipher() {
+        var cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.aead = "aes-256-gcm";
+        cipher.password = "4321";
+        return cipher;
+    }
+
+    it("init", function() {
+        data = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+        trusted.pki.KeyCache.clear();
+    });
+
+    it("scrypt", function() {
+        var cipher = createCipher();
+        cipher.setKdf("scrypt", 10);
+        assert.equal(cipher.kdf, "scrypt");
+
+        return cipher.encryptAsync(data)
+            .then(function(enc) {
+                /* kdf byte and scrypt cost: log2(N), r, p */
+                assert.equal(enc[6], 2);
+                assert.equal(enc[25], 10);
+                return createCipher().decryptAsync(enc);
+            })
+            .then(function(dec) {
+                assert.equal(dec.toString(), data.toString());
+            });
+    });
+
+    it("key cache", function() {
+        var cipher = createCipher();
+        cipher.setKdf("pbkdf2", 20000);
+        var misses;
+
+        return cipher.encryptAsync(data)
+            .then(function() {
+                misses = trusted.pki.KeyCache.getStats().misses;
+                return cipher.encryptAsync(data);
+            })
+            .then(function(enc) {
+                return createCipher().decryptAsync(enc);
+            })
+            .then(function(dec) {
+                assert.equal(dec.toString(), data.toString());
+                assert.equal(trusted.pki.KeyCache.getStats().misses, misses, "Key is derived again");
+                trusted.pki.KeyCache.clear();
+                assert.equal(trusted.pki.KeyCache.getStats().size, 0);
+            });
+    });
+
+    it("legacy format", function() {
+        var cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.password = "4321";
+        cipher.setKdf("scrypt");
+
+        assert.throws(function() {
+            cipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encKdf.txt");
+        });
+        assert.throws(function() {
+            cipher.setKdf("pbkdf2", 1);
+        });
+    });
+});
+
+describe("CipherSession", function() {
+    var KEY = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+
+    function createSession(aead, key) {
+        var cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        if (aead) {
+            cipher.aead = aead;
+        }
+        cipher.key = key || KEY;
+        return cipher.createSession();
+    }
+
+    it("AEAD messages", function() {
+        var enc = createSession("aes-256-gcm");
+        var dec = createSession("aes-256-gcm");
+        var msg = new Buffer("message of session");
+
+        var first = enc.encrypt(msg);
+        var second = enc.encrypt(msg);
+        assert.equal(first.length, msg.length + 28);
+        assert.equal(first.equals(second), false, "Nonce is reused");
+        assert.equal(dec.decrypt(first).toString(), msg.toString());
+        assert.equal(dec.decrypt(second).toString(), msg.toString());
+        assert.equal(dec.decrypt(enc.encrypt(new Buffer(0))).length, 0);
+
+        first[first.length - 1] ^= 1;
+        assert.throws(function() {
+            dec.decrypt(first);
+        });
+    });
+
+    it("legacy cipher messages", function() {
+        /* des-ede3-cbc */
+        var session = createSession("", KEY.substring(0, 48));
+        var msg = new Buffer("message of session");
+
+        for (var i = 0; i < 3; i++) {
+            assert.equal(session.decrypt(session.encrypt(msg)).toString(), msg.toString());
+        }
+    });
+
+    it("buffer size", function() {
+        var cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.password = "4321";
+        cipher.bufferSize = 1024;
+        cipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encSymBuff.txt");
+        cipher.decrypt(DEFAULT_OUT_PATH + "/encSymBuff.txt", DEFAULT_OUT_PATH + "/decSymBuff.txt");
+
+        var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decSymBuff.txt");
+        assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
+
+        assert.throws(function() {
+            cipher.bufferSize = 1;
+        });
+    });
 });
 
 describe("CipherASSYMETRIC", function() {
@@ -176,4 +540,25 @@ describe("CipherASSYMETRIC", function() {
 
         assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
     });
+
+    it("decrypt DER by chunks", function() {
+        var data = new Buffer(3 * 1024 * 1024 + 5);
+        var encrypter = new trusted.pki.Cipher();
+        var certs = new trusted.pki.CertificateCollection();
+
+        for (var i = 0; i < data.length; i++) {
+            data[i] = i % 251;
+        }
+        fs.writeFileSync(DEFAULT_OUT_PATH + "/assymBig.txt", data);
+
+        certs.push(trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM));
+        encrypter.recipientsCerts = certs;
+        encrypter.encrypt(DEFAULT_OUT_PATH + "/assymBig.txt", DEFAULT_OUT_PATH + "/encAssymBig.txt", trusted.DataFormat.DER);
+
+        cipher.bufferSize = 4096;
+        cipher.decrypt(DEFAULT_OUT_PATH + "/encAssymBig.txt", DEFAULT_OUT_PATH + "/decAssymBig.txt", trusted.DataFormat.DER);
+
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decAssymBig.txt");
+        assert.equal(out.equals(data), true, "Resource and decrypt file diff");
+    });
 });
@@ -32,6 +32,16 @@ describe("CRL", function() {
         assert.equal(typeof (crl.crlNumber), "object", "Bad crlNumber value");
     });
 
+    it("toJSON", function() {
+        var info = crl.toJSON();
+
+        assert.equal(info.version, crl.version, "Bad version value");
+        assert.equal(info.issuerName, crl.issuerName, "Bad issuerName value");
+        assert.equal(info.thumbprint, crl.thumbprint, "Bad thumbprint value");
+        assert.equal(new Date(info.lastUpdate).getTime(), crl.lastUpdate.getTime(), "Bad lastUpdate value");
+        assert.equal(info.crlNumber, crl.crlNumber.toString(), "Bad crlNumber value");
+    });
+
     it("export", function() {
         var buf;
 
@@ -42,4 +42,35 @@ describe("Key", function() {
         key.readPublicKey(DEFAULT_OUT_PATH + "/pubkey_s.key", trusted.DataFormat.PEM);
         assert.equal(key !== null, true);
     });
+
+    it("generate async", function() {
+        return key.generateAsync("RSA", ["rsa_keygen_bits:1024"])
+            .then(function(res) {
+                assert.equal(res instanceof trusted.pki.Key, true);
+            });
+    });
+
+    it("key pool", function(done) {
+        var opts = ["rsa_keygen_bits:1024"];
+        var stats = trusted.pki.KeyPool.getStats();
+
+        trusted.pki.KeyPool.reserve("RSA", opts, 2);
+
+        function check() {
+            var current = trusted.pki.KeyPool.getStats();
+            if (current.ready < 2) {
+                setTimeout(check, 50);
+                return;
+            }
+
+            var res = trusted.pki.KeyPool.take("RSA", opts);
+            assert.equal(res instanceof trusted.pki.Key, true);
+            assert.equal(trusted.pki.KeyPool.getStats().hits, stats.hits + 1);
+
+            trusted.pki.KeyPool.reserve("RSA", opts, 0);
+            done();
+        }
+
+        check();
+    });
 });
@@ -54,3 +54,21 @@ describe("LOGGER", function() {
     });
 });
 
+
+describe("LOGGER_ASYNC", function() {
+    var logger;
+
+    it("start", function() {
+        logger = trusted.utils.Logger.start(DEFAULT_OUT_PATH + "/logger_async.txt", trusted.LoggerLevel.ALL, true);
+
+        assert.equal(fs.existsSync(DEFAULT_OUT_PATH + "/logger_async.txt"), true, "Log file not exists");
+    });
+
+    it("stop", function() {
+        trusted.pki.Certificate.load("test/resources/test.crt", trusted.DataFormat.DER);
+        logger.stop();
+
+        assert.equal(fs.statSync(DEFAULT_OUT_PATH + "/logger_async.txt").size > 0, true, "Empty log file");
+        assert.equal(typeof logger.dropped, "number");
+    });
+});
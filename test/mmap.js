@@ -0,0 +1,92 @@
+"use strict";
+
+var assert = require("assert");
+var fs = require("fs");
+var trusted = require("../index.js");
+
+var DEFAULT_RESOURCES_PATH = "test/resources";
+var DEFAULT_OUT_PATH = "test/out";
+
+/* Input files are memory mapped and read by 8 MB windows */
+var WINDOW = 8 * 1024 * 1024;
+
+describe("MemoryMappedFile", function() {
+    var bigFile = DEFAULT_OUT_PATH + "/mmapBig.txt";
+    var data;
+
+    this.timeout(60000);
+
+    before(function() {
+        try {
+            fs.statSync(DEFAULT_OUT_PATH).isDirectory();
+        } catch (err) {
+            fs.mkdirSync(DEFAULT_OUT_PATH);
+        }
+
+        /* Not aligned to the window, lines cross window boundaries */
+        data = new Buffer(2 * WINDOW + 4 * 1024 * 1024 + 7);
+        for (var i = 0; i < data.length; i++) {
+            data[i] = (i % 61 === 60) ? 0x0a : 0x41 + (i % 26);
+        }
+        fs.writeFileSync(bigFile, data);
+    });
+
+    it("read by windows", function() {
+        var cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.password = "4321";
+
+        cipher.encrypt(bigFile, DEFAULT_OUT_PATH + "/mmapEncSym.txt");
+        cipher.decrypt(DEFAULT_OUT_PATH + "/mmapEncSym.txt", DEFAULT_OUT_PATH + "/mmapDecSym.txt");
+
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/mmapDecSym.txt");
+        assert.equal(data.equals(out), true, "Source and decrypt file diff");
+    });
+
+    it("seek across windows", function() {
+        var cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.aead = "auto";
+        cipher.password = "4321";
+        cipher.segmentSize = 1024 * 1024;
+        cipher.threads = 2;
+
+        cipher.encrypt(bigFile, DEFAULT_OUT_PATH + "/mmapEncAead.txt");
+
+        var range = cipher.decryptRange(DEFAULT_OUT_PATH + "/mmapEncAead.txt", WINDOW - 100, 200);
+        assert.equal(data.slice(WINDOW - 100, WINDOW + 100).equals(range), true, "Bad range of the window boundary");
+
+        var tail = cipher.decryptRange(DEFAULT_OUT_PATH + "/mmapEncAead.txt", data.length - 10, 100);
+        assert.equal(data.slice(data.length - 10).equals(tail), true, "Bad range of the end");
+
+        cipher.decrypt(DEFAULT_OUT_PATH + "/mmapEncAead.txt", DEFAULT_OUT_PATH + "/mmapDecAead.txt");
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/mmapDecAead.txt");
+        assert.equal(data.equals(out), true, "Source and decrypt file diff");
+    });
+
+    it("gets and d2i of signed data", function() {
+        var cert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM);
+        var key = trusted.pki.Key.readPrivateKey(DEFAULT_RESOURCES_PATH + "/cert1.key", trusted.DataFormat.PEM, "");
+
+        var sd = new trusted.cms.SignedData();
+        sd.createSigner(cert, key);
+        sd.content = {
+            type: trusted.cms.SignedDataContentType.url,
+            data: bigFile
+        };
+        sd.sign();
+        sd.save(DEFAULT_OUT_PATH + "/mmapSig.der", trusted.DataFormat.DER);
+        sd.save(DEFAULT_OUT_PATH + "/mmapSig.pem", trusted.DataFormat.PEM);
+
+        /* PEM is read by lines (BIO_gets), DER is decoded from the mapping */
+        [[DEFAULT_OUT_PATH + "/mmapSig.pem", trusted.DataFormat.PEM],
+         [DEFAULT_OUT_PATH + "/mmapSig.der", trusted.DataFormat.DER]].forEach(function(item) {
+            var cms = new trusted.cms.SignedData();
+            cms.load(item[0], item[1]);
+
+            assert.equal(cms.isDetached(), false, "Detached");
+            assert.equal(cms.verify() !== false, true, "Verify signature");
+            assert.equal(data.equals(cms.content.data), true, "Content diff");
+        });
+    });
+});
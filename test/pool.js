@@ -0,0 +1,37 @@
+"use strict";
+
+var assert = require("assert");
+var trusted = require("../index.js");
+
+var DEFAULT_RESOURCES_PATH = "test/resources";
+
+describe("ObjectPool", function() {
+    it("stats", function() {
+        var stats = trusted.utils.ObjectPool.getStats();
+
+        assert.equal(typeof stats.allocations, "number", "Bad allocations type");
+        assert.equal(typeof stats.releases, "number", "Bad releases type");
+        assert.equal(stats.live, stats.allocations - stats.releases, "Bad live count");
+        assert.equal(stats.slabBytes >= stats.slabs, true, "Bad slab bytes");
+    });
+
+    it("count allocations", function() {
+        var before = trusted.utils.ObjectPool.getStats();
+
+        var cert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/test.crt");
+        assert.equal(cert.version, 2, "Bad version value");
+
+        var after = new trusted.utils.ObjectPool().stats;
+        assert.equal(after.allocations > before.allocations, true, "Allocations are not counted");
+    });
+
+    it("openssl stats", function() {
+        var stats = trusted.utils.ObjectPool.getOpenSSLStats();
+
+        assert.equal(typeof stats.installed, "boolean", "Bad installed type");
+        if (stats.installed) {
+            assert.equal(stats.allocations > 0, true, "OpenSSL allocations are not counted");
+            assert.equal(stats.allocatedBytes >= stats.liveBytes, true, "Bad live bytes");
+        }
+    });
+});
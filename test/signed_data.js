@@ -105,4 +105,93 @@ describe("SignedData", function() {
         assert.equal(buf.length > 0, true);
         assert.equal(buf.toString("hex").indexOf("06092a864886f70d010702") === -1, false);
     });
+
+    it("sign and verify async", function(done) {
+        var sd = new trusted.cms.SignedData();
+
+        sd.policies = ["noAttributes", "noSignerCertificateVerify"];
+        sd.createSigner(cert, key);
+        sd.content = {
+            type: trusted.cms.SignedDataContentType.buffer,
+            data: "Hello world"
+        };
+
+        sd.signAsync(function(err) {
+            assert.equal(err, null, err && err.message);
+
+            sd.verifyAsync(undefined, function(err, res) {
+                assert.equal(err, null, err && err.message);
+                assert.equal(res, true, "Verify signature");
+                done();
+            });
+        });
+    });
+
+    it("Buffer content", function() {
+        var sd = new trusted.cms.SignedData();
+
+        sd.policies = ["noAttributes", "noSignerCertificateVerify"];
+        sd.createSigner(cert, key);
+        /* Native Buffer of the content is referenced by the signed data only */
+        sd.content = {
+            type: trusted.cms.SignedDataContentType.buffer,
+            data: new Buffer("Hello Buffer")
+        };
+        if (global.gc) {
+            global.gc();
+        }
+
+        return sd.signAsync()
+            .then(function() {
+                var der = sd.export(trusted.DataFormat.DER);
+                assert.equal(der.indexOf("Hello Buffer") !== -1, true, "Content is not signed");
+
+                sd.content = {
+                    type: trusted.cms.SignedDataContentType.buffer,
+                    data: "Hello world"
+                };
+                return trusted.cms.SignedData.import(der, trusted.DataFormat.DER).verifyAsync();
+            })
+            .then(function(res) {
+                assert.equal(res, true, "Verify signature");
+            });
+    });
+
+    it("overlapping async calls", function() {
+        var sd = new trusted.cms.SignedData();
+        sd.load(DEFAULT_OUT_PATH + "/testsig.sig", trusted.DataFormat.PEM);
+
+        /* Jobs of one object share its content BIO, they are serialized */
+        var jobs = [sd.verifyAsync(), sd.verifyAsync()];
+
+        assert.throws(function() {
+            sd.verify();
+        }, /busy/);
+
+        return Promise.all(jobs)
+            .then(function(res) {
+                assert.deepEqual(res, [true, true], "Verify signature");
+                assert.equal(sd.verify(), true, "Verify after jobs");
+            });
+    });
+
+    it("load async with Promise", function() {
+        return trusted.cms.SignedData.loadAsync(DEFAULT_OUT_PATH + "/testsig.sig", trusted.DataFormat.PEM)
+            .then(function(sd) {
+                assert.equal(sd.signers().length, 1, "Wrong signers length");
+                return sd.verifyAsync();
+            })
+            .then(function(res) {
+                assert.equal(res, true, "Verify signature");
+            });
+    });
+
+    it("load async error", function(done) {
+        var sd = new trusted.cms.SignedData();
+
+        sd.loadAsync(DEFAULT_OUT_PATH + "/notexist.sig", trusted.DataFormat.PEM, function(err) {
+            assert.equal(err instanceof Error, true);
+            done();
+        });
+    });
 });
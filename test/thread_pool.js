@@ -0,0 +1,112 @@
+"use strict";
+
+var assert = require("assert");
+var trusted = require("../index.js");
+
+var DEFAULT_CERTSTORE_PATH = "test/CertStore";
+var DEFAULT_RESOURCES_PATH = "test/resources";
+
+var ThreadPool = trusted.utils.ThreadPool;
+var ThreadPriority = trusted.utils.ThreadPriority;
+
+describe("ThreadPool", function() {
+    var cipher;
+    var size;
+
+    before(function() {
+        cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.password = "4321";
+
+        size = ThreadPool.getStats().size;
+    });
+
+    after(function() {
+        ThreadPool.setLimit(ThreadPriority.LOW, 0);
+        ThreadPool.resize(size);
+    });
+
+    it("stats", function() {
+        var stats = ThreadPool.getStats();
+
+        assert.equal(stats.size > 0, true, "Bad pool size");
+        assert.equal(stats.pending.length, 3, "Bad pending queues");
+        assert.equal(stats.limits.length, 3, "Bad limits");
+        assert.equal(typeof stats.completed, "number", "Bad completed type");
+    });
+
+    it("resize", function() {
+        ThreadPool.resize(1);
+        assert.equal(ThreadPool.getStats().size, 1, "Pool is not resized");
+    });
+
+    it("schedule", function() {
+        var job = ThreadPool.schedule(function() {
+            return cipher.encryptAsync(DEFAULT_RESOURCES_PATH + "/test.txt");
+        }, ThreadPriority.HIGH);
+
+        assert.equal(job.id > 0, true, "Job id is not returned");
+
+        return job.result.then(function(enc) {
+            assert.equal(enc.length > 0, true);
+            assert.equal(ThreadPool.cancel(job.id), false, "Completed job is cancelled");
+        });
+    });
+
+    it("cancel", function() {
+        var jobs = [];
+        for (var i = 0; i < 8; i++) {
+            jobs.push(ThreadPool.schedule(function() {
+                return cipher.encryptAsync(DEFAULT_RESOURCES_PATH + "/test.txt");
+            }));
+        }
+
+        var last = jobs[jobs.length - 1];
+        var cancelled = ThreadPool.cancel(last.id);
+
+        return Promise.all(jobs.slice(0, -1).map(function(job) { return job.result; }))
+            .then(function() {
+                return last.result.then(function() {
+                    assert.equal(cancelled, false, "Cancelled job is completed");
+                }, function(err) {
+                    assert.equal(cancelled, true, err.message);
+                    assert.equal(err.message.indexOf("Operation cancelled") !== -1, true, err.message);
+                });
+            });
+    });
+
+    it("queue limit", function() {
+        ThreadPool.setLimit(ThreadPriority.LOW, 1);
+        assert.equal(ThreadPool.getStats().limits[ThreadPriority.LOW], 1, "Limit is not set");
+
+        var rejected = ThreadPool.getStats().rejected;
+        var results = [];
+        var error;
+        try {
+            for (var i = 0; i < 50; i++) {
+                results.push(cipher.encryptAsync(DEFAULT_RESOURCES_PATH + "/test.txt"));
+            }
+        } catch (err) {
+            error = err;
+        }
+
+        assert.equal(error !== undefined, true, "Full queue does not throw");
+        assert.equal(ThreadPool.getStats().rejected > rejected, true, "Rejection is not counted");
+
+        ThreadPool.setLimit(ThreadPriority.LOW, 0);
+        return Promise.all(results);
+    });
+
+    it("store scan", function() {
+        return trusted.pkistore.Provider_System.loadAsync(DEFAULT_CERTSTORE_PATH)
+            .then(function(provider) {
+                var store = new trusted.pkistore.PkiStore(DEFAULT_CERTSTORE_PATH + "/cash.json");
+                store.addProvider(provider.handle);
+
+                var storeSync = new trusted.pkistore.PkiStore(DEFAULT_CERTSTORE_PATH + "/cash.json");
+                storeSync.addProvider(new trusted.pkistore.Provider_System(DEFAULT_CERTSTORE_PATH).handle);
+
+                assert.equal(store.find().length, storeSync.find().length, "Scanned items differ");
+            });
+    });
+});
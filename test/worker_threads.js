@@ -0,0 +1,57 @@
+"use strict";
+
+var assert = require("assert");
+var path = require("path");
+var trusted = require("../index.js");
+
+var workerThreads;
+
+try {
+    workerThreads = require("worker_threads");
+} catch (err) {
+    workerThreads = null;
+}
+
+var WORKER_SOURCE = [
+    "var parentPort = require('worker_threads').parentPort;",
+    "var workerData = require('worker_threads').workerData;",
+    "var trusted = require(workerData.module);",
+    "var res = path => trusted.pki.Certificate.load(path, trusted.DataFormat.PEM).subjectName;",
+    "parentPort.postMessage(res(workerData.cert));"
+].join("\n");
+
+describe("worker_threads", function() {
+    var certFile = path.resolve("test/resources/cert1.crt");
+
+    before(function() {
+        if (!workerThreads) {
+            this.skip();
+        }
+    });
+
+    it("load module in several workers", function() {
+        var expected = trusted.pki.Certificate.load(certFile, trusted.DataFormat.PEM).subjectName;
+        var workers = [];
+
+        for (var i = 0; i < 4; i++) {
+            workers.push(new Promise(function(resolve, reject) {
+                var worker = new workerThreads.Worker(WORKER_SOURCE, {
+                    eval: true,
+                    workerData: {
+                        module: path.resolve("index.js"),
+                        cert: certFile
+                    }
+                });
+
+                worker.on("message", resolve);
+                worker.on("error", reject);
+            }));
+        }
+
+        return Promise.all(workers).then(function(names) {
+            names.forEach(function(name) {
+                assert.equal(name, expected);
+            });
+        });
+    });
+});